@@ -0,0 +1,33 @@
+// === ARENA (ALLOCATORE A PUNTATORE) ===
+#include "lib/arena.h"
+#include "lib/platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool ArenaInit(Arena *arena, size_t capacity)
+{
+    memset(arena, 0, sizeof(*arena));
+    capacity = ArenaSize(capacity > 0 ? capacity : 1);
+    void *block = AlignedAlloc(ARENA_ALIGN, capacity);
+    if (!block)
+        return false;
+    arena->base = block;
+    arena->capacity = capacity;
+    return true;
+}
+
+void ArenaFree(Arena *arena)
+{
+    AlignedFree(arena->base);
+    memset(arena, 0, sizeof(*arena));
+}
+
+void *ArenaAlloc(Arena *arena, size_t size)
+{
+    size_t need = ArenaSize(size);
+    if (need < size || need > arena->capacity - arena->used)
+        return NULL;
+    void *p = arena->base + arena->used;
+    arena->used += need;
+    return p;
+}
@@ -0,0 +1,504 @@
+// === AUTOPILOTA MCTS ===
+#include "lib/autopilot.h"
+#include "lib/snapshot.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const SimInput inputDirections[4] = {SIM_INPUT_RIGHT, SIM_INPUT_LEFT, SIM_INPUT_DOWN, SIM_INPUT_UP};
+static const Vector2 inputVectors[4] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+// Direzione opposta (destra <-> sinistra, giu' <-> su)
+#define REVERSE(d) ((d) ^ 1)
+
+static double NowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static unsigned int NextRandom(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Indice (0..3) della direzione di un input, -1 se non e' una direzione sola
+static int DirectionOf(SimInput input)
+{
+    for (int d = 0; d < 4; d++)
+    {
+        if (input == inputDirections[d])
+            return d;
+    }
+    return -1;
+}
+
+// Direzioni in cui Pacman puo' muoversi dalla sua posizione (bit d = direzione d)
+static unsigned char ValidMask(const World *w)
+{
+    unsigned char mask = 0;
+    for (int d = 0; d < 4; d++)
+    {
+        if (IsDirectionValid(w, w->pacmanPos, inputVectors[d]))
+            mask |= (unsigned char)(1 << d);
+    }
+    return mask;
+}
+
+// Pacman, andando verso dir, e' arrivato al centro di una cella diversa da
+// fromCell (o appena oltre): il punto in cui si sceglie la mossa successiva
+static bool ReachedDecision(const World *w, int dir, int fromCell)
+{
+    if (w->pacmanCell == fromCell)
+        return false;
+    Vector2 pos = w->pacmanPos;
+    float half = TILE_SIZE / 2.0f;
+    float offX = pos.x - ((int)pos.x / TILE_SIZE) * TILE_SIZE - half;
+    float offY = pos.y - ((int)pos.y / TILE_SIZE) * TILE_SIZE - half;
+    float progress = offX * inputVectors[dir].x + offY * inputVectors[dir].y;
+    return progress >= -GetModifiedSpeed(w, PACMAN_BASE_SPEED) / 2.0f;
+}
+
+// === ALBERO DI UN THREAD ===
+
+bool InitAutopilotTree(AutopilotTree *tree, const World *w)
+{
+    memset(tree, 0, sizeof(*tree));
+    tree->nodes = malloc(sizeof(AutopilotNode) * AUTOPILOT_MAX_NODES);
+    if (!tree->nodes || !SimCreate(&tree->world, w->maze, w->ghosts.count))
+    {
+        free(tree->nodes);
+        memset(tree, 0, sizeof(*tree));
+        return false;
+    }
+    return true;
+}
+
+void FreeAutopilotTree(AutopilotTree *tree)
+{
+    if (tree->nodes)
+        SimDestroy(&tree->world);
+    free(tree->nodes);
+    memset(tree, 0, sizeof(*tree));
+}
+
+static int NewNode(AutopilotTree *tree)
+{
+    AutopilotNode *node = &tree->nodes[tree->numNodes];
+    for (int d = 0; d < 4; d++)
+        node->children[d] = AUTOPILOT_NO_CHILD;
+    node->validMask = 0;
+    node->expanded = false;
+    node->terminal = false;
+    node->visits = 0;
+    node->value = 0.0f;
+    return tree->numNodes++;
+}
+
+void AutopilotTreeReset(AutopilotTree *tree, const World *root, unsigned int seed)
+{
+    tree->numNodes = 0;
+    NewNode(tree);
+    tree->rng = seed ? seed : 0x9E3779B9u;
+    tree->rootLives = root->lives;
+    tree->rootScore = root->score;
+    tree->rollouts = 0;
+    tree->truncated = 0;
+}
+
+// Tiene la direzione dir fino al prossimo punto di decisione; true se Pacman perde una vita
+static bool PlayAction(AutopilotTree *tree, int dir)
+{
+    World *w = &tree->world;
+    int fromCell = w->pacmanCell;
+    for (int t = 0; t < 2 * AUTOPILOT_ACTION_TICKS; t++)
+    {
+        Vector2 before = w->pacmanPos;
+        SimStep(w, inputDirections[dir]);
+        if (w->lives < tree->rootLives || w->gameOver)
+            return true;
+        if (ReachedDecision(w, dir, fromCell))
+            break;
+        if (w->pacmanPos.x == before.x && w->pacmanPos.y == before.y)
+            break;   // Fermo contro un muro
+    }
+    return false;
+}
+
+// Mossa del rollout: a caso tra quelle che non tornano indietro (se non c'e' altro, indietro)
+static int RolloutDirection(AutopilotTree *tree, int lastDir)
+{
+    unsigned char mask = ValidMask(&tree->world);
+    unsigned char forward = lastDir >= 0 ? (unsigned char)(mask & ~(1 << REVERSE(lastDir))) : mask;
+    if (forward)
+        mask = forward;
+    if (!mask)
+        return lastDir >= 0 ? lastDir : 0;
+
+    int pick = (int)(NextRandom(&tree->rng) % (unsigned int)__builtin_popcount(mask));
+    for (int d = 0; d < 4; d++)
+    {
+        if ((mask & (1 << d)) && pick-- == 0)
+            return d;
+    }
+    return 0;
+}
+
+// Valore di un'iterazione in [0, 1]: sopravvivere vale sempre piu' che morire
+static float RolloutValue(const AutopilotTree *tree, bool dead, int actions)
+{
+    if (dead)
+        return 0.25f * (1.0f - 1.0f / (float)(actions + 1));   // Morire tardi e' meno grave
+    float gained = (float)(tree->world.score - tree->rootScore);
+    if (gained < 0.0f)
+        gained = 0.0f;
+    return 0.5f + 0.5f * gained / (gained + AUTOPILOT_SCORE_SCALE);
+}
+
+// Figlio con l'UCB1 piu' alto tra le direzioni gia' espanse
+static int SelectChild(const AutopilotTree *tree, const AutopilotNode *node)
+{
+    float logVisits = logf((float)node->visits);
+    int best = -1;
+    float bestScore = -1.0f;
+    for (int d = 0; d < 4; d++)
+    {
+        int c = node->children[d];
+        if (c == AUTOPILOT_NO_CHILD)
+            continue;
+        const AutopilotNode *child = &tree->nodes[c];
+        float visits = (float)child->visits;
+        float score = child->value / visits + AUTOPILOT_EXPLORATION * sqrtf(logVisits / visits);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = d;
+        }
+    }
+    return best;
+}
+
+// Scadenza passata (deadline 0 = nessuna)
+static bool PastDeadline(double deadline)
+{
+    return deadline > 0.0 && NowSeconds() >= deadline;
+}
+
+bool AutopilotTreeIterate(AutopilotTree *tree, const void *snapshot, double deadline)
+{
+    World *w = &tree->world;
+    SnapshotLoad(w, snapshot);
+
+    int path[AUTOPILOT_MAX_DEPTH + 1];
+    int depth = 0;
+    int node = 0;
+    int lastDir = -1;
+    int created = AUTOPILOT_NO_CHILD;   // Figlio aggiunto in questa iterazione (da togliere se scade)
+    bool dead = false;
+    bool cut = false;                  // Fermata dalla scadenza prima della fine
+    path[depth++] = node;
+
+    // === DISCESA ED ESPANSIONE ===
+    while (depth <= AUTOPILOT_MAX_DEPTH)
+    {
+        AutopilotNode *n = &tree->nodes[node];
+        if (!n->expanded)
+        {
+            n->validMask = ValidMask(w);
+            n->expanded = true;
+        }
+        if (n->terminal || !n->validMask)
+            break;
+
+        unsigned char untried = 0;
+        for (int d = 0; d < 4; d++)
+        {
+            if ((n->validMask & (1 << d)) && n->children[d] == AUTOPILOT_NO_CHILD)
+                untried |= (unsigned char)(1 << d);
+        }
+
+        int dir;
+        if (untried)
+        {
+            // Albero pieno o troppo profondo: da qui solo rollout
+            if (tree->numNodes >= AUTOPILOT_MAX_NODES || depth == AUTOPILOT_MAX_DEPTH)
+                break;
+            int pick = (int)(NextRandom(&tree->rng) % (unsigned int)__builtin_popcount(untried));
+            for (dir = 0; dir < 4; dir++)
+            {
+                if ((untried & (1 << dir)) && pick-- == 0)
+                    break;
+            }
+            node = NewNode(tree);
+            n->children[dir] = node;
+            created = dir;
+        }
+        else
+        {
+            dir = SelectChild(tree, n);
+            node = n->children[dir];
+        }
+
+        dead = PlayAction(tree, dir);
+        lastDir = dir;
+        path[depth++] = node;
+        if (dead)
+            tree->nodes[node].terminal = true;
+        if (dead || untried)
+            break;
+        if (PastDeadline(deadline))
+        {
+            cut = true;
+            break;
+        }
+    }
+
+    // === ROLLOUT CASUALE ===
+    int actions = depth - 1;
+    for (int k = 0; k < AUTOPILOT_ROLLOUT_ACTIONS && !dead && !cut; k++)
+    {
+        if (PastDeadline(deadline))
+        {
+            cut = true;
+            break;
+        }
+        int dir = RolloutDirection(tree, lastDir);
+        dead = PlayAction(tree, dir);
+        lastDir = dir;
+        actions++;
+    }
+
+    // Scaduta a meta': si butta, a parte la prima dell'albero, che vale per come
+    // e' arrivata (almeno una mossa giocata) perche' la radice abbia sempre un figlio
+    if (cut)
+        tree->truncated++;
+    if (cut && tree->nodes[0].visits > 0)
+    {
+        if (created != AUTOPILOT_NO_CHILD)
+        {
+            tree->nodes[path[depth - 2]].children[created] = AUTOPILOT_NO_CHILD;
+            tree->numNodes--;
+        }
+        return false;
+    }
+
+    // === PROPAGAZIONE ===
+    float value = RolloutValue(tree, dead, actions);
+    for (int k = 0; k < depth; k++)
+    {
+        tree->nodes[path[k]].visits++;
+        tree->nodes[path[k]].value += value;
+    }
+    tree->rollouts++;
+    return true;
+}
+
+// === THREAD ===
+
+// Iterazioni fino alla scadenza (almeno una, magari interrotta)
+static void SearchUntilDeadline(Autopilot *ap, AutopilotTree *tree)
+{
+    do
+        AutopilotTreeIterate(tree, ap->snapshot, ap->deadline);
+    while (NowSeconds() < ap->deadline);
+}
+
+static void *AutopilotWorkerMain(void *arg)
+{
+    AutopilotTree *tree = (AutopilotTree *)arg;
+    Autopilot *ap = tree->owner;
+
+    unsigned int seen = 0;
+    pthread_mutex_lock(&ap->lock);
+    for (;;)
+    {
+        while (ap->generation == seen && !ap->stop)
+            pthread_cond_wait(&ap->wake, &ap->lock);
+        if (ap->stop)
+            break;
+        seen = ap->generation;
+        pthread_mutex_unlock(&ap->lock);
+
+        SearchUntilDeadline(ap, tree);
+
+        pthread_mutex_lock(&ap->lock);
+        ap->done++;
+        pthread_cond_signal(&ap->finished);
+    }
+    pthread_mutex_unlock(&ap->lock);
+    return NULL;
+}
+
+bool InitAutopilot(Autopilot *ap, const World *w, int numThreads, int budgetUs)
+{
+    memset(ap, 0, sizeof(*ap));
+    if (numThreads < 1 || numThreads > AUTOPILOT_MAX_THREADS || budgetUs < 1)
+        return false;
+    ap->budgetUs = budgetUs;
+    ap->decisionCell = GRID_NONE;
+    pthread_mutex_init(&ap->lock, NULL);
+    pthread_cond_init(&ap->wake, NULL);
+    pthread_cond_init(&ap->finished, NULL);
+
+    ap->snapshot = malloc(SnapshotSize(w));
+    ap->trees = calloc((size_t)numThreads, sizeof(AutopilotTree));
+    ap->threads = malloc(sizeof(pthread_t) * (size_t)numThreads);
+    if (!ap->snapshot || !ap->trees || !ap->threads)
+    {
+        FreeAutopilot(ap);
+        return false;
+    }
+    for (int i = 0; i < numThreads; i++)
+    {
+        if (!InitAutopilotTree(&ap->trees[i], w))
+        {
+            FreeAutopilot(ap);
+            return false;
+        }
+        ap->trees[i].owner = ap;
+        ap->numThreads++;
+    }
+
+    for (int i = 1; i < numThreads; i++)
+    {
+        if (pthread_create(&ap->threads[i - 1], NULL, AutopilotWorkerMain, &ap->trees[i]) != 0)
+        {
+            FreeAutopilot(ap);
+            return false;
+        }
+        ap->numWorkers++;
+    }
+    return true;
+}
+
+void FreeAutopilot(Autopilot *ap)
+{
+    if (ap->budgetUs > 0)   // InitAutopilot e' arrivato a creare lock e condition variable
+    {
+        pthread_mutex_lock(&ap->lock);
+        ap->stop = true;
+        pthread_cond_broadcast(&ap->wake);
+        pthread_mutex_unlock(&ap->lock);
+        for (int i = 0; i < ap->numWorkers; i++)
+            pthread_join(ap->threads[i], NULL);
+        pthread_cond_destroy(&ap->finished);
+        pthread_cond_destroy(&ap->wake);
+        pthread_mutex_destroy(&ap->lock);
+    }
+    for (int i = 0; ap->trees && i < ap->numThreads; i++)
+        FreeAutopilotTree(&ap->trees[i]);
+    free(ap->trees);
+    free(ap->threads);
+    free(ap->snapshot);
+    memset(ap, 0, sizeof(*ap));
+}
+
+// Cerca la mossa migliore da w su tutti i thread per budgetUs microsecondi
+static int Search(Autopilot *ap, const World *w, unsigned char validMask)
+{
+    double start = NowSeconds();
+    SnapshotSave(w, ap->snapshot);
+    for (int i = 0; i < ap->numThreads; i++)
+        AutopilotTreeReset(&ap->trees[i], w, w->tick * 2654435761u + (unsigned int)i * 40503u + 1u);
+
+    // Nessun thread tocca i campi pubblicati: tutti hanno finito la ricerca precedente
+    pthread_mutex_lock(&ap->lock);
+    ap->deadline = start + ap->budgetUs * 1e-6;
+    ap->done = 0;
+    ap->generation++;
+    pthread_cond_broadcast(&ap->wake);
+    pthread_mutex_unlock(&ap->lock);
+
+    SearchUntilDeadline(ap, &ap->trees[0]);
+
+    pthread_mutex_lock(&ap->lock);
+    while (ap->done < ap->numWorkers)
+        pthread_cond_wait(&ap->finished, &ap->lock);
+    pthread_mutex_unlock(&ap->lock);
+
+    // Somma le visite dei figli della radice di tutti gli alberi
+    unsigned int visits[4] = {0};
+    float value[4] = {0};
+    for (int i = 0; i < ap->numThreads; i++)
+    {
+        const AutopilotTree *tree = &ap->trees[i];
+        for (int d = 0; d < 4; d++)
+        {
+            int c = tree->nodes[0].children[d];
+            if (c == AUTOPILOT_NO_CHILD)
+                continue;
+            visits[d] += tree->nodes[c].visits;
+            value[d] += tree->nodes[c].value;
+        }
+        ap->rollouts += tree->rollouts;
+        ap->truncated += tree->truncated;
+    }
+    double end = NowSeconds();
+    ap->searchSeconds += end - start;
+
+    // Sforamento: l'ultima mossa giocata dopo la scadenza, risveglio e somma delle visite
+    double late = end - ap->deadline;
+    if (late > 0.0)
+    {
+        ap->overrunSeconds += late;
+        if (late > ap->maxOverrunSeconds)
+            ap->maxOverrunSeconds = late;
+    }
+
+    // Piu' visite; a parita' il valore medio piu' alto
+    int best = -1;
+    for (int d = 0; d < 4; d++)
+    {
+        if (!(validMask & (1 << d)) || visits[d] == 0)
+            continue;
+        if (best < 0 || visits[d] > visits[best] ||
+            (visits[d] == visits[best] && value[d] / visits[d] > value[best] / visits[best]))
+            best = d;
+    }
+    return best;
+}
+
+SimInput AutopilotInput(Autopilot *ap, const World *w)
+{
+    if (w->gameOver)
+        return 0;
+
+    int dir = DirectionOf(ap->current);
+    bool stopped = w->pacmanPos.x == ap->lastPos.x && w->pacmanPos.y == ap->lastPos.y;
+    ap->lastPos = w->pacmanPos;
+    if (dir >= 0 && !stopped && !ReachedDecision(w, dir, ap->decisionCell))
+        return ap->current;
+
+    // Punto di decisione: con una sola strada non serve cercare
+    unsigned char validMask = ValidMask(w);
+    int best = -1;
+    if (__builtin_popcount(validMask) == 1)
+        best = __builtin_ctz(validMask);
+    else if (validMask)
+        best = Search(ap, w, validMask);
+    ap->decisions++;
+    ap->decisionCell = w->pacmanCell;
+    ap->current = best >= 0 ? inputDirections[best] : 0;
+    return ap->current;
+}
+
+double AutopilotRolloutsPerSecond(const Autopilot *ap)
+{
+    return ap->searchSeconds > 0.0 ? (double)ap->rollouts / ap->searchSeconds : 0.0;
+}
+
+void AutopilotResetStats(Autopilot *ap)
+{
+    ap->decisions = 0;
+    ap->rollouts = 0;
+    ap->searchSeconds = 0.0;
+    ap->truncated = 0;
+    ap->overrunSeconds = 0.0;
+    ap->maxOverrunSeconds = 0.0;
+}
@@ -0,0 +1,290 @@
+// === BATCH DI PARTITE CON WORK STEALING ===
+#include "lib/batch.h"
+#include "lib/platform.h"
+#include <pthread.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Ogni worker possiede un intervallo [begin, end) di indici di partita,
+ * impacchettato in un solo intero a 64 bit (begin nei 32 bit bassi, end in
+ * quelli alti). Il proprietario prende le partite dal fronte (begin + 1),
+ * i ladri tagliano la coda (end = meta'); entrambe le operazioni sono una
+ * compare-and-swap, quindi nessun lock sul percorso caldo.
+ */
+
+#define BATCH_MAX_THREADS 256
+
+typedef struct {
+    unsigned long long range;   // begin | (end << 32), aggiornato solo con CAS
+    char pad[64 - sizeof(unsigned long long)];  // Una cache line per worker (niente false sharing)
+} WorkQueue;
+
+typedef struct {
+    const BatchConfig *config;
+    WorkQueue *queues;
+    int id;
+    World world;                // Mondo riusato da tutte le partite del worker
+    BatchResult result;         // Risultati locali, sommati alla fine
+} Worker;
+
+static unsigned long long PackRange(unsigned int begin, unsigned int end)
+{
+    return (unsigned long long)begin | ((unsigned long long)end << 32);
+}
+
+static double NowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+unsigned int BatchGameSeed(unsigned int baseSeed, long long index)
+{
+    // splitmix64: semi vicini producono stati xorshift scorrelati
+    unsigned long long z = ((unsigned long long)baseSeed << 32) + (unsigned long long)index + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return (unsigned int)z ? (unsigned int)z : 1u;
+}
+
+// === INPUT DELLE PARTITE ===
+
+static const SimInput inputDirections[4] = {SIM_INPUT_RIGHT, SIM_INPUT_LEFT, SIM_INPUT_DOWN, SIM_INPUT_UP};
+static const Vector2 inputVectors[4] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+SimInput BatchBotInput(const World *w, SimInput previous)
+{
+    Vector2 pos = w->pacmanPos;
+    float half = TILE_SIZE / 2.0f;
+    float offX = pos.x - ((int)pos.x / TILE_SIZE) * TILE_SIZE - half;
+    float offY = pos.y - ((int)pos.y / TILE_SIZE) * TILE_SIZE - half;
+    bool centred = fabsf(offX) <= PACMAN_BASE_SPEED && fabsf(offY) <= PACMAN_BASE_SPEED;
+
+    int current = -1;
+    for (int d = 0; d < 4; d++)
+    {
+        if (previous == inputDirections[d])
+            current = d;
+    }
+
+    // A meta' corridoio continua dritto finche' la strada e' libera
+    if (!centred && current >= 0 && IsDirectionValid(w, pos, inputVectors[current]))
+        return previous;
+
+    // Sull'incrocio valuta le quattro direzioni: lontano dai fantasmi, verso i puntini
+    int best = current;
+    float bestScore = -1e30f;
+    for (int d = 0; d < 4; d++)
+    {
+        if (!IsDirectionValid(w, pos, inputVectors[d]))
+            continue;
+
+        Vector2 next = {pos.x + inputVectors[d].x * TILE_SIZE, pos.y + inputVectors[d].y * TILE_SIZE};
+        float nearestGhost = 1e30f;
+        for (int i = 0; i < w->ghosts.count; i++)
+        {
+            float dist = CalculateDistance(next, SimGhostPos(w, i));
+            if (dist < nearestGhost)
+                nearestGhost = dist;
+        }
+
+        float score = fminf(nearestGhost, 4.0f * TILE_SIZE);
+        if (MapHasDot(&w->map, (int)next.y / TILE_SIZE, (int)next.x / TILE_SIZE))
+            score += TILE_SIZE;
+        if (current >= 0 && inputVectors[d].x == -inputVectors[current].x && inputVectors[d].y == -inputVectors[current].y)
+            score -= TILE_SIZE / 2.0f;  // Evita di fare avanti e indietro
+        score += (float)((w->tick * 31u + (unsigned int)d * 17u) % 7u);  // Rompe i pareggi
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = d;
+        }
+    }
+
+    return best >= 0 ? inputDirections[best] : 0;
+}
+
+SimInput BatchScriptInput(const World *w)
+{
+    // Destra, giu', sinistra, su: un secondo per direzione
+    static const SimInput script[4] = {SIM_INPUT_RIGHT, SIM_INPUT_DOWN, SIM_INPUT_LEFT, SIM_INPUT_UP};
+    return script[(w->tick / (unsigned int)SIM_TICK_RATE) % 4u];
+}
+
+// === CODE DI LAVORO ===
+
+// Il proprietario prende la prossima partita del suo intervallo
+static bool PopLocal(WorkQueue *q, unsigned int *index)
+{
+    unsigned long long old = __atomic_load_n(&q->range, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        unsigned int begin = (unsigned int)old;
+        unsigned int end = (unsigned int)(old >> 32);
+        if (begin >= end)
+            return false;
+        if (__atomic_compare_exchange_n(&q->range, &old, PackRange(begin + 1, end), false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *index = begin;
+            return true;
+        }
+    }
+}
+
+// Ruba la meta' finale dell'intervallo del worker piu' carico
+static bool Steal(Worker *self)
+{
+    int numThreads = self->config->numThreads;
+
+    for (;;)
+    {
+        int victim = -1;
+        unsigned long long victimRange = 0;
+        unsigned int mostLeft = 0;
+
+        for (int i = 0; i < numThreads; i++)
+        {
+            if (i == self->id)
+                continue;
+            unsigned long long r = __atomic_load_n(&self->queues[i].range, __ATOMIC_ACQUIRE);
+            unsigned int begin = (unsigned int)r;
+            unsigned int end = (unsigned int)(r >> 32);
+            if (end > begin && end - begin > mostLeft)
+            {
+                mostLeft = end - begin;
+                victim = i;
+                victimRange = r;
+            }
+        }
+
+        if (victim < 0)
+            return false;   // Nessuno ha piu' lavoro: il batch e' finito
+
+        unsigned int begin = (unsigned int)victimRange;
+        unsigned int end = (unsigned int)(victimRange >> 32);
+        unsigned int mid = begin + (end - begin) / 2;   // Se resta 1 partita, mid == begin: la prende tutta
+
+        if (__atomic_compare_exchange_n(&self->queues[victim].range, &victimRange, PackRange(begin, mid), false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            // La coda locale e' vuota: solo il proprietario puo' riempirla
+            __atomic_store_n(&self->queues[self->id].range, PackRange(mid, end), __ATOMIC_RELEASE);
+            self->result.steals++;
+            return true;
+        }
+        // CAS fallita: la vittima ha cambiato intervallo nel frattempo, riprova
+    }
+}
+
+// Gioca una partita completa e accumula le statistiche del worker
+static void PlayGame(Worker *self, unsigned int index)
+{
+    const BatchConfig *config = self->config;
+    World *world = &self->world;
+    SimInit(world, BatchGameSeed(config->baseSeed, index));
+
+    SimInput input = 0;
+    while (!world->gameOver && (config->maxTicksPerGame <= 0 || (long long)world->tick < config->maxTicksPerGame))
+    {
+        input = (config->inputMode == BATCH_INPUT_BOT) ? BatchBotInput(world, input) : BatchScriptInput(world);
+        SimStep(world, input);
+    }
+
+    self->result.games++;
+    self->result.ticks += world->tick;
+    self->result.totalScore += world->score;
+    if (world->gameOver)
+        self->result.gamesOver++;
+    if (world->score > self->result.maxScore)
+        self->result.maxScore = world->score;
+}
+
+static void *WorkerMain(void *arg)
+{
+    Worker *self = (Worker *)arg;
+    unsigned int index;
+
+    for (;;)
+    {
+        while (PopLocal(&self->queues[self->id], &index))
+            PlayGame(self, index);
+        if (!Steal(self))
+            break;
+    }
+    return NULL;
+}
+
+int RunBatch(const BatchConfig *config, BatchResult *result)
+{
+    int numThreads = config->numThreads;
+    if (numThreads < 1 || numThreads > BATCH_MAX_THREADS || config->numGames < 0 || config->numGames > 0xFFFFFFFFll || !config->maze)
+        return -1;
+
+    WorkQueue *queues = AlignedAlloc(64, sizeof(WorkQueue) * (size_t)numThreads);
+    Worker *workers = calloc((size_t)numThreads, sizeof(Worker));
+    pthread_t *threads = calloc((size_t)numThreads, sizeof(pthread_t));
+    bool ok = queues && workers && threads;
+    for (int i = 0; ok && i < numThreads; i++)
+        ok = SimCreate(&workers[i].world, config->maze, config->numGhosts > 0 ? config->numGhosts : NUM_GHOST);
+    if (!ok)
+    {
+        for (int i = 0; workers && i < numThreads; i++)
+            SimDestroy(&workers[i].world);
+        AlignedFree(queues);
+        free(workers);
+        free(threads);
+        return -1;
+    }
+
+    // Divide le partite in blocchi contigui, uno per worker
+    unsigned int total = (unsigned int)config->numGames;
+    for (int i = 0; i < numThreads; i++)
+    {
+        unsigned int begin = (unsigned int)((unsigned long long)total * i / numThreads);
+        unsigned int end = (unsigned int)((unsigned long long)total * (i + 1) / numThreads);
+        queues[i].range = PackRange(begin, end);
+        workers[i].config = config;
+        workers[i].queues = queues;
+        workers[i].id = i;
+    }
+
+    double start = NowSeconds();
+    int started = 0;
+    for (int i = 1; i < numThreads; i++)
+    {
+        if (pthread_create(&threads[i], NULL, WorkerMain, &workers[i]) != 0)
+            break;
+        started = i;
+    }
+    WorkerMain(&workers[0]);  // Anche il thread chiamante lavora (e ruba ai thread non partiti)
+    for (int i = 1; i <= started; i++)
+        pthread_join(threads[i], NULL);
+    double elapsed = NowSeconds() - start;
+
+    memset(result, 0, sizeof(*result));
+    for (int i = 0; i < numThreads; i++)
+    {
+        result->games += workers[i].result.games;
+        result->gamesOver += workers[i].result.gamesOver;
+        result->ticks += workers[i].result.ticks;
+        result->totalScore += workers[i].result.totalScore;
+        result->steals += workers[i].result.steals;
+        if (workers[i].result.maxScore > result->maxScore)
+            result->maxScore = workers[i].result.maxScore;
+    }
+    result->seconds = elapsed;
+
+    for (int i = 0; i < numThreads; i++)
+        SimDestroy(&workers[i].world);
+    AlignedFree(queues);
+    free(workers);
+    free(threads);
+    return 0;
+}
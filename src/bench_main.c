@@ -0,0 +1,607 @@
+// === MICROBENCHMARK DELLA SIMULAZIONE (make bench) ===
+// Misura le singole fasi di un tick su piu' labirinti e numeri di fantasmi e
+// stampa mediana e p99 di ogni misura in JSON (su stdout; l'avanzamento va su stderr).
+// Confrontando il JSON di due commit si vede subito quale fase e' peggiorata.
+#include "lib/sim.h"
+#include "lib/batch.h"
+#include "lib/flowfield.h"
+#include "lib/hpa.h"
+#include "lib/mazegen.h"
+#include "lib/ghostpool.h"
+#include "lib/autopilot.h"
+#include "lib/snapshot.h"
+#include "lib/env.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lib/platform.h"
+
+#define BENCH_DEFAULT_SAMPLES 200      // Campioni misurati per benchmark
+#define BENCH_MIN_SAMPLE_NS   2000.0   // Le operazioni brevi si ripetono fino a questa durata per campione
+#define BENCH_MAX_OPS         (1 << 20)
+#define BENCH_WARMUP_TICKS    600      // Tick giocati prima di misurare (power-up, fantasmi sparsi)
+#define BENCH_PROBES          1024     // Posizioni pre-calcolate per IsDirectionValid
+#define BENCH_LIVES           1000000  // Vite di Pacman durante le misure
+#define BENCH_ENVS            4        // Partite dell'ambiente RL in env_step
+
+static double NowNanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// === CONTESTO DI UN BENCHMARK ===
+typedef struct {
+    World world;
+    unsigned int seed;
+    SimInput input;                    // Ultimo input del bot (per i tick completi)
+    Vector2 probePos[BENCH_PROBES];    // Posizioni e direzioni per IsDirectionValid
+    Vector2 probeDir[BENCH_PROBES];
+    volatile int sink;                 // Impedisce al compilatore di eliminare i risultati
+    GhostPool *pool;                   // Pool per ghost_pool (--threads)
+    AutopilotTree *tree;               // Albero e World di lavoro per mcts_rollout e world_clone
+    unsigned char *snapshot;           // Stato di partenza delle iterazioni (SnapshotSave)
+    PacmanEnv *env;                    // Ambiente RL per env_step e env_observe
+    unsigned char *obs;                // Osservazioni di BENCH_ENVS partite
+    int actions[BENCH_ENVS];
+    unsigned int *bfsDist;             // Distanze e coda della BFS completa per flow_field_bfs
+    int *bfsQueue;                     // sui labirinti gerarchici, dove il World non le ha
+} BenchContext;
+
+typedef struct {
+    const char *name;
+    bool perGhostCount;                       // Ripetuto per ogni numero di fantasmi
+    bool repeatable;                          // run si puo' ripetere ops volte senza setup in mezzo
+    bool hpa;                                 // Solo sui labirinti col flow field gerarchico
+    int ops;                                  // Operazioni per campione (di partenza, se repeatable)
+    void (*setup)(BenchContext *ctx);         // Prima di ogni campione, fuori dal tempo (o NULL)
+    void (*run)(BenchContext *ctx, int ops);  // ops operazioni misurate
+} Benchmark;
+
+// Una partita finita non avanza piu' (SimStep non fa nulla): con vite a volonta'
+// ogni tick misurato e' un tick vero
+static void KeepPlaying(BenchContext *ctx)
+{
+    if (ctx->world.gameOver)
+        SimInit(&ctx->world, ++ctx->seed);
+    ctx->world.lives = BENCH_LIVES;
+}
+
+static void RunTick(BenchContext *ctx, int ops)
+{
+    for (int k = 0; k < ops; k++)
+    {
+        ctx->input = BatchBotInput(&ctx->world, ctx->input);
+        SimStep(&ctx->world, ctx->input);
+    }
+}
+
+static GhostStepParams GhostParams(const World *w)
+{
+    GhostStepParams params = {
+        .flowDir = w->flowDir,
+        .graph = &w->junctions,
+        .speedMultiplier = GetGhostSpeed(w, 1.0f)};
+    return params;
+}
+
+// Kernel dei fantasmi da solo: movimento sugli archi e decisioni sui nodi
+static void RunGhostKernel(BenchContext *ctx, int ops)
+{
+    GhostStepParams params = GhostParams(&ctx->world);
+    for (int k = 0; k < ops; k++)
+        StepGhostRange(&ctx->world.ghosts, &params, 0, ctx->world.ghosts.count);
+}
+
+// Stesso kernel diviso tra i thread del pool (seriale sotto GHOST_POOL_MIN_GHOSTS)
+static void RunGhostPool(BenchContext *ctx, int ops)
+{
+    GhostStepParams params = GhostParams(&ctx->world);
+    for (int k = 0; k < ops; k++)
+        GhostPoolStep(ctx->pool, &ctx->world.ghosts, &params);
+}
+
+// Fase dei fantasmi di un tick: come il kernel, piu' flow field (se Pacman cambia cella) e griglia
+static void RunGhostPhase(BenchContext *ctx, int ops)
+{
+    for (int k = 0; k < ops; k++)
+        SimStepGhosts(&ctx->world);
+}
+
+// Flow field ricalcolato da zero (quello che succede quando Pacman cambia cella);
+// sui labirinti grandi solo nei cluster dei fantasmi
+static void SetupFlowField(BenchContext *ctx)
+{
+    InvalidateFlowField(&ctx->world);
+}
+
+static void RunFlowField(BenchContext *ctx, int ops)
+{
+    (void)ops;
+    UpdateFlowField(&ctx->world);
+}
+
+// Stesso ricalcolo con la BFS completa anche sui labirinti dove il campo e'
+// gerarchico (vedi hpa.h): il confronto tra i due e' la differenza tra le righe.
+// Li' il World non ha distanze ne' coda della BFS: gliele presta il benchmark
+static void SetupFlowFieldBfs(BenchContext *ctx)
+{
+    World *w = &ctx->world;
+    size_t numCells = (size_t)w->map.rows * (size_t)w->map.cols;
+    if (w->hpa && !ctx->bfsDist)
+    {
+        ctx->bfsDist = malloc(sizeof(unsigned int) * numCells);
+        ctx->bfsQueue = malloc(sizeof(int) * numCells);
+        if (!ctx->bfsDist || !ctx->bfsQueue)
+        {
+            fprintf(stderr, "Errore: memoria insufficiente per la BFS completa\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    InvalidateFlowField(w);
+}
+
+static void RunFlowFieldBfs(BenchContext *ctx, int ops)
+{
+    (void)ops;
+    World *w = &ctx->world;
+    struct HpaPlanner *hpa = w->hpa;
+    if (hpa)
+    {
+        w->hpa = NULL;
+        w->flowDist = ctx->bfsDist;
+        w->flowQueue = ctx->bfsQueue;
+    }
+    UpdateFlowField(w);
+    if (hpa)
+    {
+        w->hpa = hpa;
+        w->flowDist = NULL;
+        w->flowQueue = NULL;
+    }
+}
+
+static void FreeBenchFlowField(BenchContext *ctx)
+{
+    free(ctx->bfsDist);
+    free(ctx->bfsQueue);
+    ctx->bfsDist = NULL;
+    ctx->bfsQueue = NULL;
+}
+
+// Interrogazioni del planner gerarchico dopo un passo di Pacman: il campo parte
+// aggiornato, Pacman si sposta e si misura l'UpdateFlowField che segue (il cambio
+// di ancora, i cluster attorno a Pacman e quelli dei fantasmi da completare)
+static void MovePacman(World *w, int row, int col)
+{
+    w->pacmanPos = (Vector2){col * TILE_SIZE + TILE_SIZE / 2.0f, row * TILE_SIZE + TILE_SIZE / 2.0f};
+}
+
+// Una cella libera accanto, nello stesso cluster: l'ancora non cambia
+static void SetupHpaMove(BenchContext *ctx)
+{
+    World *w = &ctx->world;
+    UpdateFlowField(w);
+    int row = w->flowRow, col = w->flowCol;
+    for (int d = 0; d < 4; d++)
+    {
+        int nr = row + (int)flowDirections[d].y;
+        int nc = col + (int)flowDirections[d].x;
+        if (!MapIsWall(&w->map, nr, nc) && nr >> HPA_CLUSTER_SHIFT == row >> HPA_CLUSTER_SHIFT &&
+            nc >> HPA_CLUSTER_SHIFT == col >> HPA_CLUSTER_SHIFT)
+        {
+            MovePacman(w, nr, nc);
+            return;
+        }
+    }
+}
+
+// La prima cella libera del cluster a destra (o del primo della riga): ancora
+// nuova, la ricerca astratta riparte da zero
+static void SetupHpaNewCluster(BenchContext *ctx)
+{
+    World *w = &ctx->world;
+    UpdateFlowField(w);
+    int row0 = w->flowRow & ~(HPA_CLUSTER_SIZE - 1);
+    int col0 = (w->flowCol | (HPA_CLUSTER_SIZE - 1)) + 1;
+    if (col0 >= w->map.cols)
+        col0 = 0;
+    for (int row = row0; row < row0 + HPA_CLUSTER_SIZE && row < w->map.rows; row++)
+    {
+        for (int col = col0; col < col0 + HPA_CLUSTER_SIZE && col < w->map.cols; col++)
+        {
+            if (!MapIsWall(&w->map, row, col))
+            {
+                MovePacman(w, row, col);
+                return;
+            }
+        }
+    }
+}
+
+static void SetupProbes(BenchContext *ctx)
+{
+    static const Vector2 directions[4] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    const MapBits *map = &ctx->world.map;
+    unsigned int state = ctx->seed;
+    for (int k = 0; k < BENCH_PROBES; k++)
+    {
+        state = state * 1103515245u + 12345u;
+        int col = (int)((state >> 8) % (unsigned int)map->cols);
+        state = state * 1103515245u + 12345u;
+        int row = (int)((state >> 8) % (unsigned int)map->rows);
+        ctx->probePos[k] = (Vector2){col * TILE_SIZE + TILE_SIZE / 2.0f, row * TILE_SIZE + TILE_SIZE / 2.0f};
+        ctx->probeDir[k] = directions[(state >> 4) & 3];
+    }
+}
+
+static void RunDirectionValid(BenchContext *ctx, int ops)
+{
+    int valid = 0;
+    for (int k = 0; k < ops; k++)
+        valid += IsDirectionValid(&ctx->world, ctx->probePos[k & (BENCH_PROBES - 1)], ctx->probeDir[k & (BENCH_PROBES - 1)]);
+    ctx->sink = valid;
+}
+
+// Spawn di MAX_POWERUPS power-up su una mappa senza power-up
+static void SetupPowerUpSpawn(BenchContext *ctx)
+{
+    World *w = &ctx->world;
+    for (int i = 0; i < MAX_POWERUPS; i++)
+    {
+        if (!w->powerups[i].isActive)
+            continue;
+        w->powerups[i].isActive = false;
+        GridRemove(&w->powerupGrid, i);
+        MapAddFreeCell(&w->map, GridCellOfPoint(&w->map, w->powerups[i].pos.x, w->powerups[i].pos.y));
+    }
+}
+
+static void RunPowerUpSpawn(BenchContext *ctx, int ops)
+{
+    for (int k = 0; k < ops; k++)
+        SpawnPowerUp(&ctx->world);
+}
+
+// Fase dei power-up di un tick (scadenze e spawn casuale) piu' il controllo di raccolta
+static void RunPowerUpUpdate(BenchContext *ctx, int ops)
+{
+    World *w = &ctx->world;
+    for (int k = 0; k < ops; k++)
+    {
+        SimStepPowerUps(w);
+        CheckPowerUpCollection(w);
+        w->tick++;
+    }
+}
+
+// Collisioni Pacman-fantasmi; l'invincibilita' salterebbe tutto il controllo
+static void SetupCollisions(BenchContext *ctx)
+{
+    World *w = &ctx->world;
+    w->activeEffects &= ~(1u << POWERUP_INVINCIBLE);
+    w->lives = BENCH_LIVES;
+}
+
+static void RunCollisions(BenchContext *ctx, int ops)
+{
+    for (int k = 0; k < ops; k++)
+        SimStepCollisions(&ctx->world);
+}
+
+// Albero dell'autopilota sul World del benchmark, creato al primo campione
+// e liberato dopo la misura (FreeBenchAutopilot)
+static void SetupAutopilot(BenchContext *ctx)
+{
+    World *w = &ctx->world;
+    if (!ctx->tree)
+    {
+        ctx->tree = malloc(sizeof(AutopilotTree));
+        ctx->snapshot = malloc(SnapshotSize(w));
+        if (!ctx->tree || !ctx->snapshot || !InitAutopilotTree(ctx->tree, w))
+        {
+            fprintf(stderr, "Errore: memoria insufficiente per l'autopilota\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    SnapshotSave(w, ctx->snapshot);
+    AutopilotTreeReset(ctx->tree, w, ctx->seed);
+}
+
+static void FreeBenchAutopilot(BenchContext *ctx)
+{
+    if (ctx->tree)
+        FreeAutopilotTree(ctx->tree);
+    free(ctx->tree);
+    free(ctx->snapshot);
+    ctx->tree = NULL;
+    ctx->snapshot = NULL;
+}
+
+// Un'iterazione MCTS: clonazione del World, discesa, espansione e rollout
+static void RunMctsRollout(BenchContext *ctx, int ops)
+{
+    for (int k = 0; k < ops; k++)
+        AutopilotTreeIterate(ctx->tree, ctx->snapshot, 0.0);
+}
+
+// Solo la clonazione: ripristino dello snapshot (con le griglie da rifare)
+static void RunWorldClone(BenchContext *ctx, int ops)
+{
+    for (int k = 0; k < ops; k++)
+        SnapshotLoad(&ctx->tree->world, ctx->snapshot);
+}
+
+// Ambiente RL sul labirinto e sui fantasmi del benchmark, creato al primo
+// campione e liberato dopo la misura (FreeBenchEnv)
+static void SetupEnv(BenchContext *ctx)
+{
+    if (ctx->env)
+        return;
+    EnvConfig config = {0};
+    config.maze = ctx->world.maze;
+    config.numEnvs = BENCH_ENVS;
+    config.numGhosts = ctx->world.ghosts.count;
+    config.baseSeed = ctx->seed;
+    ctx->env = malloc(sizeof(PacmanEnv));
+    if (!ctx->env || !EnvCreate(ctx->env, &config) ||
+        !(ctx->obs = malloc(EnvObservationSize(ctx->env) * BENCH_ENVS)))
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per l'ambiente RL\n");
+        exit(EXIT_FAILURE);
+    }
+    EnvReset(ctx->env, ctx->obs);
+}
+
+static void FreeBenchEnv(BenchContext *ctx)
+{
+    if (ctx->env)
+        EnvDestroy(ctx->env);
+    free(ctx->env);
+    free(ctx->obs);
+    ctx->env = NULL;
+    ctx->obs = NULL;
+}
+
+// Un passo di BENCH_ENVS partite con le osservazioni (direzioni a rotazione)
+static void RunEnvStep(BenchContext *ctx, int ops)
+{
+    for (int k = 0; k < ops; k++)
+    {
+        for (int i = 0; i < BENCH_ENVS; i++)
+            ctx->actions[i] = 1 + (int)((ctx->env->steps / BENCH_ENVS / 16 + i) % (ENV_NUM_ACTIONS - 1));
+        EnvStep(ctx->env, ctx->actions, ctx->obs, NULL, NULL);
+    }
+}
+
+// Solo l'aggiornamento dell'osservazione di una partita (quello di ogni EnvStep)
+static void RunEnvObserve(BenchContext *ctx, int ops)
+{
+    for (int k = 0; k < ops; k++)
+        EnvUpdateObservation(ctx->env, 0, ctx->obs);
+}
+
+static const Benchmark benchmarks[] = {
+    {"tick",               true,  true,  false, 1,            KeepPlaying,        RunTick},
+    {"ghost_kernel",       true,  true,  false, 1,            NULL,               RunGhostKernel},
+    {"ghost_pool",         true,  true,  false, 1,            NULL,               RunGhostPool},
+    {"ghost_phase",        true,  true,  false, 1,            NULL,               RunGhostPhase},
+    {"collisions",         true,  true,  false, 1,            SetupCollisions,    RunCollisions},
+    {"flow_field",         false, false, false, 1,            SetupFlowField,     RunFlowField},
+    {"flow_field_bfs",     false, false, false, 1,            SetupFlowFieldBfs,  RunFlowFieldBfs},
+    {"hpa_move",           true,  false, true,  1,            SetupHpaMove,       RunFlowField},
+    {"hpa_new_cluster",    true,  false, true,  1,            SetupHpaNewCluster, RunFlowField},
+    {"is_direction_valid", false, true,  false, 1,            SetupProbes,        RunDirectionValid},
+    {"powerup_spawn",      false, false, false, MAX_POWERUPS, SetupPowerUpSpawn,  RunPowerUpSpawn},
+    {"powerup_update",     false, true,  false, 1,            NULL,               RunPowerUpUpdate},
+    {"mcts_rollout",       false, true,  false, 1,            SetupAutopilot,     RunMctsRollout},
+    {"world_clone",        false, true,  false, 1,            SetupAutopilot,     RunWorldClone},
+    {"env_step",           false, true,  false, 1,            SetupEnv,           RunEnvStep},
+    {"env_observe",        false, true,  false, 1,            SetupEnv,           RunEnvObserve},
+};
+#define NUM_BENCHMARKS ((int)(sizeof(benchmarks) / sizeof(benchmarks[0])))
+
+// === STATISTICHE ===
+static int CompareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Percentile (0..100) di valori gia' ordinati, per rango piu' vicino
+static double Percentile(const double *sorted, int count, double percent)
+{
+    int rank = (int)(percent / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+typedef struct {
+    int ops;                   // Operazioni per campione
+    double median, p99, min;   // Nanosecondi per operazione
+} BenchStats;
+
+// Un campione: setup fuori dal tempo, poi ops operazioni misurate (ns per operazione)
+static double Sample(const Benchmark *bench, BenchContext *ctx, int ops)
+{
+    if (bench->setup)
+        bench->setup(ctx);
+    double start = NowNanoseconds();
+    bench->run(ctx, ops);
+    return (NowNanoseconds() - start) / ops;
+}
+
+static BenchStats Measure(const Benchmark *bench, BenchContext *ctx, int samples, double *times)
+{
+    BenchStats stats = {0};
+    stats.ops = bench->ops;
+
+    // Riscaldamento: le operazioni brevi vengono raggruppate finche' un campione
+    // non supera BENCH_MIN_SAMPLE_NS (la risoluzione del timer non conta piu')
+    for (int k = 0; k < samples / 10 + 1; k++)
+    {
+        double perOp = Sample(bench, ctx, stats.ops);
+        while (bench->repeatable && perOp * stats.ops < BENCH_MIN_SAMPLE_NS && stats.ops < BENCH_MAX_OPS)
+        {
+            stats.ops *= 2;
+            perOp = Sample(bench, ctx, stats.ops);
+        }
+    }
+
+    for (int k = 0; k < samples; k++)
+        times[k] = Sample(bench, ctx, stats.ops);
+    qsort(times, (size_t)samples, sizeof(double), CompareDoubles);
+    stats.median = Percentile(times, samples, 50.0);
+    stats.p99 = Percentile(times, samples, 99.0);
+    stats.min = times[0];
+    return stats;
+}
+
+// === CONFIGURAZIONI ===
+typedef struct {
+    const char *name;
+    const char *path;   // Labirinto da file, oppure...
+    int cols, rows;     // ...generato (seme 1)
+    bool hpaOnly;       // Solo i benchmark del planner gerarchico (gli altri costerebbero troppo)
+} BenchMaze;
+
+static const BenchMaze mazes[] = {
+    {"classic", SIM_DEFAULT_MAZE, 0, 0, false},
+    {"gen63",   NULL, 63, 63, false},
+    {"gen255",  NULL, 255, 255, false},
+    {"gen1023", NULL, 1023, 1023, false},
+    {"gen2000", NULL, 2000, 2000, true},
+};
+#define NUM_MAZES ((int)(sizeof(mazes) / sizeof(mazes[0])))
+
+static const int ghostCounts[] = {NUM_GHOST, 256, 4096, 32768};
+#define NUM_GHOST_COUNTS ((int)(sizeof(ghostCounts) / sizeof(ghostCounts[0])))
+
+static void PrintUsage(const char *prog)
+{
+    printf("Uso: %s [--samples N] [--filter NOME] [--kernel K] [--threads T]\n", prog);
+    printf("  --samples N    campioni per benchmark (default %d)\n", BENCH_DEFAULT_SAMPLES);
+    printf("  --filter NOME  esegue solo i benchmark il cui nome contiene NOME\n");
+    printf("  --kernel K     kernel dei fantasmi: auto (default), scalar, sse4.1 o avx2\n");
+    printf("  --threads T    thread del pool per ghost_pool (default: numero di core)\n");
+}
+
+int main(int argc, char **argv)
+{
+    int samples = BENCH_DEFAULT_SAMPLES;
+    const char *filter = NULL;
+    int numThreads = CpuCount();
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+            samples = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc)
+        {
+            static const char *names[] = {"auto", "scalar", "sse4.1", "avx2"};
+            static const GhostKernel kernels[] = {GHOST_KERNEL_AUTO, GHOST_KERNEL_SCALAR, GHOST_KERNEL_SSE41, GHOST_KERNEL_AVX2};
+            const char *name = argv[++i];
+            int k = 0;
+            while (k < 4 && strcmp(name, names[k]) != 0)
+                k++;
+            if (k == 4 || !SetGhostKernel(kernels[k]))
+            {
+                fprintf(stderr, "Errore: kernel %s non disponibile\n", name);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (samples < 1 || numThreads < 1 || numThreads > GHOST_POOL_MAX_THREADS)
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    double *times = malloc(sizeof(double) * (size_t)samples);
+    BenchContext *ctx = calloc(1, sizeof(BenchContext));
+    static GhostPool pool;
+    if (!times || !ctx || !InitGhostPool(&pool, numThreads))
+        return EXIT_FAILURE;
+    ctx->pool = &pool;
+
+    printf("{\n");
+    printf("  \"tick_rate\": %d,\n", SIM_TICK_RATE);
+    printf("  \"ghost_kernel\": \"%s\",\n", GetGhostKernelName(GetGhostKernel()));
+    printf("  \"ghost_threads\": %d,\n", pool.numThreads);
+    printf("  \"samples\": %d,\n", samples);
+    printf("  \"unit\": \"ns/op\",\n");
+    printf("  \"results\": [");
+    bool first = true;
+
+    for (int m = 0; m < NUM_MAZES; m++)
+    {
+        Maze maze;
+        bool loaded = mazes[m].path ? MazeLoadFile(&maze, mazes[m].path)
+                                    : MazeGenerate(&maze, mazes[m].cols, mazes[m].rows, 1);
+        if (!loaded)
+        {
+            fprintf(stderr, "Errore: labirinto %s non disponibile\n", mazes[m].name);
+            return EXIT_FAILURE;
+        }
+
+        for (int g = 0; g < NUM_GHOST_COUNTS; g++)
+        {
+            // Stesso punto di partenza per ogni benchmark: partita giocata per BENCH_WARMUP_TICKS tick
+            for (int b = 0; b < NUM_BENCHMARKS; b++)
+            {
+                const Benchmark *bench = &benchmarks[b];
+                if (!bench->perGhostCount && g > 0)
+                    continue;
+                if (filter && !strstr(bench->name, filter))
+                    continue;
+                bool hierarchical = (long long)maze.cols * maze.rows >= HPA_MIN_CELLS;
+                if ((bench->hpa && !hierarchical) || (!bench->hpa && mazes[m].hpaOnly))
+                    continue;
+
+                ctx->seed = 1;
+                ctx->input = 0;
+                // Un solo World per tutto il bench: SimReload riusa la sua arena
+                bool ready = ctx->world.arena.base ? SimReload(&ctx->world, &maze, ghostCounts[g])
+                                                   : SimCreate(&ctx->world, &maze, ghostCounts[g]);
+                if (!ready)
+                    return EXIT_FAILURE;
+                SimInit(&ctx->world, ctx->seed);
+                RunTick(ctx, BENCH_WARMUP_TICKS);
+                KeepPlaying(ctx);
+
+                BenchStats stats = Measure(bench, ctx, samples, times);
+                FreeBenchAutopilot(ctx);
+                FreeBenchEnv(ctx);
+                FreeBenchFlowField(ctx);
+
+                printf("%s\n    {\"name\": \"%s\", \"maze\": \"%s\", \"cols\": %d, \"rows\": %d, \"ghosts\": %d, "
+                       "\"ops_per_sample\": %d, \"median\": %.1f, \"p99\": %.1f, \"min\": %.1f}",
+                       first ? "" : ",", bench->name, mazes[m].name, maze.cols, maze.rows, ghostCounts[g],
+                       stats.ops, stats.median, stats.p99, stats.min);
+                fflush(stdout);
+                first = false;
+                fprintf(stderr, "%-20s %-8s %5d fantasmi  mediana %12.1f ns  p99 %12.1f ns\n",
+                        bench->name, mazes[m].name, ghostCounts[g], stats.median, stats.p99);
+            }
+        }
+        MazeFree(&maze);
+    }
+
+    printf("\n  ]\n}\n");
+    SimDestroy(&ctx->world);
+    FreeGhostPool(&pool);
+    free(times);
+    free(ctx);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+// === CONTROLLI DI REGRESSIONE (make check) ===
+// Gira sulla simulazione headless, senza finestra, e verifica le proprieta' da
+// cui dipendono replay, rewind e caricamento dei labirinti:
+//  - una partita registrata e rigiocata arriva allo stesso World, byte per byte
+//  - SnapshotSave -> SnapshotLoad -> SnapshotSave da' lo stesso buffer
+//  - MazeParse rifiuta i labirinti malformati
+// Stampa una riga per controllo ed esce con EXIT_FAILURE se uno fallisce.
+#include "lib/sim.h"
+#include "lib/batch.h"
+#include "lib/replay.h"
+#include "lib/mazegen.h"
+#include "lib/snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_REPLAY_PATH     "pacman_check.rec"  // File temporaneo della registrazione, cancellato alla fine
+#define CHECK_SNAPSHOT_EVERY  250                 // Tick tra due snapshot controllati
+#define CHECK_SNAPSHOT_AFTER  120                 // Tick giocati da entrambi i World dopo il ripristino
+#define CHECK_LIVES           1000000             // Vite nei controlli degli snapshot: la partita arriva alla fine
+
+static int failures = 0;
+
+static void Report(bool ok, const char *what, const char *maze)
+{
+    printf("%s %s (%s)\n", ok ? "ok     " : "FALLITO", what, maze);
+    if (!ok)
+        failures++;
+}
+
+// Stato completo di w in un buffer nuovo (azzerato, cosi' la coda non usata e' uguale)
+static unsigned char *SaveWorld(const World *w)
+{
+    unsigned char *buffer = calloc(1, SnapshotSize(w));
+    if (buffer)
+        SnapshotSave(w, buffer);
+    return buffer;
+}
+
+// Vero se i due World hanno lo stesso stato, byte per byte
+static bool SameWorld(const World *a, const World *b)
+{
+    if (SnapshotSize(a) != SnapshotSize(b))
+        return false;
+    unsigned char *bufferA = SaveWorld(a);
+    unsigned char *bufferB = SaveWorld(b);
+    bool same = bufferA && bufferB && memcmp(bufferA, bufferB, SnapshotSize(a)) == 0;
+    free(bufferA);
+    free(bufferB);
+    return same;
+}
+
+// === REPLAY ===
+// Gioca ticks tick col bot registrando l'input, salva e rilegge la registrazione
+// e la rigioca su un secondo World: i due stati finali devono coincidere
+static void CheckReplay(const Maze *maze, const char *name, int numGhosts, unsigned int seed, long long ticks)
+{
+    World played, replayed;
+    if (!SimCreate(&played, maze, numGhosts))
+    {
+        Report(false, "replay: memoria insufficiente", name);
+        return;
+    }
+    if (!SimCreate(&replayed, maze, numGhosts))
+    {
+        SimDestroy(&played);
+        Report(false, "replay: memoria insufficiente", name);
+        return;
+    }
+
+    Replay recording, loaded;
+    SimInit(&played, seed);
+    ReplayInit(&recording, seed, numGhosts, maze->hash);
+    SimInput input = 0;
+    bool ok = true;
+    for (long long t = 0; t < ticks && !played.gameOver && ok; t++)
+    {
+        input = BatchBotInput(&played, input);
+        ok = ReplayRecord(&recording, input);
+        SimStep(&played, input);
+    }
+    ok = ok && ReplaySave(&recording, CHECK_REPLAY_PATH);
+    ReplayFree(&recording);
+    ok = ok && ReplayLoad(&loaded, CHECK_REPLAY_PATH);
+    remove(CHECK_REPLAY_PATH);
+    Report(ok, "replay: registrazione salvata e riletta", name);
+
+    if (ok)
+    {
+        ok = loaded.seed == seed && loaded.numGhosts == numGhosts && loaded.mazeHash == maze->hash;
+        ReplayCursor cursor;
+        ReplayCursorInit(&cursor, &loaded);
+        SimInit(&replayed, loaded.seed);
+        while (ok && ReplayNext(&cursor, &input))
+            SimStep(&replayed, input);
+        ReplayFree(&loaded);
+        Report(ok && replayed.tick == played.tick && SameWorld(&played, &replayed),
+               "replay: stesso World alla fine della partita", name);
+    }
+
+    SimDestroy(&replayed);
+    SimDestroy(&played);
+}
+
+// === SNAPSHOT ===
+// Durante una partita salva lo stato, lo carica in un World che sta giocando
+// un'altra partita e lo risalva: i due buffer devono essere identici. Poi i
+// due World giocano qualche tick con lo stesso input e devono restare uguali
+// (le cache ricostruite da SnapshotLoad non cambiano la simulazione)
+static void CheckSnapshots(const Maze *maze, const char *name, int numGhosts, unsigned int seed, long long ticks)
+{
+    World source, target;
+    if (!SimCreate(&source, maze, numGhosts))
+    {
+        Report(false, "snapshot: memoria insufficiente", name);
+        return;
+    }
+    if (!SimCreate(&target, maze, numGhosts))
+    {
+        SimDestroy(&source);
+        Report(false, "snapshot: memoria insufficiente", name);
+        return;
+    }
+
+    size_t size = SnapshotSize(&source);
+    unsigned char *first = malloc(size);
+    unsigned char *second = malloc(size);
+    bool roundTrip = first && second;
+    bool sameAfter = roundTrip;
+    int checked = 0;
+
+    SimInit(&source, seed);
+    SimInit(&target, seed + 1);
+    source.lives = CHECK_LIVES;
+    target.lives = CHECK_LIVES;
+    SimInput input = 0, otherInput = 0;
+    for (long long t = 1; t <= ticks && !source.gameOver && roundTrip && sameAfter; t++)
+    {
+        input = BatchBotInput(&source, input);
+        SimStep(&source, input);
+        otherInput = BatchBotInput(&target, otherInput);
+        SimStep(&target, otherInput);
+        if (t % CHECK_SNAPSHOT_EVERY != 0)
+            continue;
+
+        memset(first, 0, size);
+        memset(second, 0, size);
+        SnapshotSave(&source, first);
+        roundTrip = SnapshotLoad(&target, first);
+        SnapshotSave(&target, second);
+        roundTrip = roundTrip && memcmp(first, second, size) == 0;
+        checked++;
+
+        // Il World ripristinato prosegue come l'originale
+        otherInput = input;
+        for (int k = 0; k < CHECK_SNAPSHOT_AFTER && roundTrip; k++)
+        {
+            input = BatchBotInput(&source, input);
+            SimStep(&source, input);
+            otherInput = BatchBotInput(&target, otherInput);
+            SimStep(&target, otherInput);
+        }
+        sameAfter = SameWorld(&source, &target);
+    }
+
+    Report(roundTrip && checked > 0, "snapshot: save -> load -> save da' lo stesso buffer", name);
+    Report(sameAfter && checked > 0, "snapshot: il World ripristinato prosegue uguale", name);
+
+    free(second);
+    free(first);
+    SimDestroy(&target);
+    SimDestroy(&source);
+}
+
+// === LABIRINTI MALFORMATI ===
+typedef struct {
+    const char *what;
+    const char *text;
+    bool valid;
+} MazeCase;
+
+static void CheckMazeParser(void)
+{
+    // Le righe corte sono completate con muri (vedi map.h): ragged vuol dire
+    // righe piu' lunghe dell'intestazione o piu' righe di quelle dichiarate
+    static const MazeCase cases[] = {
+        {"labirinto valido", "5 3\n#####\n#P.1#\n#####\n", true},
+        {"righe corte completate con muri", "5 3\n#####\n#P.1\n###\n", true},
+        {"riga piu' lunga dell'intestazione", "5 3\n#####\n#P..1#\n#####\n", false},
+        {"righe in piu' rispetto all'intestazione", "5 3\n#####\n#P.1#\n#####\n#...#\n", false},
+        {"nessuna cella per la partenza di Pacman", "5 3\n#####\n#####\n#####\n", false},
+        {"due partenze di Pacman", "5 3\n#####\n#PP1#\n#####\n", false},
+        {"partenze dei fantasmi con un buco", "5 3\n#####\n#P.2#\n#####\n", false},
+        {"carattere sconosciuto", "5 3\n#####\n#P?1#\n#####\n", false},
+        {"colonne oltre MAP_MAX_SIZE", "4097 3\n#####\n#P.1#\n#####\n", false},
+        {"righe oltre MAP_MAX_SIZE", "5 4097\n#####\n#P.1#\n#####\n", false},
+        {"dimensioni enormi", "99999999999 99999999999\n#P#\n", false},
+        {"dimensioni a zero", "0 0\n", false},
+        {"intestazione mancante", "#####\n#P.1#\n#####\n", false},
+        {"file vuoto", "", false},
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        Maze maze;
+        bool parsed = MazeParse(&maze, cases[i].text, strlen(cases[i].text));
+        if (parsed)
+            MazeFree(&maze);
+        Report(parsed == cases[i].valid, cases[i].valid ? "MazeParse accetta" : "MazeParse rifiuta", cases[i].what);
+    }
+}
+
+int main(void)
+{
+    Maze classic, generated, large;
+    if (!MazeLoadFile(&classic, SIM_DEFAULT_MAZE))
+    {
+        fprintf(stderr, "Errore: labirinto non valido: %s\n", SIM_DEFAULT_MAZE);
+        return EXIT_FAILURE;
+    }
+    // Uno generato con la ricerca a incroci e uno abbastanza grande da usare il flow field gerarchico
+    if (!MazeGenerate(&generated, 63, 63, 1) || !MazeGenerate(&large, 600, 600, 1))
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per generare i labirinti\n");
+        return EXIT_FAILURE;
+    }
+
+    CheckMazeParser();
+
+    CheckReplay(&classic, "classic", NUM_GHOST, 1, SIM_SECONDS(600));
+    CheckReplay(&generated, "gen63", 256, 2, SIM_SECONDS(120));
+    CheckReplay(&large, "gen600", 64, 3, SIM_SECONDS(30));
+
+    CheckSnapshots(&classic, "classic", NUM_GHOST, 4, SIM_SECONDS(600));
+    CheckSnapshots(&generated, "gen63", 256, 5, SIM_SECONDS(120));
+    CheckSnapshots(&large, "gen600", 64, 6, SIM_SECONDS(30));
+
+    MazeFree(&large);
+    MazeFree(&generated);
+    MazeFree(&classic);
+
+    if (failures > 0)
+    {
+        printf("%d controlli falliti\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("tutti i controlli superati\n");
+    return EXIT_SUCCESS;
+}
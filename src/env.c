@@ -0,0 +1,371 @@
+// === AMBIENTE VETTORIALE PER IL REINFORCEMENT LEARNING ===
+#include "lib/env.h"
+#include "lib/batch.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Frecce premute per ogni EnvAction
+static const SimInput actionInputs[ENV_NUM_ACTIONS] = {
+    0, SIM_INPUT_RIGHT, SIM_INPUT_LEFT, SIM_INPUT_UP, SIM_INPUT_DOWN
+};
+
+// === OSSERVAZIONI ===
+
+void EnvObserve(const PacmanEnv *env, const World *w, unsigned char *obs)
+{
+    const MapBits *map = &w->map;
+    size_t planeSize = env->planeSize;
+    unsigned char *dots = obs + ENV_PLANE_DOTS * planeSize;
+    unsigned char *ghosts = obs + ENV_PLANE_GHOSTS * planeSize;
+    unsigned char *powerups = obs + ENV_PLANE_POWERUPS * planeSize;
+    unsigned char *pacman = obs + ENV_PLANE_PACMAN * planeSize;
+
+    memcpy(obs + ENV_PLANE_WALLS * planeSize, env->wallPlane, planeSize);
+    memset(dots, 0, (ENV_NUM_PLANES - ENV_PLANE_DOTS) * planeSize);
+
+    // Puntini: solo i bit accesi della bitboard
+    for (int row = 0; row < map->rows; row++)
+    {
+        for (int word = 0; word < map->words; word++)
+        {
+            MapWord bits = map->dots[row * map->words + word];
+            while (bits)
+            {
+                int col = word * 64 + __builtin_ctzll(bits);
+                dots[MapCell(map, row, col)] = 1;
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    const int *ghostCell = w->ghosts.cell;
+    for (int i = 0; i < w->ghosts.count; i++)
+    {
+        unsigned char *count = &ghosts[ghostCell[i]];
+        if (*count < ENV_MAX_COUNT)
+            (*count)++;
+    }
+
+    for (int i = 0; i < MAX_POWERUPS; i++)
+    {
+        const PowerUp *p = &w->powerups[i];
+        if (p->isActive)
+            powerups[GridCellOfPoint(map, p->pos.x, p->pos.y)] = (unsigned char)p->type;
+    }
+
+    pacman[w->pacmanCell] = 1;
+}
+
+// Cella del power-up i di w, GRID_NONE se non e' sulla mappa
+static int PowerUpCell(const World *w, int i)
+{
+    const PowerUp *p = &w->powerups[i];
+    return p->isActive ? GridCellOfPoint(&w->map, p->pos.x, p->pos.y) : GRID_NONE;
+}
+
+// Ricorda cosa mostra l'osservazione appena scritta da EnvObserve
+static void RememberObservation(EnvSlot *slot)
+{
+    const World *w = &slot->world;
+    memcpy(slot->shownDots, w->map.dots, sizeof(MapWord) * (size_t)w->map.rows * (size_t)w->map.words);
+    memcpy(slot->shownGhosts, w->ghosts.cell, sizeof(int) * (size_t)w->ghosts.count);
+    for (int i = 0; i < MAX_POWERUPS; i++)
+        slot->shownPowerups[i] = PowerUpCell(w, i);
+    slot->shownPacman = w->pacmanCell;
+}
+
+void EnvUpdateObservation(PacmanEnv *env, int index, unsigned char *obs)
+{
+    EnvSlot *slot = &env->slots[index];
+    const World *w = &slot->world;
+    const MapBits *map = &w->map;
+    size_t planeSize = env->planeSize;
+    unsigned char *dots = obs + ENV_PLANE_DOTS * planeSize;
+    unsigned char *ghosts = obs + ENV_PLANE_GHOSTS * planeSize;
+    unsigned char *powerups = obs + ENV_PLANE_POWERUPS * planeSize;
+    unsigned char *pacman = obs + ENV_PLANE_PACMAN * planeSize;
+
+    // Puntini: solo i bit cambiati (mangiati, o tutti di nuovo a inizio livello o episodio)
+    int numWords = map->rows * map->words;
+    for (int word = 0; word < numWords; word++)
+    {
+        MapWord now = map->dots[word];
+        MapWord changed = now ^ slot->shownDots[word];
+        if (!changed)
+            continue;
+        slot->shownDots[word] = now;
+        int row = word / map->words;
+        int firstCol = (word % map->words) * 64;
+        for (; changed; changed &= changed - 1)
+        {
+            int bit = __builtin_ctzll(changed);
+            dots[MapCell(map, row, firstCol + bit)] = (unsigned char)((now >> bit) & 1ull);
+        }
+    }
+
+    // Fantasmi: via dalle celle di prima, poi si ricontano in quelle di adesso
+    int *shown = slot->shownGhosts;
+    const int *ghostCell = w->ghosts.cell;
+    for (int i = 0; i < w->ghosts.count; i++)
+        ghosts[shown[i]] = 0;
+    for (int i = 0; i < w->ghosts.count; i++)
+    {
+        unsigned char *count = &ghosts[ghostCell[i]];
+        if (*count < ENV_MAX_COUNT)
+            (*count)++;
+        shown[i] = ghostCell[i];
+    }
+
+    for (int i = 0; i < MAX_POWERUPS; i++)
+    {
+        if (slot->shownPowerups[i] != GRID_NONE)
+            powerups[slot->shownPowerups[i]] = 0;
+    }
+    for (int i = 0; i < MAX_POWERUPS; i++)
+    {
+        int cell = PowerUpCell(w, i);
+        if (cell != GRID_NONE)
+            powerups[cell] = (unsigned char)w->powerups[i].type;
+        slot->shownPowerups[i] = cell;
+    }
+
+    pacman[slot->shownPacman] = 0;
+    pacman[w->pacmanCell] = 1;
+    slot->shownPacman = w->pacmanCell;
+}
+
+// === PASSO DI UN BLOCCO DI PARTITE ===
+
+static void StartEpisode(PacmanEnv *env, int index)
+{
+    EnvSlot *slot = &env->slots[index];
+    long long id = (long long)slot->episode * ENV_MAX_ENVS + index;
+    SimInit(&slot->world, BatchGameSeed(env->config.baseSeed, id));
+}
+
+static void RunRange(PacmanEnv *env, const EnvJob *job, int begin, int end)
+{
+    size_t obsSize = EnvObservationSize(env);
+    for (int i = begin; i < end; i++)
+    {
+        EnvSlot *slot = &env->slots[i];
+        World *w = &slot->world;
+        if (job->reset)
+        {
+            slot->episode = 0;
+            StartEpisode(env, i);
+            EnvObserve(env, w, job->obs + obsSize * (size_t)i);
+            RememberObservation(slot);
+            continue;
+        }
+
+        int action = job->actions[i];
+        SimInput input = action > 0 && action < ENV_NUM_ACTIONS ? actionInputs[action] : 0;
+        int score = w->score;
+        for (int k = 0; k < env->config.ticksPerStep && !w->gameOver; k++)
+            SimStep(w, input);
+        if (job->rewards)
+            job->rewards[i] = (float)(w->score - score);
+
+        bool done = w->gameOver || (env->config.maxTicks > 0 && w->tick >= env->config.maxTicks);
+        if (done)
+        {
+            slot->lastScore = w->score;
+            slot->lastTicks = w->tick;
+            slot->episode++;
+            StartEpisode(env, i);
+        }
+        if (job->dones)
+            job->dones[i] = done;
+        EnvUpdateObservation(env, i, job->obs + obsSize * (size_t)i);
+    }
+}
+
+// === THREAD ===
+
+static void *EnvWorkerMain(void *arg)
+{
+    PacmanEnv *env = (PacmanEnv *)arg;
+    unsigned int seen = 0;
+    pthread_mutex_lock(&env->lock);
+    int t = ++env->done;   // Indice del thread: i worker partono uno alla volta sotto lock
+    pthread_cond_signal(&env->finished);
+    for (;;)
+    {
+        while (env->generation == seen && !env->stop)
+            pthread_cond_wait(&env->wake, &env->lock);
+        if (env->stop)
+            break;
+        seen = env->generation;
+        EnvJob job = env->job;
+        pthread_mutex_unlock(&env->lock);
+
+        RunRange(env, &job, env->firstEnv[t], env->firstEnv[t + 1]);
+
+        pthread_mutex_lock(&env->lock);
+        env->done++;
+        pthread_cond_signal(&env->finished);
+    }
+    pthread_mutex_unlock(&env->lock);
+    return NULL;
+}
+
+// Esegue job su tutte le partite: il chiamante fa il blocco 0, i worker gli altri
+static void RunJob(PacmanEnv *env, const EnvJob *job)
+{
+    if (env->numWorkers == 0)
+    {
+        RunRange(env, job, 0, env->config.numEnvs);
+        return;
+    }
+
+    pthread_mutex_lock(&env->lock);
+    env->job = *job;
+    env->done = 0;
+    env->generation++;
+    pthread_cond_broadcast(&env->wake);
+    pthread_mutex_unlock(&env->lock);
+
+    RunRange(env, job, env->firstEnv[0], env->firstEnv[1]);
+
+    pthread_mutex_lock(&env->lock);
+    while (env->done < env->numWorkers)
+        pthread_cond_wait(&env->finished, &env->lock);
+    pthread_mutex_unlock(&env->lock);
+}
+
+// === API ===
+
+bool EnvCreate(PacmanEnv *env, const EnvConfig *config)
+{
+    memset(env, 0, sizeof(*env));
+    env->config = *config;
+    EnvConfig *c = &env->config;
+    if (c->numGhosts == 0)
+        c->numGhosts = NUM_GHOST;
+    if (c->numThreads == 0)
+        c->numThreads = 1;
+    if (c->ticksPerStep == 0)
+        c->ticksPerStep = 1;
+    if (!c->maze || c->numEnvs < 1 || c->numEnvs > ENV_MAX_ENVS || c->numThreads < 1 ||
+        c->numThreads > ENV_MAX_THREADS || c->ticksPerStep < 1 || c->maxTicks < 0)
+        return false;
+
+    const Maze *maze = c->maze;
+    env->rows = maze->rows;
+    env->cols = maze->cols;
+    env->planeSize = (size_t)maze->rows * (size_t)maze->cols;
+    size_t dotWords = (size_t)maze->rows * (size_t)maze->words;
+    env->wallPlane = malloc(env->planeSize);
+    env->slots = calloc((size_t)c->numEnvs, sizeof(EnvSlot));
+    env->shownDots = malloc(sizeof(MapWord) * dotWords * (size_t)c->numEnvs);
+    env->shownGhosts = malloc(sizeof(int) * (size_t)c->numGhosts * (size_t)c->numEnvs);
+    if (!env->wallPlane || !env->slots || !env->shownDots || !env->shownGhosts)
+    {
+        EnvDestroy(env);
+        return false;
+    }
+    for (int row = 0; row < maze->rows; row++)
+    {
+        for (int col = 0; col < maze->cols; col++)
+            env->wallPlane[row * maze->cols + col] = (maze->walls[row * maze->words + (col >> 6)] >> (col & 63)) & 1ull;
+    }
+    for (int i = 0; i < c->numEnvs; i++)
+    {
+        env->slots[i].shownDots = env->shownDots + dotWords * (size_t)i;
+        env->slots[i].shownGhosts = env->shownGhosts + (size_t)c->numGhosts * (size_t)i;
+        if (!SimCreate(&env->slots[i].world, maze, c->numGhosts))
+        {
+            memset(&env->slots[i].world, 0, sizeof(World));   // Gia' liberato da SimCreate
+            EnvDestroy(env);
+            return false;
+        }
+    }
+
+    // Blocchi contigui, al piu' un thread per partita
+    int numThreads = c->numThreads < c->numEnvs ? c->numThreads : c->numEnvs;
+    env->threads = malloc(sizeof(pthread_t) * (size_t)numThreads);
+    env->firstEnv = malloc(sizeof(int) * (size_t)(numThreads + 1));
+    if (!env->threads || !env->firstEnv)
+    {
+        EnvDestroy(env);
+        return false;
+    }
+    for (int t = 0; t <= numThreads; t++)
+        env->firstEnv[t] = (int)((long long)c->numEnvs * t / numThreads);
+    env->numThreads = numThreads;
+
+    pthread_mutex_init(&env->lock, NULL);
+    pthread_cond_init(&env->wake, NULL);
+    pthread_cond_init(&env->finished, NULL);
+    env->threadsReady = true;
+    for (int t = 1; t < numThreads; t++)
+    {
+        if (pthread_create(&env->threads[t - 1], NULL, EnvWorkerMain, env) != 0)
+        {
+            EnvDestroy(env);
+            return false;
+        }
+        env->numWorkers++;
+    }
+
+    // Ogni worker ha preso il suo indice prima del primo passo
+    pthread_mutex_lock(&env->lock);
+    while (env->done < env->numWorkers)
+        pthread_cond_wait(&env->finished, &env->lock);
+    pthread_mutex_unlock(&env->lock);
+    return true;
+}
+
+void EnvDestroy(PacmanEnv *env)
+{
+    if (env->threadsReady)
+    {
+        pthread_mutex_lock(&env->lock);
+        env->stop = true;
+        pthread_cond_broadcast(&env->wake);
+        pthread_mutex_unlock(&env->lock);
+        for (int i = 0; i < env->numWorkers; i++)
+            pthread_join(env->threads[i], NULL);
+        pthread_cond_destroy(&env->finished);
+        pthread_cond_destroy(&env->wake);
+        pthread_mutex_destroy(&env->lock);
+    }
+    for (int i = 0; env->slots && i < env->config.numEnvs; i++)
+    {
+        if (env->slots[i].world.maze)
+            SimDestroy(&env->slots[i].world);
+    }
+    free(env->slots);
+    free(env->wallPlane);
+    free(env->shownDots);
+    free(env->shownGhosts);
+    free(env->threads);
+    free(env->firstEnv);
+    memset(env, 0, sizeof(*env));
+}
+
+size_t EnvObservationSize(const PacmanEnv *env)
+{
+    return ENV_NUM_PLANES * env->planeSize;
+}
+
+void EnvReset(PacmanEnv *env, unsigned char *obs)
+{
+    EnvJob job = {.obs = obs, .reset = true};
+    RunJob(env, &job);
+    env->steps = 0;
+    env->episodes = 0;
+}
+
+void EnvStep(PacmanEnv *env, const int *actions, unsigned char *obs, float *rewards, unsigned char *dones)
+{
+    EnvJob job = {.actions = actions, .obs = obs, .rewards = rewards, .dones = dones};
+    RunJob(env, &job);
+
+    long long episodes = 0;
+    for (int i = 0; i < env->config.numEnvs; i++)
+        episodes += env->slots[i].episode;
+    env->steps += env->config.numEnvs;
+    env->episodes = episodes;
+}
@@ -0,0 +1,143 @@
+// === FLOW FIELD VERSO PACMAN (BFS) ===
+#include "lib/flowfield.h"
+#include "lib/hpa.h"
+#include <stdlib.h>
+#include <string.h>
+
+const Vector2 flowDirections[4] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+// Direzione opposta: chi arriva nella cella v da u con direzione d deve fare
+// il passo opposto per tornare verso u (cioe' verso Pacman)
+static const unsigned char flowOpposite[4] = {FLOW_LEFT, FLOW_RIGHT, FLOW_UP, FLOW_DOWN};
+
+size_t FlowFieldMemorySize(int rows, int cols)
+{
+    size_t numCells = (size_t)rows * (size_t)cols;
+    if (numCells >= HPA_MIN_CELLS)
+        return ArenaSize(numCells);   // Solo flowDir: distanze e coda sono del planner, per cluster
+    return 2 * ArenaSize(sizeof(unsigned int) * numCells) + ArenaSize(numCells);
+}
+
+bool AllocFlowField(World *w)
+{
+    size_t numCells = (size_t)w->map.rows * (size_t)w->map.cols;
+
+    // flowDir finisce su una cache line: il kernel AVX2 puo' leggerlo a parole allineate
+    w->flowDir = ArenaAlloc(&w->arena, numCells);
+    if (!w->flowDir)
+        return false;
+
+    // Labirinti piccoli: BFS completa, con distanze e coda lunghe quanto la mappa
+    if (numCells < HPA_MIN_CELLS)
+    {
+        w->flowDist = ArenaAlloc(&w->arena, sizeof(unsigned int) * numCells);
+        w->flowQueue = ArenaAlloc(&w->arena, sizeof(int) * numCells);
+        if (!w->flowDist || !w->flowQueue)
+            return false;
+    }
+    else
+    {
+        // Labirinti grandi: campo calcolato a pezzi, solo dove ci sono fantasmi
+        w->hpa = malloc(sizeof(HpaPlanner));
+        if (!w->hpa || !InitHpaPlanner(w->hpa, &w->map))
+        {
+            FreeFlowField(w);
+            return false;
+        }
+        memset(w->flowDir, FLOW_NONE, numCells);
+    }
+    InvalidateFlowField(w);
+    return true;
+}
+
+void FreeFlowField(World *w)
+{
+    if (w->hpa)
+        FreeHpaPlanner(w->hpa);
+    free(w->hpa);
+    w->hpa = NULL;
+    w->flowDist = NULL;
+    w->flowDir = NULL;
+    w->flowQueue = NULL;
+}
+
+void InvalidateFlowField(World *w)
+{
+    w->flowRow = -1;
+    w->flowCol = -1;
+}
+
+// BFS dalla cella (row, col): riempie flowDist e flowDir di tutto il labirinto
+static void ComputeFlowField(World *w, int row, int col)
+{
+    static const int dRow[4] = {0, 0, 1, -1};
+    static const int dCol[4] = {1, -1, 0, 0};
+    const MapBits *map = &w->map;
+    int cols = map->cols;
+    int *queue = w->flowQueue;
+    int head = 0, tail = 0;
+
+    // Tutti i byte a 0xFF: FLOW_UNREACHABLE e FLOW_NONE
+    memset(w->flowDist, 0xFF, sizeof(unsigned int) * (size_t)map->rows * (size_t)cols);
+    memset(w->flowDir, FLOW_NONE, (size_t)map->rows * (size_t)cols);
+
+    w->flowRow = row;
+    w->flowCol = col;
+    if (MapIsWall(map, row, col))
+        return;
+
+    // In coda riga e colonna impacchettate (row << 16 | col): niente divisioni per cols
+    w->flowDist[MapCell(map, row, col)] = 0;
+    queue[tail++] = (row << 16) | col;
+
+    while (head < tail)
+    {
+        int r = queue[head] >> 16;
+        int c = queue[head++] & 0xFFFF;
+        int cell = r * cols + c;
+        unsigned int nextDist = w->flowDist[cell] + 1;
+
+        for (int d = 0; d < 4; d++)
+        {
+            int nr = r + dRow[d];
+            int nc = c + dCol[d];
+            int next = cell + dRow[d] * cols + dCol[d];
+            if (MapIsWall(map, nr, nc) || w->flowDist[next] != FLOW_UNREACHABLE)
+                continue;
+
+            w->flowDist[next] = nextDist;
+            w->flowDir[next] = flowOpposite[d];
+            queue[tail++] = (nr << 16) | nc;
+        }
+    }
+}
+
+void UpdateFlowField(World *w)
+{
+    int row = (int)(w->pacmanPos.y) / TILE_SIZE;
+    int col = (int)(w->pacmanPos.x) / TILE_SIZE;
+
+    // Pacman e' ancora nella stessa cella: il campo e' gia' valido
+    if (!w->hpa)
+    {
+        if (row != w->flowRow || col != w->flowCol)
+            ComputeFlowField(w, row, col);
+        return;
+    }
+
+    // Con la gerarchia il campo si completa dove i fantasmi sono entrati in cluster nuovi
+    if (row != w->flowRow || col != w->flowCol)
+    {
+        HpaSetTarget(w->hpa, &w->map, row, col);
+        w->flowRow = row;
+        w->flowCol = col;
+    }
+    HpaUpdateGhostCells(w->hpa, &w->map, &w->ghosts, w->flowDir);
+}
+
+unsigned char GetFlowDirection(const World *w, int row, int col)
+{
+    if (!MapInBounds(&w->map, row, col))
+        return FLOW_NONE;
+    return w->flowDir[MapCell(&w->map, row, col)];
+}
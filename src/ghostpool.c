@@ -0,0 +1,197 @@
+// === POOL DI THREAD PER I FANTASMI ===
+#include "lib/ghostpool.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Nel gioco i blocchi di ogni worker compaiono nella traccia (vedi trace.h)
+#if defined(SIM_PROFILING)
+#include "lib/trace.h"
+#define POOL_TRACE(call) do { if (TraceEnabled()) call; } while (0)
+#else
+#define POOL_TRACE(call) ((void)0)
+#endif
+
+static inline void CpuRelax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static unsigned long long PackCursor(unsigned int generation, int numChunks, int next)
+{
+    return ((unsigned long long)generation << 32) | ((unsigned long long)numChunks << 16) | (unsigned long long)next;
+}
+
+// Prende il prossimo blocco della generazione indicata; false se i blocchi
+// sono finiti o il chiamante e' gia' passato a un altro lavoro
+static bool TakeChunk(GhostPool *pool, unsigned int generation, int *chunk)
+{
+    unsigned long long old = __atomic_load_n(&pool->cursor, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        int numChunks = (int)((old >> 16) & 0xFFFF);
+        int next = (int)(old & 0xFFFF);
+        if ((unsigned int)(old >> 32) != generation || next >= numChunks)
+            return false;
+        if (__atomic_compare_exchange_n(&pool->cursor, &old, old + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *chunk = next;
+            return true;
+        }
+    }
+}
+
+// Muove i fantasmi dei blocchi che riesce a prendere. Il lavoro pubblicato si legge
+// solo dopo aver preso un blocco: finche' quel blocco non e' finito il chiamante non
+// puo' pubblicarne un altro
+static void RunChunks(GhostPool *pool, unsigned int generation)
+{
+    int chunk;
+    while (TakeChunk(pool, generation, &chunk))
+    {
+        int begin = chunk * pool->chunkSize;
+        int end = begin + pool->chunkSize;
+        if (end > pool->swarm->count)
+            end = pool->swarm->count;
+        StepGhostRange(pool->swarm, &pool->params, begin, end);
+        __atomic_add_fetch(&pool->done, 1, __ATOMIC_RELEASE);
+    }
+}
+
+// Aspetta un lavoro di generazione diversa da seen (prima in attesa attiva, poi
+// sulla condition variable); ritorna false quando il pool si ferma
+static bool WaitForWork(GhostPool *pool, unsigned int seen, unsigned int *generation)
+{
+    for (int spin = 0; spin < GHOST_POOL_SPIN; spin++)
+    {
+        if (__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE))
+            return false;
+        unsigned int current = (unsigned int)(__atomic_load_n(&pool->cursor, __ATOMIC_ACQUIRE) >> 32);
+        if (current != seen)
+        {
+            *generation = current;
+            return true;
+        }
+        CpuRelax();
+    }
+
+    // sleepers e cursor in ordine sequenziale (anche in GhostPoolStep): o il
+    // chiamante vede il worker addormentato e lo sveglia, o il worker vede il lavoro
+    pthread_mutex_lock(&pool->lock);
+    __atomic_add_fetch(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+    unsigned int current;
+    while ((current = (unsigned int)(__atomic_load_n(&pool->cursor, __ATOMIC_SEQ_CST) >> 32)) == seen &&
+           !__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE))
+        pthread_cond_wait(&pool->wake, &pool->lock);
+    __atomic_sub_fetch(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+    bool stop = __atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE);
+    pthread_mutex_unlock(&pool->lock);
+
+    *generation = current;
+    return !stop;
+}
+
+static void *GhostWorkerMain(void *arg)
+{
+    GhostPool *pool = (GhostPool *)arg;
+    POOL_TRACE(TraceThreadName("ghost_worker"));
+
+    unsigned int seen = 0;
+    unsigned int generation;
+    while (WaitForWork(pool, seen, &generation))
+    {
+        POOL_TRACE(TraceBegin("ghost_chunks"));
+        RunChunks(pool, generation);
+        POOL_TRACE(TraceEnd("ghost_chunks"));
+        seen = generation;
+    }
+    return NULL;
+}
+
+bool InitGhostPool(GhostPool *pool, int numThreads)
+{
+    memset(pool, 0, sizeof(*pool));
+    if (numThreads < 1 || numThreads > GHOST_POOL_MAX_THREADS)
+        return false;
+    pool->numThreads = 1;
+    if (numThreads == 1)
+        return true;
+
+    pool->threads = malloc(sizeof(pthread_t) * (size_t)(numThreads - 1));
+    if (!pool->threads)
+        return false;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    for (int i = 0; i < numThreads - 1; i++)
+    {
+        if (pthread_create(&pool->threads[i], NULL, GhostWorkerMain, pool) != 0)
+        {
+            FreeGhostPool(pool);
+            return false;
+        }
+        pool->numWorkers++;
+        pool->numThreads++;
+    }
+    return true;
+}
+
+void FreeGhostPool(GhostPool *pool)
+{
+    if (pool->threads)
+    {
+        pthread_mutex_lock(&pool->lock);
+        __atomic_store_n(&pool->stop, true, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+        for (int i = 0; i < pool->numWorkers; i++)
+            pthread_join(pool->threads[i], NULL);
+        pthread_cond_destroy(&pool->wake);
+        pthread_mutex_destroy(&pool->lock);
+        free(pool->threads);
+    }
+    memset(pool, 0, sizeof(*pool));
+}
+
+void GhostPoolStep(GhostPool *pool, GhostSwarm *swarm, const GhostStepParams *params)
+{
+    int count = swarm->count;
+    if (!pool || pool->numThreads < 2 || count < GHOST_POOL_MIN_GHOSTS)
+    {
+        StepGhostRange(swarm, params, 0, count);
+        return;
+    }
+
+    // Blocchi di almeno GHOST_POOL_CHUNK_ALIGN fantasmi, allineati come gli array
+    int wanted = pool->numThreads * GHOST_POOL_CHUNKS_PER_THREAD;
+    int chunkSize = (count + wanted - 1) / wanted;
+    chunkSize = (chunkSize + GHOST_POOL_CHUNK_ALIGN - 1) / GHOST_POOL_CHUNK_ALIGN * GHOST_POOL_CHUNK_ALIGN;
+    int numChunks = (count + chunkSize - 1) / chunkSize;
+
+    // Nessun worker tocca questi campi: tutti i blocchi del lavoro precedente sono finiti
+    pool->swarm = swarm;
+    pool->params = *params;
+    pool->chunkSize = chunkSize;
+    __atomic_store_n(&pool->done, 0, __ATOMIC_RELAXED);
+    unsigned int generation = ++pool->generation;
+    if (generation == 0)
+        generation = ++pool->generation;   // 0 e' la generazione che i worker hanno "gia' visto" all'avvio
+    __atomic_store_n(&pool->cursor, PackCursor(generation, numChunks, 0), __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pool->sleepers, __ATOMIC_SEQ_CST) > 0)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    // Anche il chiamante lavora, poi aspetta i blocchi ancora in mano ai worker
+    RunChunks(pool, generation);
+    for (int spin = 0; __atomic_load_n(&pool->done, __ATOMIC_ACQUIRE) < numChunks; spin++)
+    {
+        if (spin < GHOST_POOL_SPIN)
+            CpuRelax();
+        else
+            sched_yield();   // Piu' thread che core: lascia finire il worker che ha il blocco
+    }
+}
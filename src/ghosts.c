@@ -0,0 +1,272 @@
+// === SCIAME DI FANTASMI ===
+#include "lib/ghosts.h"
+#include "lib/flowfield.h"
+#include <stdint.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GHOSTS_X86 1
+#else
+#define GHOSTS_X86 0
+#endif
+
+#define GHOST_LANES 8    // Le capacita' sono multipli di 8 fantasmi (gli array sono allineati dall'arena)
+
+// Numero di array nel blocco: offset, nextEvent, speed (float) ed edge, cell, target, startCell (int)
+#define GHOST_ARRAYS 7
+
+// Elementi per array: capacity arrotondata alle corsie del kernel piu' largo
+static size_t GhostStride(int capacity)
+{
+    int stride = (capacity + GHOST_LANES - 1) / GHOST_LANES * GHOST_LANES;
+    return (size_t)(stride > 0 ? stride : GHOST_LANES);
+}
+
+size_t GhostSwarmMemorySize(int capacity)
+{
+    return ArenaSize(sizeof(float) * GhostStride(capacity) * GHOST_ARRAYS);
+}
+
+bool AllocGhostSwarm(GhostSwarm *swarm, int capacity, Arena *arena)
+{
+    memset(swarm, 0, sizeof(*swarm));
+    if (capacity < 0)
+        return false;
+
+    // Un blocco unico per tutti gli array
+    size_t stride = GhostStride(capacity);
+    float *f = ArenaAlloc(arena, sizeof(float) * stride * GHOST_ARRAYS);
+    if (!f)
+        return false;
+    memset(f, 0, sizeof(float) * stride * GHOST_ARRAYS);
+
+    swarm->offset = f + 0 * stride;
+    swarm->nextEvent = f + 1 * stride;
+    swarm->speed = f + 2 * stride;
+    swarm->edge = (int *)(f + 3 * stride);
+    swarm->cell = (int *)(f + 4 * stride);
+    swarm->target = (int *)(f + 5 * stride);
+    swarm->startCell = (int *)(f + 6 * stride);
+    swarm->capacity = capacity;
+    swarm->count = capacity;
+    return true;
+}
+
+// === EVENTI (PERCORSO LENTO, COMUNE A TUTTI I KERNEL) ===
+
+static const unsigned char ghostOpposite[4] = {FLOW_LEFT, FLOW_RIGHT, FLOW_UP, FLOW_DOWN};
+
+// Arco scelto su un nodo da chi ci arriva andando in direzione arriving: il primo
+// passo verso Pacman; senza flow field dritto, poi la prima svolta, poi indietro
+static int ChooseEdge(const JunctionNode *node, int arriving, const unsigned char *flowDir)
+{
+    unsigned char flow = flowDir[node->cell];
+    if (flow != FLOW_NONE && node->edges[flow] != JUNCTION_NONE)
+        return node->edges[flow];
+    if (node->edges[arriving] != JUNCTION_NONE)
+        return node->edges[arriving];
+    for (int d = 0; d < 4; d++)
+    {
+        if (d != ghostOpposite[arriving] && node->edges[d] != JUNCTION_NONE)
+            return node->edges[d];
+    }
+    return node->edges[ghostOpposite[arriving]];   // Vicolo cieco: c'e' sempre l'arco da cui e' arrivato
+}
+
+// Il fantasma i ha superato nextEvent: attraversa i confini di cella e i nodi
+// che il passo di questo tick ha raggiunto
+static void GhostEvents(GhostSwarm *s, const GhostStepParams *p, int i)
+{
+    const JunctionGraph *graph = p->graph;
+    float offset = s->offset[i];
+    float next = s->nextEvent[i];
+    int edge = s->edge[i];
+    int cell = s->cell[i];
+
+    while (offset >= next)
+    {
+        const JunctionEdge *e = &graph->edges[edge];
+        float end = (float)(e->length * TILE_SIZE);
+        if (next < end)
+        {
+            // A meta' strada tra due centri: entra nella cella successiva dell'arco
+            cell += graph->cellStep[e->dir];
+            next = next + TILE_SIZE < end ? next + TILE_SIZE : end;
+            continue;
+        }
+
+        // Sul nodo: sceglie l'arco successivo e ci continua con il resto del passo
+        const JunctionNode *node = &graph->nodes[e->toNode];
+        offset -= end;
+        edge = ChooseEdge(node, e->dir, p->flowDir);
+        cell = node->cell;
+        next = TILE_SIZE / 2.0f;
+        s->target[i] = graph->edges[edge].toCell;
+    }
+
+    s->offset[i] = offset;
+    s->nextEvent[i] = next;
+    s->edge[i] = edge;
+    s->cell[i] = cell;
+}
+
+// === KERNEL SCALARE ===
+// Riferimento per gli altri kernel: stesse operazioni, stesso ordine
+static void StepGhostRangeScalar(GhostSwarm *s, const GhostStepParams *p, int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        float step = s->speed[i] * p->speedMultiplier;
+        s->offset[i] = s->offset[i] + step;
+        if (s->offset[i] >= s->nextEvent[i])
+            GhostEvents(s, p, i);
+    }
+}
+
+#if GHOSTS_X86
+
+// === KERNEL SSE4.1 (4 fantasmi per istruzione) ===
+// Passo e confronto vettoriali; gli eventi passano al percorso scalare
+__attribute__((target("sse4.1")))
+static void StepGhostRangeSse41(GhostSwarm *s, const GhostStepParams *p, int begin, int end)
+{
+    const __m128 mult = _mm_set1_ps(p->speedMultiplier);
+
+    int i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 step = _mm_mul_ps(_mm_loadu_ps(s->speed + i), mult);
+        __m128 offset = _mm_add_ps(_mm_loadu_ps(s->offset + i), step);
+        _mm_storeu_ps(s->offset + i, offset);
+
+        int events = _mm_movemask_ps(_mm_cmpge_ps(offset, _mm_loadu_ps(s->nextEvent + i)));
+        for (; events; events &= events - 1)
+            GhostEvents(s, p, i + __builtin_ctz((unsigned int)events));
+    }
+
+    StepGhostRangeScalar(s, p, i, end);
+}
+
+// === KERNEL AVX2 (8 fantasmi per istruzione) ===
+__attribute__((target("avx2")))
+static void StepGhostRangeAvx2(GhostSwarm *s, const GhostStepParams *p, int begin, int end)
+{
+    const __m256 mult = _mm256_set1_ps(p->speedMultiplier);
+
+    int i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 step = _mm256_mul_ps(_mm256_loadu_ps(s->speed + i), mult);
+        __m256 offset = _mm256_add_ps(_mm256_loadu_ps(s->offset + i), step);
+        _mm256_storeu_ps(s->offset + i, offset);
+
+        // La maggior parte dei tick nessuna corsia ha eventi; il percorso lento e'
+        // codice SSE, quindi prima si puliscono le meta' alte dei registri AVX
+        int events = _mm256_movemask_ps(_mm256_cmp_ps(offset, _mm256_loadu_ps(s->nextEvent + i), _CMP_GE_OQ));
+        if (events)
+            _mm256_zeroupper();
+        for (; events; events &= events - 1)
+            GhostEvents(s, p, i + __builtin_ctz((unsigned int)events));
+    }
+
+    StepGhostRangeScalar(s, p, i, end);
+}
+
+#endif // GHOSTS_X86
+
+// === SCELTA DEL KERNEL ===
+
+static GhostKernel activeKernel = GHOST_KERNEL_AUTO;   // Risolto una volta sola (kernelOnce)
+static pthread_once_t kernelOnce = PTHREAD_ONCE_INIT;
+
+static bool IsKernelSupported(GhostKernel kernel)
+{
+    switch (kernel)
+    {
+        case GHOST_KERNEL_SCALAR:
+            return true;
+#if GHOSTS_X86
+        case GHOST_KERNEL_SSE41:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse4.1");
+        case GHOST_KERNEL_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+static GhostKernel BestKernel(void)
+{
+    if (IsKernelSupported(GHOST_KERNEL_AVX2))
+        return GHOST_KERNEL_AVX2;
+    if (IsKernelSupported(GHOST_KERNEL_SSE41))
+        return GHOST_KERNEL_SSE41;
+    return GHOST_KERNEL_SCALAR;
+}
+
+// Kernel di default, scelto al primo uso da qualunque thread: StepGhostRange
+// gira su piu' thread insieme (pool, batch, autopilota), pthread_once evita la gara
+static void ResolveGhostKernel(void)
+{
+    if (activeKernel == GHOST_KERNEL_AUTO)
+        activeKernel = BestKernel();
+}
+
+bool SetGhostKernel(GhostKernel kernel)
+{
+    pthread_once(&kernelOnce, ResolveGhostKernel);
+    if (kernel == GHOST_KERNEL_AUTO)
+        kernel = BestKernel();
+    if (!IsKernelSupported(kernel))
+        return false;
+    activeKernel = kernel;
+    return true;
+}
+
+GhostKernel GetGhostKernel(void)
+{
+    pthread_once(&kernelOnce, ResolveGhostKernel);
+    return activeKernel;
+}
+
+const char *GetGhostKernelName(GhostKernel kernel)
+{
+    switch (kernel)
+    {
+        case GHOST_KERNEL_SCALAR: return "scalar";
+        case GHOST_KERNEL_SSE41:  return "sse4.1";
+        case GHOST_KERNEL_AVX2:   return "avx2";
+        default:                  return "auto";
+    }
+}
+
+void StepGhostRange(GhostSwarm *swarm, const GhostStepParams *params, int begin, int end)
+{
+    switch (GetGhostKernel())
+    {
+#if GHOSTS_X86
+        case GHOST_KERNEL_AVX2:
+            // Sotto le 8 corsie il kernel AVX2 farebbe solo la coda scalare, pagando
+            // in piu' il passaggio tra registri a 256 e 128 bit
+            if (end - begin >= 8)
+            {
+                StepGhostRangeAvx2(swarm, params, begin, end);
+                break;
+            }
+            StepGhostRangeSse41(swarm, params, begin, end);
+            break;
+        case GHOST_KERNEL_SSE41:
+            StepGhostRangeSse41(swarm, params, begin, end);
+            break;
+#endif
+        default:
+            StepGhostRangeScalar(swarm, params, begin, end);
+            break;
+    }
+}
@@ -0,0 +1,111 @@
+// === GRIGLIA UNIFORME DI OCCUPAZIONE ===
+#include "lib/grid.h"
+#include "lib/sim.h"
+#include <string.h>
+
+size_t SpatialGridMemorySize(int capacity, int rows, int cols)
+{
+    return ArenaSize(sizeof(int) * 3 * (size_t)capacity) + ArenaSize(sizeof(int) * (size_t)rows * (size_t)cols);
+}
+
+bool AllocSpatialGrid(SpatialGrid *grid, int capacity, int rows, int cols, Arena *arena)
+{
+    memset(grid, 0, sizeof(*grid));
+    if (capacity < 1 || rows < 1 || cols < 1)
+        return false;
+
+    // Un solo blocco per next, prev e cell
+    int *links = ArenaAlloc(arena, sizeof(int) * 3 * (size_t)capacity);
+    int *head = ArenaAlloc(arena, sizeof(int) * (size_t)rows * (size_t)cols);
+    if (!links || !head)
+        return false;
+
+    grid->next = links;
+    grid->prev = links + capacity;
+    grid->cell = links + 2 * capacity;
+    grid->head = head;
+    grid->capacity = capacity;
+    grid->rows = rows;
+    grid->cols = cols;
+
+    // Tutte le liste vuote: da qui in poi head si tiene in ordine oggetto per oggetto
+    for (int i = 0; i < rows * cols; i++)
+        grid->head[i] = GRID_NONE;
+    for (int id = 0; id < capacity; id++)
+        grid->cell[id] = GRID_NONE;
+    ClearSpatialGrid(grid);
+    return true;
+}
+
+void ClearSpatialGrid(SpatialGrid *grid)
+{
+    // Svuota solo le celle occupate: su una mappa grande le celle sono milioni
+    for (int id = 0; id < grid->capacity; id++)
+    {
+        if (grid->cell[id] != GRID_NONE)
+            grid->head[grid->cell[id]] = GRID_NONE;
+        grid->next[id] = GRID_NONE;
+        grid->prev[id] = GRID_NONE;
+        grid->cell[id] = GRID_NONE;
+    }
+}
+
+int GridCellOfPoint(const MapBits *map, float x, float y)
+{
+    int col = (int)x / TILE_SIZE;
+    int row = (int)y / TILE_SIZE;
+    if (x < 0.0f || y < 0.0f || !MapInBounds(map, row, col))
+        return GRID_NONE;
+    return MapCell(map, row, col);
+}
+
+void GridRelink(SpatialGrid *grid, int id, int cell)
+{
+    int old = grid->cell[id];
+
+    // Stacca l'oggetto dalla lista della vecchia cella
+    if (old != GRID_NONE)
+    {
+        int prev = grid->prev[id];
+        int next = grid->next[id];
+        if (prev != GRID_NONE)
+            grid->next[prev] = next;
+        else
+            grid->head[old] = next;
+        if (next != GRID_NONE)
+            grid->prev[next] = prev;
+    }
+
+    // Lo mette in testa alla lista della nuova
+    grid->cell[id] = cell;
+    grid->prev[id] = GRID_NONE;
+    grid->next[id] = GRID_NONE;
+    if (cell != GRID_NONE)
+    {
+        int first = grid->head[cell];
+        grid->next[id] = first;
+        if (first != GRID_NONE)
+            grid->prev[first] = id;
+        grid->head[cell] = id;
+    }
+}
+
+int GridQuery(const SpatialGrid *grid, int row, int col, int radius, int *out, int maxOut)
+{
+    int found = 0;
+    for (int r = row - radius; r <= row + radius; r++)
+    {
+        for (int c = col - radius; c <= col + radius; c++)
+        {
+            if (r < 0 || r >= grid->rows || c < 0 || c >= grid->cols)
+                continue;
+            for (int id = grid->head[r * grid->cols + c]; id != GRID_NONE; id = grid->next[id])
+            {
+                if (found == maxOut)
+                    return found;
+                out[found++] = id;
+            }
+        }
+    }
+    return found;
+}
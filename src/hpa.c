@@ -0,0 +1,781 @@
+// === PERCORSI GERARCHICI (HPA*) SUI LABIRINTI GRANDI ===
+#include "lib/hpa.h"
+#include "lib/flowfield.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HPA_INFINITE 0xFFFFFFFFu
+#define HPA_LOCAL_CELLS (HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE)
+#define HPA_MAX_CLUSTER_NODES (4 * HPA_CLUSTER_SIZE)  // Celle sul bordo di un cluster
+#define HPA_MAX_SEEDS (HPA_MAX_CLUSTER_NODES + 1)       // Transizioni del cluster piu' l'ancora
+#define HPA_NEAR_UNREACHED 0xFE                         // Cella del blocco che la BFS da Pacman non raggiunge
+
+static const int dRow[4] = {0, 0, 1, -1};
+static const int dCol[4] = {1, -1, 0, 0};
+static const unsigned char flowOpposite[4] = {FLOW_LEFT, FLOW_RIGHT, FLOW_UP, FLOW_DOWN};
+
+// Sorgente di una BFS locale: parte da offset invece che da 0, con la direzione gia' decisa
+typedef struct {
+    unsigned int offset;
+    int index;                  // Cella locale: riga << HPA_CLUSTER_SHIFT | colonna
+    unsigned char dir;
+} LocalSeed;
+
+// Due celle affacciate su cluster vicini (row << 16 | col)
+typedef struct {
+    int a, b;
+} Transition;
+
+static int PackPos(int row, int col)
+{
+    return (row << 16) | col;
+}
+
+static int ClusterOf(const HpaPlanner *hpa, int row, int col)
+{
+    return (row >> HPA_CLUSTER_SHIFT) * hpa->clusterCols + (col >> HPA_CLUSTER_SHIFT);
+}
+
+// === BFS DENTRO UN CLUSTER ===
+
+// Copia i muri del cluster k in localOpen e ne ritorna l'angolo e le dimensioni
+// (i cluster sul bordo destro e inferiore possono essere piu' piccoli)
+static void LoadCluster(HpaPlanner *hpa, const MapBits *map, int k, int *row0, int *col0, int *height, int *width)
+{
+    *row0 = (k / hpa->clusterCols) << HPA_CLUSTER_SHIFT;
+    *col0 = (k % hpa->clusterCols) << HPA_CLUSTER_SHIFT;
+    *height = hpa->rows - *row0 < HPA_CLUSTER_SIZE ? hpa->rows - *row0 : HPA_CLUSTER_SIZE;
+    *width = hpa->cols - *col0 < HPA_CLUSTER_SIZE ? hpa->cols - *col0 : HPA_CLUSTER_SIZE;
+
+    // col0 e' multiplo di HPA_CLUSTER_SIZE: i muri di una riga del cluster stanno in una sola parola
+    memset(hpa->localOpen, 0, HPA_LOCAL_CELLS);
+    for (int r = 0; r < *height; r++)
+    {
+        MapWord walls = map->walls[MapWordIndex(map, *row0 + r, *col0)] >> (*col0 & 63);
+        for (int c = 0; c < *width; c++)
+            hpa->localOpen[(r << HPA_CLUSTER_SHIFT) | c] = !((walls >> c) & 1ull);
+    }
+}
+
+static int LocalIndex(int pos, int row0, int col0)
+{
+    return (((pos >> 16) - row0) << HPA_CLUSTER_SHIFT) | ((pos & 0xFFFF) - col0);
+}
+
+// BFS nel cluster caricato da piu' sorgenti ordinate per offset. Le sorgenti e la coda
+// si fondono come due liste ordinate (a parita' vince la sorgente), quindi ogni cella
+// viene fissata una volta sola alla distanza minima, in un ordine che dipende solo dalle sorgenti
+static void LocalBfs(HpaPlanner *hpa, const LocalSeed *seeds, int numSeeds, int height, int width)
+{
+    unsigned int *dist = hpa->localDist;
+    unsigned char *dir = hpa->localDir;
+    int *queue = hpa->localQueue;
+    int head = 0, tail = 0, next = 0;
+
+    memset(dist, 0xFF, sizeof(unsigned int) * HPA_LOCAL_CELLS);
+    while (next < numSeeds || head < tail)
+    {
+        int index;
+        if (next < numSeeds && (head == tail || seeds[next].offset <= dist[queue[head]]))
+        {
+            const LocalSeed *seed = &seeds[next++];
+            if (!hpa->localOpen[seed->index] || dist[seed->index] <= seed->offset)
+                continue;
+            index = seed->index;
+            dist[index] = seed->offset;
+            dir[index] = seed->dir;
+        }
+        else
+        {
+            index = queue[head++];
+        }
+
+        int r = index >> HPA_CLUSTER_SHIFT;
+        int c = index & (HPA_CLUSTER_SIZE - 1);
+        for (int d = 0; d < 4; d++)
+        {
+            int nr = r + dRow[d];
+            int nc = c + dCol[d];
+            if (nr < 0 || nr >= height || nc < 0 || nc >= width)
+                continue;
+            int neighbour = (nr << HPA_CLUSTER_SHIFT) | nc;
+            if (!hpa->localOpen[neighbour] || dist[neighbour] != HPA_INFINITE)
+                continue;
+            dist[neighbour] = dist[index] + 1;
+            dir[neighbour] = flowOpposite[d];
+            queue[tail++] = neighbour;
+        }
+    }
+}
+
+// Ordina le sorgenti per offset (e cella, per un ordine fisso); sono poche
+static void SortSeeds(LocalSeed *seeds, int count)
+{
+    for (int i = 1; i < count; i++)
+    {
+        LocalSeed seed = seeds[i];
+        int j = i;
+        while (j > 0 && (seeds[j - 1].offset > seed.offset ||
+                         (seeds[j - 1].offset == seed.offset && seeds[j - 1].index > seed.index)))
+        {
+            seeds[j] = seeds[j - 1];
+            j--;
+        }
+        seeds[j] = seed;
+    }
+}
+
+// === COSTRUZIONE DEL GRAFO ASTRATTO ===
+
+typedef struct {
+    Transition *items;
+    int count, capacity;
+} TransitionList;
+
+static bool PushTransition(TransitionList *list, int a, int b)
+{
+    if (list->count == list->capacity)
+    {
+        int capacity = list->capacity ? list->capacity * 2 : 1024;
+        Transition *items = realloc(list->items, sizeof(Transition) * (size_t)capacity);
+        if (!items)
+            return false;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count].a = a;
+    list->items[list->count].b = b;
+    list->count++;
+    return true;
+}
+
+// Ingresso aperto [first, last] lungo il confine line (tra line - 1 e line): una
+// transizione al centro, o due agli estremi se e' lungo
+static bool AddEntrance(TransitionList *list, bool vertical, int line, int first, int last)
+{
+    int picks[2] = {(first + last) / 2, 0};
+    int numPicks = 1;
+    if (last - first + 1 >= HPA_LONG_ENTRANCE)
+    {
+        picks[0] = first;
+        picks[1] = last;
+        numPicks = 2;
+    }
+    for (int i = 0; i < numPicks; i++)
+    {
+        int a = vertical ? PackPos(picks[i], line - 1) : PackPos(line - 1, picks[i]);
+        int b = vertical ? PackPos(picks[i], line) : PackPos(line, picks[i]);
+        if (!PushTransition(list, a, b))
+            return false;
+    }
+    return true;
+}
+
+// Tutte le transizioni: per ogni confine tra cluster, i tratti in cui le celle sono
+// libere da entrambi i lati (un tratto non scavalca l'angolo di un cluster)
+static bool FindTransitions(const HpaPlanner *hpa, const MapBits *map, TransitionList *list)
+{
+    for (int vertical = 1; vertical >= 0; vertical--)
+    {
+        int lineLimit = vertical ? hpa->cols : hpa->rows;   // Confini: colonne (verticali) o righe
+        int alongLimit = vertical ? hpa->rows : hpa->cols;
+        for (int line = HPA_CLUSTER_SIZE; line < lineLimit; line += HPA_CLUSTER_SIZE)
+        {
+            for (int band = 0; band < alongLimit; band += HPA_CLUSTER_SIZE)
+            {
+                int bandEnd = band + HPA_CLUSTER_SIZE < alongLimit ? band + HPA_CLUSTER_SIZE : alongLimit;
+                int start = -1;
+                for (int i = band; i <= bandEnd; i++)
+                {
+                    bool open = i < bandEnd &&
+                                (vertical ? !MapIsWall(map, i, line - 1) && !MapIsWall(map, i, line)
+                                          : !MapIsWall(map, line - 1, i) && !MapIsWall(map, line, i));
+                    if (open && start < 0)
+                        start = i;
+                    if (!open && start >= 0)
+                    {
+                        if (!AddEntrance(list, vertical, line, start, i - 1))
+                            return false;
+                        start = -1;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static int CompareKeys(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *)a;
+    unsigned long long y = *(const unsigned long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Chiave di un nodo: cluster << 32 | posizione, cosi' l'ordine raggruppa i nodi per cluster
+static unsigned long long NodeKey(const HpaPlanner *hpa, int pos)
+{
+    return ((unsigned long long)ClusterOf(hpa, pos >> 16, pos & 0xFFFF) << 32) | (unsigned int)pos;
+}
+
+static int FindNode(const unsigned long long *keys, int count, unsigned long long key)
+{
+    int lo = 0, hi = count - 1;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (keys[mid] < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+typedef struct {
+    int *target;
+    unsigned short *cost;
+    int count, capacity;
+} EdgeList;
+
+static bool PushEdge(EdgeList *edges, int target, unsigned int cost)
+{
+    if (edges->count == edges->capacity)
+    {
+        int capacity = edges->capacity ? edges->capacity * 2 : 4096;
+        int *targets = realloc(edges->target, sizeof(int) * (size_t)capacity);
+        if (!targets)
+            return false;
+        edges->target = targets;
+        unsigned short *costs = realloc(edges->cost, sizeof(unsigned short) * (size_t)capacity);
+        if (!costs)
+            return false;
+        edges->cost = costs;
+        edges->capacity = capacity;
+    }
+    edges->target[edges->count] = target;
+    edges->cost[edges->count] = (unsigned short)cost;
+    edges->count++;
+    return true;
+}
+
+// Nodi (raggruppati per cluster) e archi del grafo astratto
+static bool BuildGraph(HpaPlanner *hpa, const MapBits *map)
+{
+    TransitionList transitions = {0};
+    unsigned long long *keys = NULL;
+    int *crossFirst = NULL, *crossTarget = NULL;
+    EdgeList edges = {0};
+    unsigned int *pairDist = NULL;   // Distanze tra i nodi di un cluster
+    bool ok = false;
+
+    if (!FindTransitions(hpa, map, &transitions))
+        goto done;
+
+    // Nodi: le celle di transizione distinte, ordinate per cluster
+    keys = malloc(sizeof(unsigned long long) * (size_t)(transitions.count * 2 + 1));
+    hpa->clusterFirstNode = malloc(sizeof(int) * (size_t)(hpa->numClusters + 1));
+    if (!keys || !hpa->clusterFirstNode)
+        goto done;
+    int numKeys = 0;
+    for (int t = 0; t < transitions.count; t++)
+    {
+        keys[numKeys++] = NodeKey(hpa, transitions.items[t].a);
+        keys[numKeys++] = NodeKey(hpa, transitions.items[t].b);
+    }
+    qsort(keys, (size_t)numKeys, sizeof(unsigned long long), CompareKeys);
+    int numNodes = 0;
+    for (int i = 0; i < numKeys; i++)
+    {
+        if (numNodes == 0 || keys[i] != keys[numNodes - 1])
+            keys[numNodes++] = keys[i];
+    }
+    hpa->numNodes = numNodes;
+    hpa->nodePos = malloc(sizeof(int) * (size_t)(numNodes + 1));
+    if (!hpa->nodePos)
+        goto done;
+    for (int k = 0, n = 0; k <= hpa->numClusters; k++)
+    {
+        while (n < numNodes && (int)(keys[n] >> 32) < k)
+            n++;
+        hpa->clusterFirstNode[k] = n;
+    }
+    for (int n = 0; n < numNodes; n++)
+        hpa->nodePos[n] = (int)(keys[n] & 0xFFFFFFFFu);
+
+    // Archi tra cluster (costo 1), raggruppati per nodo
+    crossFirst = calloc((size_t)numNodes + 1, sizeof(int));
+    crossTarget = malloc(sizeof(int) * (size_t)(transitions.count * 2 + 1));
+    if (!crossFirst || !crossTarget)
+        goto done;
+    for (int t = 0; t < transitions.count; t++)
+    {
+        crossFirst[FindNode(keys, numNodes, NodeKey(hpa, transitions.items[t].a)) + 1]++;
+        crossFirst[FindNode(keys, numNodes, NodeKey(hpa, transitions.items[t].b)) + 1]++;
+    }
+    for (int n = 0; n < numNodes; n++)
+        crossFirst[n + 1] += crossFirst[n];
+    for (int t = 0; t < transitions.count; t++)
+    {
+        int a = FindNode(keys, numNodes, NodeKey(hpa, transitions.items[t].a));
+        int b = FindNode(keys, numNodes, NodeKey(hpa, transitions.items[t].b));
+        crossTarget[crossFirst[a]++] = b;
+        crossTarget[crossFirst[b]++] = a;
+    }
+    for (int n = numNodes; n > 0; n--)
+        crossFirst[n] = crossFirst[n - 1];
+    crossFirst[0] = 0;
+
+    // Archi dentro ogni cluster: una BFS locale da ogni nodo. Un arco u -> w che
+    // passa comunque per un altro nodo v del cluster (d(u,v) + d(v,w) == d(u,w))
+    // non serve: le distanze restano esatte e nei corridoi del labirinto gli archi
+    // diventano pochi per nodo invece di uno verso ogni altro nodo del cluster
+    hpa->edgeFirst = malloc(sizeof(int) * (size_t)(numNodes + 1));
+    pairDist = malloc(sizeof(unsigned int) * HPA_MAX_CLUSTER_NODES * HPA_MAX_CLUSTER_NODES);
+    if (!hpa->edgeFirst || !pairDist)
+        goto done;
+    for (int k = 0; k < hpa->numClusters; k++)
+    {
+        int first = hpa->clusterFirstNode[k];
+        int count = hpa->clusterFirstNode[k + 1] - first;
+        if (count == 0)
+            continue;
+        int row0, col0, height, width;
+        LoadCluster(hpa, map, k, &row0, &col0, &height, &width);
+        for (int i = 0; i < count; i++)
+        {
+            LocalSeed seed = {0, LocalIndex(hpa->nodePos[first + i], row0, col0), FLOW_NONE};
+            LocalBfs(hpa, &seed, 1, height, width);
+            for (int j = 0; j < count; j++)
+                pairDist[i * HPA_MAX_CLUSTER_NODES + j] = hpa->localDist[LocalIndex(hpa->nodePos[first + j], row0, col0)];
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            int n = first + i;
+            hpa->edgeFirst[n] = edges.count;
+            const unsigned int *from = &pairDist[i * HPA_MAX_CLUSTER_NODES];
+            for (int j = 0; j < count; j++)
+            {
+                if (j == i || from[j] == HPA_INFINITE)
+                    continue;
+                bool implied = false;
+                for (int v = 0; v < count && !implied; v++)
+                {
+                    unsigned int via = pairDist[v * HPA_MAX_CLUSTER_NODES + j];
+                    implied = v != i && v != j && from[v] != HPA_INFINITE && via != HPA_INFINITE && from[v] + via == from[j];
+                }
+                if (!implied && !PushEdge(&edges, first + j, from[j]))
+                    goto done;
+            }
+            for (int e = crossFirst[n]; e < crossFirst[n + 1]; e++)
+            {
+                if (!PushEdge(&edges, crossTarget[e], 1))
+                    goto done;
+            }
+        }
+    }
+    hpa->edgeFirst[numNodes] = edges.count;
+    hpa->numEdges = edges.count;
+    hpa->edgeTarget = edges.target;
+    hpa->edgeCost = edges.cost;
+    edges.target = NULL;
+    edges.cost = NULL;
+    ok = true;
+
+done:
+    free(transitions.items);
+    free(keys);
+    free(crossFirst);
+    free(crossTarget);
+    free(edges.target);
+    free(edges.cost);
+    free(pairDist);
+    return ok;
+}
+
+bool InitHpaPlanner(HpaPlanner *hpa, const MapBits *map)
+{
+    memset(hpa, 0, sizeof(*hpa));
+    hpa->rows = map->rows;
+    hpa->cols = map->cols;
+    hpa->clusterRows = (map->rows + HPA_CLUSTER_SIZE - 1) >> HPA_CLUSTER_SHIFT;
+    hpa->clusterCols = (map->cols + HPA_CLUSTER_SIZE - 1) >> HPA_CLUSTER_SHIFT;
+    hpa->numClusters = hpa->clusterRows * hpa->clusterCols;
+    hpa->targetRow = -1;
+    hpa->targetCol = -1;
+    hpa->anchorRow = -1;
+    hpa->anchorCol = -1;
+
+    hpa->localDist = malloc(sizeof(unsigned int) * HPA_LOCAL_CELLS);
+    hpa->localDir = malloc(HPA_LOCAL_CELLS);
+    hpa->localOpen = malloc(HPA_LOCAL_CELLS);
+    hpa->localQueue = malloc(sizeof(int) * HPA_LOCAL_CELLS);
+    hpa->nearDir = malloc(HPA_NEAR_SIZE * HPA_NEAR_SIZE);
+    hpa->nearQueue = malloc(sizeof(int) * HPA_NEAR_SIZE * HPA_NEAR_SIZE);
+    if (!hpa->localDist || !hpa->localDir || !hpa->localOpen || !hpa->localQueue ||
+        !hpa->nearDir || !hpa->nearQueue || !BuildGraph(hpa, map))
+    {
+        FreeHpaPlanner(hpa);
+        return false;
+    }
+
+    size_t numNodes = (size_t)hpa->numNodes + 1;
+    size_t numClusters = (size_t)hpa->numClusters;
+    hpa->nodes = calloc(numNodes, sizeof(HpaNodeState));
+    hpa->heap = malloc(sizeof(int) * numNodes);
+    hpa->clusterEpoch = calloc(numClusters, sizeof(unsigned int));
+    hpa->clusterRequest = calloc(numClusters, sizeof(unsigned int));
+    hpa->requested = malloc(sizeof(int) * numClusters);
+    if (!hpa->nodes || !hpa->heap || !hpa->clusterEpoch || !hpa->clusterRequest || !hpa->requested)
+    {
+        FreeHpaPlanner(hpa);
+        return false;
+    }
+    for (int n = 0; n < hpa->numNodes; n++)
+        hpa->nodes[n].heapPos = -1;
+    return true;
+}
+
+void FreeHpaPlanner(HpaPlanner *hpa)
+{
+    free(hpa->nodePos);
+    free(hpa->clusterFirstNode);
+    free(hpa->edgeFirst);
+    free(hpa->edgeTarget);
+    free(hpa->edgeCost);
+    free(hpa->nodes);
+    free(hpa->heap);
+    free(hpa->clusterEpoch);
+    free(hpa->clusterRequest);
+    free(hpa->requested);
+    free(hpa->localDist);
+    free(hpa->localDir);
+    free(hpa->localOpen);
+    free(hpa->localQueue);
+    free(hpa->nearDir);
+    free(hpa->nearQueue);
+    memset(hpa, 0, sizeof(*hpa));
+}
+
+// === RICERCA SUL GRAFO ASTRATTO ===
+
+static void HeapSet(HpaPlanner *hpa, int slot, int node)
+{
+    hpa->heap[slot] = node;
+    hpa->nodes[node].heapPos = slot;
+}
+
+static void HeapUp(HpaPlanner *hpa, int slot)
+{
+    int node = hpa->heap[slot];
+    while (slot > 0)
+    {
+        int parent = (slot - 1) / 2;
+        if (hpa->nodes[hpa->heap[parent]].dist <= hpa->nodes[node].dist)
+            break;
+        HeapSet(hpa, slot, hpa->heap[parent]);
+        slot = parent;
+    }
+    HeapSet(hpa, slot, node);
+}
+
+static void HeapDown(HpaPlanner *hpa, int slot)
+{
+    int node = hpa->heap[slot];
+    for (;;)
+    {
+        int child = 2 * slot + 1;
+        if (child >= hpa->heapSize)
+            break;
+        if (child + 1 < hpa->heapSize && hpa->nodes[hpa->heap[child + 1]].dist < hpa->nodes[hpa->heap[child]].dist)
+            child++;
+        if (hpa->nodes[hpa->heap[child]].dist >= hpa->nodes[node].dist)
+            break;
+        HeapSet(hpa, slot, hpa->heap[child]);
+        slot = child;
+    }
+    HeapSet(hpa, slot, node);
+}
+
+static int HeapPop(HpaPlanner *hpa)
+{
+    int node = hpa->heap[0];
+    hpa->nodes[node].heapPos = -1;
+    if (--hpa->heapSize > 0)
+    {
+        HeapSet(hpa, 0, hpa->heap[hpa->heapSize]);
+        HeapDown(hpa, 0);
+    }
+    return node;
+}
+
+// Nuova distanza provvisoria per un nodo aperto (inserito se non c'era)
+static void OpenNode(HpaPlanner *hpa, int node, unsigned int dist)
+{
+    hpa->nodes[node].dist = dist;
+    hpa->nodes[node].distEpoch = hpa->epoch;
+    if (hpa->nodes[node].heapPos < 0)
+        HeapSet(hpa, hpa->heapSize++, node);
+    HeapUp(hpa, hpa->nodes[node].heapPos);
+}
+
+static bool IsClosed(const HpaPlanner *hpa, int node)
+{
+    return hpa->nodes[node].closedEpoch == hpa->epoch;
+}
+
+// Riprende la ricerca finche' i nodi indicati hanno la distanza definitiva (o non
+// restano nodi aperti: quelli mancanti non sono raggiungibili)
+static void SettleNodes(HpaPlanner *hpa, const int *nodes, int count)
+{
+    unsigned int id = ++hpa->requiredId;
+    int pending = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (!IsClosed(hpa, nodes[i]) && hpa->nodes[nodes[i]].requiredStamp != id)
+        {
+            hpa->nodes[nodes[i]].requiredStamp = id;
+            pending++;
+        }
+    }
+
+    while (pending > 0 && hpa->heapSize > 0)
+    {
+        int node = HeapPop(hpa);
+        hpa->nodes[node].closedEpoch = hpa->epoch;
+        if (hpa->nodes[node].requiredStamp == id)
+            pending--;
+
+        unsigned int dist = hpa->nodes[node].dist;
+        for (int e = hpa->edgeFirst[node]; e < hpa->edgeFirst[node + 1]; e++)
+        {
+            int next = hpa->edgeTarget[e];
+            unsigned int nextDist = dist + hpa->edgeCost[e];
+            if (IsClosed(hpa, next))
+                continue;
+            if (hpa->nodes[next].distEpoch != hpa->epoch || nextDist < hpa->nodes[next].dist)
+                OpenNode(hpa, next, nextDist);
+        }
+    }
+}
+
+// BFS dalla cella di Pacman sulle celle del blocco di cluster attorno al suo: direzioni in nearDir
+static void ComputeNearField(HpaPlanner *hpa, const MapBits *map)
+{
+    int clusterRow = hpa->targetRow >> HPA_CLUSTER_SHIFT;
+    int clusterCol = hpa->targetCol >> HPA_CLUSTER_SHIFT;
+    int row0 = clusterRow > HPA_NEAR_RADIUS ? (clusterRow - HPA_NEAR_RADIUS) << HPA_CLUSTER_SHIFT : 0;
+    int col0 = clusterCol > HPA_NEAR_RADIUS ? (clusterCol - HPA_NEAR_RADIUS) << HPA_CLUSTER_SHIFT : 0;
+    int row1 = (clusterRow + HPA_NEAR_RADIUS + 1) << HPA_CLUSTER_SHIFT;
+    int col1 = (clusterCol + HPA_NEAR_RADIUS + 1) << HPA_CLUSTER_SHIFT;
+    hpa->nearRow0 = row0;
+    hpa->nearCol0 = col0;
+    hpa->nearRows = (row1 < hpa->rows ? row1 : hpa->rows) - row0;
+    hpa->nearCols = (col1 < hpa->cols ? col1 : hpa->cols) - col0;
+
+    unsigned char *dir = hpa->nearDir;
+    int *queue = hpa->nearQueue;
+    int head = 0, tail = 0;
+    memset(dir, HPA_NEAR_UNREACHED, HPA_NEAR_SIZE * HPA_NEAR_SIZE);
+    if (MapIsWall(map, hpa->targetRow, hpa->targetCol))
+        return;
+
+    int start = (hpa->targetRow - row0) * HPA_NEAR_SIZE + (hpa->targetCol - col0);
+    dir[start] = FLOW_NONE;
+    queue[tail++] = start;
+    while (head < tail)
+    {
+        int index = queue[head++];
+        int r = index / HPA_NEAR_SIZE;
+        int c = index - r * HPA_NEAR_SIZE;
+        for (int d = 0; d < 4; d++)
+        {
+            int nr = r + dRow[d];
+            int nc = c + dCol[d];
+            if (nr < 0 || nr >= hpa->nearRows || nc < 0 || nc >= hpa->nearCols)
+                continue;
+            int next = nr * HPA_NEAR_SIZE + nc;
+            if (dir[next] != HPA_NEAR_UNREACHED || MapIsWall(map, row0 + nr, col0 + nc))
+                continue;
+            dir[next] = flowOpposite[d];
+            queue[tail++] = next;
+        }
+    }
+}
+
+void HpaSetTarget(HpaPlanner *hpa, const MapBits *map, int row, int col)
+{
+    hpa->targetRow = row;
+    hpa->targetCol = col;
+    ComputeNearField(hpa, map);
+
+    // Zona di Pacman: le celle del suo cluster che raggiunge senza uscirne. L'ancora
+    // e' quella piu' vicina al centro del cluster (a parita', la prima per riga)
+    int k = ClusterOf(hpa, row, col);
+    int row0, col0, height, width;
+    int anchor = -1;
+    if (!MapIsWall(map, row, col))
+    {
+        LoadCluster(hpa, map, k, &row0, &col0, &height, &width);
+        LocalSeed seed = {0, LocalIndex(PackPos(row, col), row0, col0), FLOW_NONE};
+        LocalBfs(hpa, &seed, 1, height, width);
+        int best = 0;
+        for (int index = 0; index < HPA_LOCAL_CELLS; index++)
+        {
+            if (hpa->localDist[index] == HPA_INFINITE)
+                continue;
+            int r = index >> HPA_CLUSTER_SHIFT;
+            int c = index & (HPA_CLUSTER_SIZE - 1);
+            int centre = abs(2 * r - (height - 1)) + abs(2 * c - (width - 1));   // Il doppio, per restare interi
+            if (anchor < 0 || centre < best)
+            {
+                anchor = index;
+                best = centre;
+            }
+        }
+    }
+    int anchorRow = anchor < 0 ? -1 : row0 + (anchor >> HPA_CLUSTER_SHIFT);
+    int anchorCol = anchor < 0 ? -1 : col0 + (anchor & (HPA_CLUSTER_SIZE - 1));
+
+    // Stessa zona: distanze astratte e campi lontani restano, sono da rifare solo i cluster del blocco
+    if (hpa->epoch > 0 && anchorRow == hpa->anchorRow && anchorCol == hpa->anchorCol)
+    {
+        for (int r = hpa->nearRow0; r < hpa->nearRow0 + hpa->nearRows; r += HPA_CLUSTER_SIZE)
+        {
+            for (int c = hpa->nearCol0; c < hpa->nearCol0 + hpa->nearCols; c += HPA_CLUSTER_SIZE)
+                hpa->clusterEpoch[ClusterOf(hpa, r, c)] = 0;
+        }
+        return;
+    }
+
+    // Nuova ancora: nuova epoch, distanze, nodi chiusi e campi dei cluster diventano tutti vecchi
+    hpa->epoch++;
+    hpa->anchorRow = anchorRow;
+    hpa->anchorCol = anchorCol;
+    for (int i = 0; i < hpa->heapSize; i++)
+        hpa->nodes[hpa->heap[i]].heapPos = -1;
+    hpa->heapSize = 0;
+    if (anchor < 0)
+        return;
+
+    // Semi della ricerca: i nodi del cluster di Pacman, alla distanza locale dall'ancora
+    LocalSeed seed = {0, anchor, FLOW_NONE};
+    LocalBfs(hpa, &seed, 1, height, width);
+    for (int n = hpa->clusterFirstNode[k]; n < hpa->clusterFirstNode[k + 1]; n++)
+    {
+        unsigned int d = hpa->localDist[LocalIndex(hpa->nodePos[n], row0, col0)];
+        if (d != HPA_INFINITE)
+            OpenNode(hpa, n, d);
+    }
+}
+
+// === CAMPO FINE DI UN CLUSTER ===
+
+// Direzione del passo dalla cella di transizione from alla cella vicina to
+static unsigned char StepDirection(int from, int to)
+{
+    if ((to >> 16) != (from >> 16))
+        return (to >> 16) > (from >> 16) ? FLOW_DOWN : FLOW_UP;
+    return (to & 0xFFFF) > (from & 0xFFFF) ? FLOW_RIGHT : FLOW_LEFT;
+}
+
+// Fissa le distanze dei nodi dei cluster vicini affacciati su k, poi scrive la
+// direzione di tutte le celle di k: BFS locale dall'ancora (se e' in k) e da ogni
+// transizione di k, che parte dalla distanza del nodo al di la' del confine. Nel
+// blocco attorno a Pacman vince la BFS esatta, dove arriva
+static void RefineCluster(HpaPlanner *hpa, const MapBits *map, int k, unsigned char *flowDir)
+{
+    int first = hpa->clusterFirstNode[k];
+    int last = hpa->clusterFirstNode[k + 1];
+    int partners[HPA_MAX_SEEDS * 2];
+    int numPartners = 0;
+    for (int n = first; n < last; n++)
+    {
+        for (int e = hpa->edgeFirst[n]; e < hpa->edgeFirst[n + 1]; e++)
+        {
+            int next = hpa->edgeTarget[e];
+            if ((next < first || next >= last) && numPartners < HPA_MAX_SEEDS * 2)
+                partners[numPartners++] = next;
+        }
+    }
+    SettleNodes(hpa, partners, numPartners);
+
+    int row0, col0, height, width;
+    LoadCluster(hpa, map, k, &row0, &col0, &height, &width);
+    LocalSeed seeds[HPA_MAX_SEEDS];
+    int numSeeds = 0;
+    if (hpa->anchorRow >= row0 && hpa->anchorRow < row0 + height &&
+        hpa->anchorCol >= col0 && hpa->anchorCol < col0 + width)
+    {
+        seeds[numSeeds].offset = 0;
+        seeds[numSeeds].index = LocalIndex(PackPos(hpa->anchorRow, hpa->anchorCol), row0, col0);
+        seeds[numSeeds].dir = FLOW_NONE;
+        numSeeds++;
+    }
+    for (int n = first; n < last && numSeeds < HPA_MAX_SEEDS; n++)
+    {
+        unsigned int best = HPA_INFINITE;
+        unsigned char bestDir = FLOW_NONE;
+        for (int e = hpa->edgeFirst[n]; e < hpa->edgeFirst[n + 1]; e++)
+        {
+            int next = hpa->edgeTarget[e];
+            if ((next >= first && next < last) || !IsClosed(hpa, next))
+                continue;
+            unsigned int offset = hpa->nodes[next].dist + hpa->edgeCost[e];
+            if (offset < best)
+            {
+                best = offset;
+                bestDir = StepDirection(hpa->nodePos[n], hpa->nodePos[next]);
+            }
+        }
+        if (best != HPA_INFINITE)
+        {
+            seeds[numSeeds].offset = best;
+            seeds[numSeeds].index = LocalIndex(hpa->nodePos[n], row0, col0);
+            seeds[numSeeds].dir = bestDir;
+            numSeeds++;
+        }
+    }
+    SortSeeds(seeds, numSeeds);
+    LocalBfs(hpa, seeds, numSeeds, height, width);
+
+    // Il blocco e' fatto di cluster interi: k ci sta tutto dentro o tutto fuori
+    int nearRow = row0 - hpa->nearRow0;
+    int nearCol = col0 - hpa->nearCol0;
+    bool near = nearRow >= 0 && nearRow < hpa->nearRows && nearCol >= 0 && nearCol < hpa->nearCols;
+    for (int r = 0; r < height; r++)
+    {
+        unsigned char *row = flowDir + (size_t)(row0 + r) * (size_t)hpa->cols + col0;
+        const unsigned char *exact = hpa->nearDir + (nearRow + r) * HPA_NEAR_SIZE + nearCol;
+        for (int c = 0; c < width; c++)
+        {
+            int index = (r << HPA_CLUSTER_SHIFT) | c;
+            row[c] = hpa->localDist[index] == HPA_INFINITE ? FLOW_NONE : hpa->localDir[index];
+            if (near && exact[c] != HPA_NEAR_UNREACHED)
+                row[c] = exact[c];
+        }
+    }
+    hpa->clusterEpoch[k] = hpa->epoch;
+}
+
+void HpaUpdateGhostCells(HpaPlanner *hpa, const MapBits *map, const GhostSwarm *ghosts, unsigned char *flowDir)
+{
+    // Cluster con almeno un nodo dove un fantasma decidera' e campo vecchio, una volta sola ciascuno
+    unsigned int id = ++hpa->requestId;
+    int numRequested = 0;
+    for (int i = 0; i < ghosts->count; i++)
+    {
+        int row = ghosts->target[i] / hpa->cols;
+        int col = ghosts->target[i] - row * hpa->cols;
+        int k = ClusterOf(hpa, row, col);
+        if (hpa->clusterEpoch[k] == hpa->epoch || hpa->clusterRequest[k] == id)
+            continue;
+        hpa->clusterRequest[k] = id;
+        hpa->requested[numRequested++] = k;
+    }
+
+    // Il Dijkstra dall'ancora si allarga solo finche' copre i cluster richiesti
+    for (int i = 0; i < numRequested; i++)
+        RefineCluster(hpa, map, hpa->requested[i], flowDir);
+}
@@ -0,0 +1,119 @@
+// === CACHE DEL TESTO DELL'INTERFACCIA ===
+#include "utils/raylib/src/raylib.h"
+#include "lib/hud.h"
+
+// Ridisegna il testo nella texture, ingrandendola se serve
+static void RenderTextLabel(TextLabel *label)
+{
+    int height = label->fontSize + 4;   // Margine per le lettere che scendono sotto la riga
+    if (!label->loaded || label->texture.texture.width < label->width || label->texture.texture.height < height)
+    {
+        if (label->loaded)
+            UnloadRenderTexture(label->texture);
+        // Un po' di spazio in piu' per non ricreare la texture a ogni cifra aggiunta
+        label->texture = LoadRenderTexture(label->width + label->fontSize * 2, height);
+        label->loaded = true;
+    }
+
+    BeginTextureMode(label->texture);
+    ClearBackground(BLANK);
+    DrawText(label->text, 0, 0, label->fontSize, label->color);
+    EndTextureMode();
+}
+
+void LoadTextLabel(TextLabel *label, const char *format, int fontSize, Color color)
+{
+    label->format = format;
+    label->fontSize = fontSize;
+    label->color = color;
+    label->hasValue = false;
+    label->loaded = false;
+    label->width = 0;
+    label->text[0] = '\0';
+}
+
+void SetTextLabelValue(TextLabel *label, int value)
+{
+    if (label->hasValue && label->value == value)
+        return;   // Niente e' cambiato: la texture e' gia' giusta
+
+    label->value = value;
+    label->hasValue = true;
+    snprintf(label->text, sizeof(label->text), label->format, value);
+    label->width = MeasureText(label->text, label->fontSize);
+    RenderTextLabel(label);
+}
+
+void DrawTextLabel(const TextLabel *label, int x, int y)
+{
+    if (!label->loaded)
+        return;
+
+    // Le RenderTexture sono capovolte in verticale: altezza negativa nel rettangolo sorgente
+    Rectangle source = {0, 0, (float)label->texture.texture.width, -(float)label->texture.texture.height};
+    DrawTextureRec(label->texture.texture, source, (Vector2){(float)x, (float)y}, WHITE);
+}
+
+void UnloadTextLabel(TextLabel *label)
+{
+    if (label->loaded)
+        UnloadRenderTexture(label->texture);
+    label->loaded = false;
+    label->hasValue = false;
+}
+
+// === OVERLAY DEI TEMPI DEI FRAME ===
+
+#define OVERLAY_WIDTH      300
+#define OVERLAY_LINE       14       // Altezza di una riga di testo
+#define OVERLAY_GRAPH      60       // Altezza del grafico
+#define OVERLAY_GRAPH_MS   50.0f    // Millisecondi in cima al grafico
+
+// Una riga della tabella: il font di raylib non e' a larghezza fissa, le colonne hanno una x propria
+static void DrawOverlayRow(int x, int y, const char *name, const char *average, const char *p95, const char *p99, Color color)
+{
+    DrawText(name, x + 6, y, 10, color);
+    DrawText(average, x + 120, y, 10, color);
+    DrawText(p95, x + 180, y, 10, color);
+    DrawText(p99, x + 240, y, 10, color);
+}
+
+void DrawProfilerOverlay(FrameProfiler *profiler, int x, int y)
+{
+    UpdateProfileStats(profiler, false);
+    int height = (PROFILE_PHASE_COUNT + 2) * OVERLAY_LINE + OVERLAY_GRAPH + 16;
+    DrawRectangle(x, y, OVERLAY_WIDTH, height, Fade(BLACK, 0.75f));
+
+    int textY = y + 4;
+    DrawOverlayRow(x, textY, "fase (ms)", "media", "p95", "p99", LIGHTGRAY);
+    textY += OVERLAY_LINE;
+    for (int phase = 0; phase <= PROFILE_PHASE_COUNT; phase++)
+    {
+        // Ultima riga: il frame intero
+        bool total = phase == PROFILE_PHASE_COUNT;
+        const ProfileStats *stats = total ? &profiler->frameStats : &profiler->stats[phase];
+        DrawOverlayRow(x, textY, total ? "frame" : ProfilePhaseName((ProfilePhase)phase),
+                       TextFormat("%.2f", stats->average), TextFormat("%.2f", stats->p95),
+                       TextFormat("%.2f", stats->p99), total ? YELLOW : WHITE);
+        textY += OVERLAY_LINE;
+    }
+    textY += 4;
+
+    // Grafico: una colonna per frame, il piu' recente a destra
+    int graphX = x + 6;
+    int graphWidth = OVERLAY_WIDTH - 12;
+    int graphBottom = textY + OVERLAY_GRAPH;
+    for (int column = 0; column < graphWidth; column++)
+    {
+        float ms = GetProfiledFrameMs(profiler, graphWidth - 1 - column);
+        int barHeight = (int)(ms / OVERLAY_GRAPH_MS * OVERLAY_GRAPH);
+        if (barHeight > OVERLAY_GRAPH)
+            barHeight = OVERLAY_GRAPH;
+        Color color = ms > 1000.0f / 30.0f ? RED : (ms > 1000.0f / 60.0f + 1.0f ? ORANGE : GREEN);
+        DrawRectangle(graphX + column, graphBottom - barHeight, 1, barHeight, color);
+    }
+    int line60 = graphBottom - (int)(1000.0f / 60.0f / OVERLAY_GRAPH_MS * OVERLAY_GRAPH);
+    int line30 = graphBottom - (int)(1000.0f / 30.0f / OVERLAY_GRAPH_MS * OVERLAY_GRAPH);
+    DrawLine(graphX, line60, graphX + graphWidth, line60, Fade(WHITE, 0.5f));
+    DrawLine(graphX, line30, graphX + graphWidth, line30, Fade(RED, 0.5f));
+}
@@ -0,0 +1,167 @@
+// === GRAFO DEGLI INCROCI ===
+#include "lib/junction.h"
+#include <string.h>
+
+// Stesse direzioni del flow field: destra, sinistra, giu', su
+static const int dRow[4] = {0, 0, 1, -1};
+static const int dCol[4] = {1, -1, 0, 0};
+static const int opposite[4] = {1, 0, 3, 2};
+
+#define JUNCTION_HORIZONTAL ((1 << 0) | (1 << 1))
+#define JUNCTION_VERTICAL   ((1 << 2) | (1 << 3))
+
+// Bit d acceso = la cella vicina in direzione d e' libera
+static int OpenMask(const MapBits *map, int row, int col)
+{
+    int mask = 0;
+    for (int d = 0; d < 4; d++)
+    {
+        if (!MapIsWall(map, row + dRow[d], col + dCol[d]))
+            mask |= 1 << d;
+    }
+    return mask;
+}
+
+// Cella libera in mezzo a un corridoio dritto: si attraversa senza decidere nulla
+static bool IsCorridor(const MapBits *map, int row, int col)
+{
+    if (MapIsWall(map, row, col))
+        return false;
+    int mask = OpenMask(map, row, col);
+    return mask == JUNCTION_HORIZONTAL || mask == JUNCTION_VERTICAL;
+}
+
+int JunctionNodeOfCell(const JunctionGraph *graph, int cell)
+{
+    int lo = 0, hi = graph->numNodes - 1;
+    while (lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (graph->nodes[mid].cell == cell)
+            return mid;
+        if (graph->nodes[mid].cell < cell)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return JUNCTION_NONE;
+}
+
+// Nodi: tutte le celle libere che non sono corridoio dritto; archi: le loro uscite
+static void CountGraph(const MapBits *map, int *numNodes, int *numEdges)
+{
+    *numNodes = 0;
+    *numEdges = 0;
+    for (int row = 0; row < map->rows; row++)
+    {
+        for (int col = 0; col < map->cols; col++)
+        {
+            if (MapIsWall(map, row, col) || IsCorridor(map, row, col))
+                continue;
+            (*numNodes)++;
+            *numEdges += __builtin_popcount((unsigned int)OpenMask(map, row, col));
+        }
+    }
+}
+
+size_t JunctionGraphMemorySize(const MapBits *map)
+{
+    int numNodes, numEdges;
+    CountGraph(map, &numNodes, &numEdges);
+    return ArenaSize(sizeof(JunctionNode) * (size_t)(numNodes + 1)) +
+           ArenaSize(sizeof(JunctionEdge) * (size_t)(numEdges + 1));
+}
+
+bool BuildJunctionGraph(JunctionGraph *graph, const MapBits *map, Arena *arena)
+{
+    memset(graph, 0, sizeof(*graph));
+    for (int d = 0; d < 4; d++)
+        graph->cellStep[d] = dRow[d] * map->cols + dCol[d];
+
+    int numNodes, numEdges;
+    CountGraph(map, &numNodes, &numEdges);
+    graph->nodes = ArenaAlloc(arena, sizeof(JunctionNode) * (size_t)(numNodes + 1));
+    graph->edges = ArenaAlloc(arena, sizeof(JunctionEdge) * (size_t)(numEdges + 1));
+    if (!graph->nodes || !graph->edges)
+    {
+        memset(graph, 0, sizeof(*graph));
+        return false;
+    }
+    for (int row = 0; row < map->rows; row++)
+    {
+        for (int col = 0; col < map->cols; col++)
+        {
+            if (MapIsWall(map, row, col) || IsCorridor(map, row, col))
+                continue;
+            JunctionNode *node = &graph->nodes[graph->numNodes++];
+            node->cell = MapCell(map, row, col);
+        }
+    }
+
+    // Archi: da ogni nodo, in ogni direzione libera, dritto fino al nodo successivo
+    for (int n = 0; n < graph->numNodes; n++)
+    {
+        JunctionNode *node = &graph->nodes[n];
+        int row = MapCellRow(map, node->cell);
+        int col = MapCellCol(map, node->cell);
+        for (int d = 0; d < 4; d++)
+        {
+            node->edges[d] = JUNCTION_NONE;
+            if (MapIsWall(map, row + dRow[d], col + dCol[d]))
+                continue;
+
+            int length = 1;
+            int r = row + dRow[d], c = col + dCol[d];
+            while (IsCorridor(map, r, c))
+            {
+                r += dRow[d];
+                c += dCol[d];
+                length++;
+            }
+
+            JunctionEdge *edge = &graph->edges[graph->numEdges];
+            edge->fromCell = node->cell;
+            edge->fromRow = row;
+            edge->fromCol = col;
+            edge->toNode = JunctionNodeOfCell(graph, MapCell(map, r, c));
+            edge->toCell = MapCell(map, r, c);
+            edge->length = length;
+            edge->dir = (unsigned char)d;
+            edge->dx = (signed char)dCol[d];
+            edge->dy = (signed char)dRow[d];
+            node->edges[d] = graph->numEdges++;
+        }
+    }
+    return true;
+}
+
+bool JunctionPlace(const JunctionGraph *graph, const MapBits *map, int cell, int dir, int *edge, int *cellsDone)
+{
+    int row = MapCellRow(map, cell);
+    int col = MapCellCol(map, cell);
+    *edge = JUNCTION_NONE;
+    *cellsDone = 0;
+
+    // Prima direzione libera a partire da quella chiesta
+    int mask = MapIsWall(map, row, col) ? 0 : OpenMask(map, row, col);
+    int d = dir & 3;
+    for (int k = 0; k < 4 && !(mask & (1 << d)); k++)
+        d = (d + 1) & 3;
+    if (!(mask & (1 << d)))
+        return false;
+
+    // In mezzo a un corridoio: l'arco parte dal nodo alle spalle
+    int cellsBack = 0;
+    while (IsCorridor(map, row, col))
+    {
+        row += dRow[opposite[d]];
+        col += dCol[opposite[d]];
+        cellsBack++;
+    }
+    int node = JunctionNodeOfCell(graph, MapCell(map, row, col));
+    if (node == JUNCTION_NONE)
+        return false;
+    *edge = graph->nodes[node].edges[d];
+    *cellsDone = cellsBack;
+    return *edge != JUNCTION_NONE;
+}
@@ -0,0 +1,50 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/*
+ * === ARENA (ALLOCATORE A PUNTATORE) ===
+ *
+ * Un solo blocco riservato all'inizio; ogni allocazione sposta in avanti un
+ * indice e non si libera da sola. Tutto quello che ha la stessa vita (la
+ * memoria di un World, vedi SimCreate) sta nello stesso blocco, uno dopo
+ * l'altro nell'ordine in cui si alloca: si libera con una sola free, si
+ * svuota in O(1) con ArenaReset e si riusa senza toccare l'heap.
+ *
+ * Chi usa l'arena ne calcola prima la dimensione esatta sommando
+ * ArenaSize() di ogni allocazione (es. MapMemorySize): se i conti non
+ * tornano ArenaAlloc ritorna NULL, non scrive mai oltre il blocco.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ARENA_ALIGN 64               // Ogni allocazione parte su una cache line (e va bene per AVX)
+
+typedef struct {
+    unsigned char *base;             // Blocco riservato (NULL = arena vuota)
+    size_t capacity;                 // Byte del blocco
+    size_t used;                     // Byte gia' dati (multiplo di ARENA_ALIGN)
+} Arena;
+
+// Spazio che occupa nell'arena un'allocazione di size byte
+static inline size_t ArenaSize(size_t size)
+{
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+// Riserva capacity byte (una sola allocazione); false se manca memoria
+bool ArenaInit(Arena *arena, size_t capacity);
+
+// Libera il blocco
+void ArenaFree(Arena *arena);
+
+// size byte allineati ad ARENA_ALIGN, non inizializzati; NULL se il blocco e' finito
+void *ArenaAlloc(Arena *arena, size_t size);
+
+// Svuota l'arena: le allocazioni precedenti non valgono piu', il blocco resta
+static inline void ArenaReset(Arena *arena)
+{
+    arena->used = 0;
+}
+
+#endif // ARENA_H
@@ -0,0 +1,139 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+/*
+ * === AUTOPILOTA (MONTE CARLO TREE SEARCH) ===
+ *
+ * Muove Pacman al posto della tastiera. Quando Pacman arriva al centro di una
+ * cella nuova l'autopilota salva il World in uno snapshot e cerca la mossa
+ * migliore per un tempo fisso (budget):
+ *
+ *   - ogni thread fa crescere un proprio albero: ogni nodo e' una direzione
+ *     tenuta fino al centro della cella successiva, dove si decide di nuovo
+ *     (al massimo 2 * AUTOPILOT_ACTION_TICKS tick). Un'iterazione
+ *     ripristina lo snapshot in un World di lavoro, scende nell'albero con
+ *     UCB1 giocando le mosse del percorso, aggiunge un figlio e da li' gioca
+ *     un rollout casuale di AUTOPILOT_ROLLOUT_ACTIONS mosse;
+ *   - il valore di un rollout premia i punti fatti e punisce la vita persa
+ *     (meno se arriva tardi);
+ *   - alla scadenza i thread si fermano e le visite dei figli della radice
+ *     vengono sommate: vince la direzione piu' visitata. La scadenza si
+ *     controlla a ogni mossa, non solo tra un'iterazione e l'altra: su un
+ *     labirinto grande un'iterazione intera puo' costare piu' del budget
+ *     (ogni cella nuova di Pacman ricalcola il flow field).
+ *
+ * I thread restano vivi per tutta la partita e dormono tra una ricerca e
+ * l'altra; il chiamante lavora come uno di loro. Gli alberi sono separati
+ * (parallelismo alla radice), quindi durante la ricerca nessun lock. La forza
+ * dell'autopilota dipende da quanti rollout fa nel budget: rollout al
+ * secondo e' la misura da tenere d'occhio (SimStep e SnapshotLoad).
+ *
+ * Con un budget a tempo la mossa scelta dipende dalla velocita' della
+ * macchina: le partite si rigiocano registrandone l'input (vedi replay.h).
+ */
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "sim.h"
+
+#define AUTOPILOT_MAX_THREADS 64
+#define AUTOPILOT_MAX_NODES 8192                 // Nodi di un albero (per thread); pieno = solo rollout
+#define AUTOPILOT_ACTION_TICKS ((int)((TILE_SIZE + PACMAN_BASE_SPEED - 1.0f) / PACMAN_BASE_SPEED))  // Una cella
+#define AUTOPILOT_ROLLOUT_ACTIONS 8              // Mosse casuali dopo la foglia
+#define AUTOPILOT_EXPLORATION 0.7f               // Costante di esplorazione di UCB1
+#define AUTOPILOT_SCORE_SCALE 100.0f             // Punti che valgono meta' del premio massimo
+#define AUTOPILOT_MAX_DEPTH 64                   // Mosse al massimo tra radice e foglia
+#define AUTOPILOT_DEFAULT_BUDGET_US 2000         // Tempo di ricerca per decisione (microsecondi)
+
+typedef struct {
+    int children[4];                 // Figlio per direzione (AUTOPILOT_NO_CHILD = non ancora espanso)
+    unsigned char validMask;         // Direzioni possibili dallo stato del nodo (calcolate alla prima visita)
+    bool expanded;                   // validMask valido
+    bool terminal;                   // Vita persa: niente figli
+    unsigned int visits;
+    float value;                     // Somma dei valori dei rollout passati di qui
+} AutopilotNode;
+
+#define AUTOPILOT_NO_CHILD (-1)
+
+// Stato di ricerca di un thread: World di lavoro e albero, riusati a ogni decisione
+typedef struct {
+    World world;                     // Copia su cui si giocano le iterazioni
+    struct Autopilot *owner;         // Autopilota a cui appartiene (per i thread)
+    AutopilotNode *nodes;            // AUTOPILOT_MAX_NODES nodi, il primo e' la radice
+    int numNodes;
+    unsigned int rng;                // xorshift del thread (rollout casuali)
+    int rootLives;                   // Vite e punti della radice (riferimento del valore)
+    int rootScore;
+    long long rollouts;              // Iterazioni fatte dall'ultima AutopilotTreeReset
+    long long truncated;             // Iterazioni interrotte dalla scadenza
+    char pad[64];                    // Alberi di thread diversi non condividono cache line
+} AutopilotTree;
+
+typedef struct Autopilot {
+    int numThreads;                  // Thread che cercano, compreso il chiamante
+    int numWorkers;                  // Thread creati (numThreads - 1 se tutto va bene)
+    pthread_t *threads;
+    AutopilotTree *trees;            // Uno per thread (il chiamante usa trees[0])
+    int budgetUs;                    // Tempo di ricerca per decisione
+
+    // Ricerca pubblicata (scritta dal chiamante prima di generation)
+    unsigned char *snapshot;         // Stato della radice (SnapshotSave)
+    double deadline;                 // Fine della ricerca (secondi, orologio monotono)
+    unsigned int generation;
+    int done;                        // Thread che hanno finito la ricerca corrente
+    bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;             // Nuova ricerca (per i thread)
+    pthread_cond_t finished;         // Un thread ha finito (per il chiamante)
+
+    // Decisione in corso
+    SimInput current;                // Ultima direzione scelta
+    int decisionCell;                // Cella di Pacman dell'ultima decisione
+    Vector2 lastPos;                 // Posizione di Pacman alla chiamata precedente (fermo = decide di nuovo)
+
+    // Statistiche dall'avvio (o da AutopilotResetStats)
+    long long decisions;
+    long long rollouts;
+    double searchSeconds;            // Tempo reale passato a cercare
+    long long truncated;             // Iterazioni interrotte dalla scadenza (buttate, tranne la prima di ogni albero)
+    double overrunSeconds;           // Tempo passato a cercare oltre la scadenza (somma)
+    double maxOverrunSeconds;        // Sforamento peggiore di una ricerca
+} Autopilot;
+
+// Prepara numThreads alberi sul labirinto e sul numero di fantasmi di w e
+// avvia numThreads - 1 thread; false se mancano memoria o thread
+bool InitAutopilot(Autopilot *ap, const World *w, int numThreads, int budgetUs);
+
+// Ferma i thread e libera tutto
+void FreeAutopilot(Autopilot *ap);
+
+// Input di Pacman per il tick corrente di w: cerca una mossa solo quando
+// Pacman arriva al centro di una cella nuova (o e' fermo)
+SimInput AutopilotInput(Autopilot *ap, const World *w);
+
+// Rollout al secondo dall'avvio (somma di tutti i thread)
+double AutopilotRolloutsPerSecond(const Autopilot *ap);
+
+// Azzera le statistiche
+void AutopilotResetStats(Autopilot *ap);
+
+// === ALBERO DI UN THREAD ===
+// Pubbliche per misurarle da sole (make bench)
+
+// Alloca World di lavoro e nodi per il labirinto e i fantasmi di w
+bool InitAutopilotTree(AutopilotTree *tree, const World *w);
+
+// Libera l'albero
+void FreeAutopilotTree(AutopilotTree *tree);
+
+// Nuova ricerca dalla radice descritta da root (lo stesso World salvato in snapshot)
+void AutopilotTreeReset(AutopilotTree *tree, const World *root, unsigned int seed);
+
+// Un'iterazione: ripristino dello snapshot, discesa, espansione, rollout. La
+// scadenza (secondi, orologio monotono; 0 = nessuna) si controlla tra una mossa
+// e l'altra: se passa a meta' l'iterazione si butta e ritorna false, tranne la
+// prima dopo AutopilotTreeReset, che conta per le mosse che ha giocato
+bool AutopilotTreeIterate(AutopilotTree *tree, const void *snapshot, double deadline);
+
+#endif // AUTOPILOT_H
@@ -0,0 +1,55 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+/*
+ * === BATCH DI PARTITE INDIPENDENTI ===
+ *
+ * Fa girare N partite headless, ognuna con il proprio seme, su un pool di
+ * thread. Ogni worker parte con un blocco contiguo di partite; quando finisce
+ * il suo blocco ruba meta' del lavoro rimasto al worker piu' carico, cosi'
+ * le partite che finiscono presto in game over non lasciano core fermi.
+ */
+
+#include "sim.h"
+
+// Chi muove Pacman nelle partite del batch
+typedef enum {
+    BATCH_INPUT_BOT = 0,    // Bot semplice: segue i corridoi e scappa dai fantasmi
+    BATCH_INPUT_SCRIPT      // Sequenza fissa di direzioni ripetuta in ciclo
+} BatchInputMode;
+
+// Parametri del batch
+typedef struct {
+    long long numGames;         // Numero di partite da giocare
+    int numThreads;             // Numero di worker
+    unsigned int baseSeed;      // Il seme di ogni partita deriva da questo e dall'indice
+    long long maxTicksPerGame;  // Limite di tick per partita (0 = fino al game over)
+    BatchInputMode inputMode;   // Bot o input scriptato
+    int numGhosts;              // Fantasmi per partita (0 = NUM_GHOST)
+    const Maze *maze;           // Labirinto, condiviso in sola lettura da tutti i worker
+} BatchConfig;
+
+// Risultati aggregati del batch
+typedef struct {
+    long long games;        // Partite giocate
+    long long gamesOver;    // Partite terminate per game over (le altre per limite di tick)
+    long long ticks;        // Tick simulati in totale
+    long long totalScore;   // Somma dei punteggi finali
+    int maxScore;           // Punteggio migliore
+    long long steals;       // Furti di lavoro tra worker
+    double seconds;         // Tempo di esecuzione
+} BatchResult;
+
+// Seme della partita numero index (stesso batch => stessi semi)
+unsigned int BatchGameSeed(unsigned int baseSeed, long long index);
+
+// Input del bot per il tick corrente
+SimInput BatchBotInput(const World *w, SimInput previous);
+
+// Input scriptato per il tick corrente
+SimInput BatchScriptInput(const World *w);
+
+// Gioca tutte le partite e riempie result; ritorna 0 se va tutto bene
+int RunBatch(const BatchConfig *config, BatchResult *result);
+
+#endif // BATCH_H
@@ -0,0 +1,154 @@
+#ifndef ENV_H
+#define ENV_H
+
+/*
+ * === AMBIENTE VETTORIALE PER IL REINFORCEMENT LEARNING ===
+ *
+ * N partite (World) avanzano insieme, un passo alla volta, pilotate da fuori
+ * (niente main(), niente finestra): EnvReset le fa ripartire tutte, EnvStep
+ * applica un'azione per partita e scrive osservazioni, ricompense e fine
+ * episodio in buffer del chiamante. Si compila come libreria (make env ->
+ * libpacmanenv.a e libpacmanenv.so) da collegare al programma di training.
+ *
+ * Le osservazioni sono un unico blocco contiguo di byte, scritto direttamente
+ * dalla simulazione (nessuna copia intermedia, nessuna allocazione per passo):
+ *
+ *   obs[env][piano][riga][colonna]   ENV_NUM_PLANES * rows * cols byte per partita
+ *
+ * con i piani nell'ordine di EnvPlane. EnvReset scrive tutto il blocco, muri
+ * compresi; EnvStep riscrive solo le celle cambiate rispetto all'osservazione
+ * precedente di ogni partita (puntini mangiati, celle lasciate e raggiunte da
+ * fantasmi, power-up e Pacman). Il piano dei muri resta quello di EnvReset
+ * per tutti i passi. Per questo obs deve essere sempre lo stesso buffer, da
+ * EnvReset in poi, e il chiamante non deve scriverci: chi vuole tenere
+ * un'osservazione ne fa una copia. Una partita finita (game over o
+ * maxTicks) riparte da sola con un seme nuovo nello stesso EnvStep: il suo
+ * done vale 1 e la sua osservazione e' gia' quella del nuovo episodio
+ * (punteggio e durata di quello finito restano in EnvSlot).
+ *
+ * Con numThreads > 1 le partite sono divise in blocchi contigui tra thread
+ * che restano vivi tra un passo e l'altro (il chiamante lavora come uno di
+ * loro). Ogni partita dipende solo dal proprio seme e dalle proprie azioni,
+ * quindi il risultato non cambia con il numero di thread.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "sim.h"
+
+#define ENV_MAX_ENVS 65536           // Partite al massimo in un ambiente
+#define ENV_MAX_THREADS 64
+#define ENV_MAX_COUNT 255            // Saturazione del piano dei fantasmi
+
+// Piani dell'osservazione (uno per cella)
+typedef enum {
+    ENV_PLANE_WALLS = 0,             // 1 = muro
+    ENV_PLANE_DOTS,                  // 1 = puntino da mangiare
+    ENV_PLANE_GHOSTS,                // Fantasmi nella cella (fino a ENV_MAX_COUNT)
+    ENV_PLANE_POWERUPS,              // PowerUpType del power-up nella cella, 0 = nessuno
+    ENV_PLANE_PACMAN,                // 1 = cella di Pacman
+    ENV_NUM_PLANES
+} EnvPlane;
+
+// Azioni (una per partita e per passo); valori fuori intervallo = ENV_ACTION_NONE
+typedef enum {
+    ENV_ACTION_NONE = 0,
+    ENV_ACTION_RIGHT,
+    ENV_ACTION_LEFT,
+    ENV_ACTION_UP,
+    ENV_ACTION_DOWN,
+    ENV_NUM_ACTIONS
+} EnvAction;
+
+// Parametri dell'ambiente
+typedef struct {
+    const Maze *maze;                // Labirinto di tutte le partite (non copiato, deve restare valido)
+    int numEnvs;                     // Partite (1..ENV_MAX_ENVS)
+    int numGhosts;                   // Fantasmi per partita (0 = NUM_GHOST)
+    int numThreads;                  // Thread che avanzano le partite (0 = 1)
+    int ticksPerStep;                // Tick per passo con la stessa azione (0 = 1)
+    long long maxTicks;              // Tick dopo cui un episodio viene troncato (0 = fino al game over)
+    unsigned int baseSeed;           // Il seme di ogni episodio deriva da questo, dalla partita e dall'episodio
+} EnvConfig;
+
+// Una partita dell'ambiente
+typedef struct {
+    World world;
+    unsigned int episode;            // Episodi iniziati da EnvReset (il primo e' 0)
+    int lastScore;                   // Punteggio e tick dell'ultimo episodio finito
+    unsigned int lastTicks;
+
+    // Cosa mostra la sua osservazione nel buffer del chiamante: il passo dopo
+    // spegne e accende solo le celle che cambiano
+    MapWord *shownDots;              // Bitboard dei puntini (rows * words)
+    int *shownGhosts;                // Cella di ogni fantasma (numGhosts)
+    int shownPowerups[MAX_POWERUPS]; // Cella di ogni power-up, GRID_NONE = nessuno
+    int shownPacman;
+} EnvSlot;
+
+// Passo pubblicato ai thread (puntatori del chiamante)
+typedef struct {
+    const int *actions;
+    unsigned char *obs;
+    float *rewards;
+    unsigned char *dones;
+    bool reset;                      // EnvReset invece di EnvStep
+} EnvJob;
+
+typedef struct PacmanEnv {
+    EnvConfig config;
+    EnvSlot *slots;                  // numEnvs partite
+    int rows, cols;                  // Dimensioni del labirinto (di ogni piano)
+    size_t planeSize;                // rows * cols
+    unsigned char *wallPlane;        // Piano dei muri, uguale per tutte le partite
+    MapWord *shownDots;              // shownDots di tutte le partite (un blocco)
+    int *shownGhosts;                // shownGhosts di tutte le partite (un blocco)
+
+    // Thread (come l'autopilota: generazione pubblicata sotto lock)
+    int numThreads;                  // Thread che lavorano, compreso il chiamante
+    int numWorkers;                  // Thread creati
+    pthread_t *threads;
+    int *firstEnv;                   // Blocco di ogni thread: [firstEnv[t], firstEnv[t + 1])
+    EnvJob job;
+    unsigned int generation;
+    int done;                        // Worker che hanno finito il passo corrente
+    bool stop;
+    bool threadsReady;               // lock e condition variable inizializzati
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t finished;
+
+    // Statistiche da EnvReset
+    long long steps;                 // Passi di una partita (somma su tutte)
+    long long episodes;              // Episodi finiti
+} PacmanEnv;
+
+// Alloca le partite e avvia i thread; false se la configurazione non e'
+// valida o mancano memoria o thread. Le partite partono con EnvReset
+bool EnvCreate(PacmanEnv *env, const EnvConfig *config);
+
+// Ferma i thread e libera tutto
+void EnvDestroy(PacmanEnv *env);
+
+// Byte di osservazione di una partita (obs deve averne numEnvs volte tanti)
+size_t EnvObservationSize(const PacmanEnv *env);
+
+// Fa ripartire tutte le partite dal primo episodio e scrive le osservazioni
+// per intero (muri compresi) in obs
+void EnvReset(PacmanEnv *env, unsigned char *obs);
+
+// Un passo di tutte le partite: actions[numEnvs] in ingresso; osservazioni,
+// ricompense (punti fatti nel passo) e fine episodio (0/1) in uscita.
+// obs e' lo stesso buffer di EnvReset (aggiornato, non riscritto);
+// rewards e dones possono essere NULL
+void EnvStep(PacmanEnv *env, const int *actions, unsigned char *obs, float *rewards, unsigned char *dones);
+
+// Scrive per intero l'osservazione di un World (ENV_NUM_PLANES piani) in obs
+void EnvObserve(const PacmanEnv *env, const World *w, unsigned char *obs);
+
+// Aggiorna obs, l'osservazione della partita index scritta al passo precedente,
+// allo stato attuale del suo World (quello che fa EnvStep dopo i tick)
+void EnvUpdateObservation(PacmanEnv *env, int index, unsigned char *obs);
+
+#endif // ENV_H
@@ -0,0 +1,53 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+/*
+ * === FLOW FIELD VERSO PACMAN ===
+ *
+ * Una BFS sulla mappa a partire dalla cella di Pacman calcola, per ogni cella
+ * libera, la distanza nel labirinto e la direzione del primo passo verso Pacman.
+ * Il campo viene ricalcolato solo quando Pacman entra in una nuova cella; la
+ * scelta della direzione di un fantasma diventa una sola lettura dalla tabella.
+ *
+ * Sui labirinti da HPA_MIN_CELLS celle in su la BFS completa e' troppo cara: il
+ * campo si calcola a livelli (vedi hpa.h) e solo nei cluster dove ci sono
+ * fantasmi. In quel caso flowDir e' valido solo li' e flowDist e flowQueue non
+ * esistono (NULL): le distanze le tiene il planner, cluster per cluster.
+ */
+
+#include "sim.h"
+
+// Direzioni codificate nel campo (stesso ordine di flowDirections)
+#define FLOW_RIGHT 0
+#define FLOW_LEFT  1
+#define FLOW_DOWN  2
+#define FLOW_UP    3
+#define FLOW_NONE  0xFF   // Cella di Pacman, muro o cella irraggiungibile
+
+#define FLOW_UNREACHABLE 0xFFFFFFFFu  // Distanza delle celle non raggiungibili
+
+// Vettori unitari corrispondenti a FLOW_RIGHT..FLOW_UP
+extern const Vector2 flowDirections[4];
+
+// Byte di arena che servono ad AllocFlowField per una mappa rows x cols
+size_t FlowFieldMemorySize(int rows, int cols);
+
+// Prende dall'arena di w distanze, direzioni e coda della BFS per la sua mappa
+// (in SimCreate); sui labirinti grandi solo le direzioni, piu' il planner HPA che
+// sta fuori dall'arena perche' la sua dimensione si sa solo dopo averlo costruito
+bool AllocFlowField(World *w);
+
+// Libera il planner HPA (il resto del campo e' dell'arena)
+void FreeFlowField(World *w);
+
+// Ricalcola il campo se Pacman ha cambiato cella (o se e' stato invalidato); con
+// la gerarchia completa anche le celle dei fantasmi entrati in cluster nuovi
+void UpdateFlowField(World *w);
+
+// Forza il ricalcolo al prossimo UpdateFlowField (es. dopo un cambio di mappa)
+void InvalidateFlowField(World *w);
+
+// Direzione del primo passo verso Pacman dalla cella indicata (FLOW_NONE se non c'e')
+unsigned char GetFlowDirection(const World *w, int row, int col);
+
+#endif // FLOWFIELD_H
@@ -0,0 +1,71 @@
+#ifndef GHOSTPOOL_H
+#define GHOSTPOOL_H
+
+/*
+ * === POOL DI THREAD PER I FANTASMI ===
+ *
+ * Dentro un tick ogni fantasma legge solo il grafo degli incroci e il flow field e scrive
+ * solo i propri elementi dello sciame, quindi StepGhostRange puo' girare su
+ * pezzi diversi dello sciame in parallelo. Il pool tiene i thread vivi per
+ * tutta la partita (niente pthread_create a ogni tick):
+ *
+ *   - il thread chiamante divide lo sciame in blocchi (piu' blocchi che
+ *     thread, multipli di GHOST_POOL_CHUNK_ALIGN fantasmi) e pubblica il
+ *     lavoro con una sola scrittura atomica;
+ *   - tutti, chiamante compreso, prendono il prossimo blocco libero con una
+ *     compare-and-swap finche' ce ne sono: chi finisce prima ne prende altri,
+ *     nessuna barriera tra i thread;
+ *   - il chiamante aspetta solo che l'ultimo blocco sia finito.
+ *
+ * I kernel fanno le stesse operazioni su ogni fantasma comunque sia diviso
+ * lo sciame, quindi il risultato e' identico bit per bit a quello seriale.
+ * Tra un tick e l'altro i worker girano a vuoto per poco e poi dormono.
+ */
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "ghosts.h"
+
+#define GHOST_POOL_MAX_THREADS 64
+#define GHOST_POOL_MIN_GHOSTS 8192        // Sotto questa soglia svegliare i worker costa piu' di quanto fanno risparmiare
+#define GHOST_POOL_CHUNK_ALIGN 16         // 64 byte per array: due thread non scrivono mai la stessa cache line
+#define GHOST_POOL_CHUNKS_PER_THREAD 4    // Blocchi per thread: bilancia il lavoro se un core rallenta
+#define GHOST_POOL_SPIN 2000              // Attese attive prima di dormire (worker) o di cedere il core (chiamante)
+
+typedef struct GhostPool {
+    int numThreads;                 // Thread che lavorano, compreso il chiamante
+    int numWorkers;                 // Thread creati (numThreads - 1 se tutto va bene)
+    pthread_t *threads;
+
+    // Lavoro pubblicato (scritto dal chiamante prima del cursore, letto dopo aver preso un blocco)
+    GhostSwarm *swarm;
+    GhostStepParams params;
+    int chunkSize;
+    unsigned int generation;        // Lavori pubblicati (solo il chiamante)
+
+    // Cursore: generazione << 32 | blocchi << 16 | prossimo blocco, in una cache line sua
+    char pad0[64];
+    unsigned long long cursor;
+    char pad1[64 - sizeof(unsigned long long)];
+    int done;                       // Blocchi finiti della generazione corrente
+    char pad2[64 - sizeof(int)];
+
+    // Worker addormentati
+    int sleepers;
+    bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} GhostPool;
+
+// Avvia numThreads - 1 worker (il chiamante e' il thread in piu'); con numThreads
+// 1 non crea thread. false se numThreads non e' valido o i thread non partono
+bool InitGhostPool(GhostPool *pool, int numThreads);
+
+// Ferma e aspetta i worker
+void FreeGhostPool(GhostPool *pool);
+
+// Come StepGhostRange sull'intero sciame, diviso tra i thread del pool; pool
+// NULL o sciame sotto GHOST_POOL_MIN_GHOSTS = tutto sul thread chiamante
+void GhostPoolStep(GhostPool *pool, GhostSwarm *swarm, const GhostStepParams *params);
+
+#endif // GHOSTPOOL_H
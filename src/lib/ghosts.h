@@ -0,0 +1,75 @@
+#ifndef GHOSTS_H
+#define GHOSTS_H
+
+/*
+ * === SCIAME DI FANTASMI (STRUCTURE OF ARRAYS) ===
+ *
+ * I fantasmi viaggiano sugli archi del grafo degli incroci (vedi junction.h):
+ * lo stato di ognuno e' l'arco che sta percorrendo e la distanza gia' fatta.
+ * A ogni tick la distanza cresce della velocita'; solo quando supera il
+ * prossimo evento (confine di cella o arrivo su un nodo) il fantasma "si
+ * sveglia": cambia cella nella griglia o, sul nodo, sceglie l'arco successivo
+ * con il flow field. Il resto del passo prosegue sul nuovo arco, quindi una
+ * velocita' non intera (es. 1.5 pixel per tick) non fa mai saltare un incrocio.
+ * La posizione in pixel si calcola solo quando serve (SimGhostPos).
+ *
+ * Gli array sono separati e allineati a 32 byte: il passo e il confronto con
+ * il prossimo evento girano su piu' fantasmi per istruzione. StepGhostRange usa
+ * il kernel migliore disponibile (AVX2 a 8 corsie, SSE4.1 a 4 corsie, oppure
+ * scalare); tutti fanno le stesse operazioni in virgola mobile, quindi il
+ * risultato e' identico bit per bit qualunque sia il kernel scelto.
+ */
+
+#include <stdbool.h>
+#include "map.h"
+#include "junction.h"
+#include "arena.h"
+
+typedef struct {
+    int count;                 // Fantasmi in gioco
+    int capacity;              // Fantasmi per cui c'e' spazio negli array
+    float *offset;             // Pixel gia' percorsi sull'arco
+    float *nextEvent;          // Valore di offset del prossimo evento (confine di cella o nodo)
+    float *speed;              // Velocita' base (pixel per tick)
+    int *edge;                 // Arco percorso (JUNCTION_NONE = fermo, cella senza uscite)
+    int *cell;                 // Cella della mappa (MapCell) in cui si trova, aggiornata dal kernel
+    int *target;               // Cella del nodo dove prendera' la prossima decisione
+    int *startCell;            // Cella di partenza
+} GhostSwarm;
+
+// Dati letti dal kernel durante un tick
+typedef struct {
+    const unsigned char *flowDir;  // Flow field verso Pacman, rows * cols byte (vedi flowfield.h)
+    const JunctionGraph *graph;    // Archi e nodi del labirinto
+    float speedMultiplier;         // Moltiplicatore dei power-up (es. SLOW_GHOSTS)
+} GhostStepParams;
+
+// Kernel disponibili per il movimento
+typedef enum {
+    GHOST_KERNEL_AUTO = 0,     // Il migliore supportato dalla CPU
+    GHOST_KERNEL_SCALAR,
+    GHOST_KERNEL_SSE41,
+    GHOST_KERNEL_AVX2
+} GhostKernel;
+
+// Byte di arena che servono ad AllocGhostSwarm per capacity fantasmi
+size_t GhostSwarmMemorySize(int capacity);
+
+// Prende dall'arena gli array (azzerati) per capacity fantasmi; false se manca spazio
+bool AllocGhostSwarm(GhostSwarm *swarm, int capacity, Arena *arena);
+
+// Sceglie il kernel (ritorna false se la CPU non lo supporta; resta quello precedente).
+// Va chiamata prima di avviare i thread che muovono fantasmi
+bool SetGhostKernel(GhostKernel kernel);
+
+// Kernel effettivamente in uso
+GhostKernel GetGhostKernel(void);
+
+// Nome leggibile di un kernel
+const char *GetGhostKernelName(GhostKernel kernel);
+
+// Muove i fantasmi [begin, end) e gestisce i loro eventi (cambi di cella e
+// decisioni sui nodi); edge, cell e nextEvent devono essere gia' validi
+void StepGhostRange(GhostSwarm *swarm, const GhostStepParams *params, int begin, int end);
+
+#endif // GHOSTS_H
@@ -0,0 +1,63 @@
+#ifndef GRID_H
+#define GRID_H
+
+/*
+ * === GRIGLIA UNIFORME DI OCCUPAZIONE (BROADPHASE) ===
+ *
+ * Una lista per ogni cella della mappa con gli oggetti (fantasmi, power-up)
+ * che ci si trovano. Le liste sono doppiamente concatenate dentro array
+ * indicizzati dall'id dell'oggetto, quindi spostare un oggetto da una cella
+ * all'altra costa O(1) e non si alloca nulla durante il gioco.
+ *
+ * Le collisioni guardano solo la cella di Pacman e le otto vicine: il costo
+ * dipende da quanti oggetti ci sono li' intorno, non dal totale.
+ */
+
+#include <stdbool.h>
+#include "map.h"
+#include "arena.h"
+
+#define GRID_NONE (-1)   // Nessun oggetto / oggetto fuori dalla griglia
+
+typedef struct {
+    int *head;             // Primo oggetto di ogni cella (rows * cols), o GRID_NONE
+    int *next, *prev;      // Collegamenti della lista della cella, per oggetto
+    int *cell;             // Cella in cui si trova ogni oggetto, o GRID_NONE
+    int capacity;          // Numero massimo di oggetti (id da 0 a capacity - 1)
+    int rows, cols;        // Dimensioni della mappa coperta
+} SpatialGrid;
+
+// Byte di arena che servono ad AllocSpatialGrid
+size_t SpatialGridMemorySize(int capacity, int rows, int cols);
+
+// Prende dall'arena le liste di una mappa rows x cols e i collegamenti per capacity oggetti
+bool AllocSpatialGrid(SpatialGrid *grid, int capacity, int rows, int cols, Arena *arena);
+
+// Toglie tutti gli oggetti dalla griglia (costa quanto gli oggetti, non quanto le celle)
+void ClearSpatialGrid(SpatialGrid *grid);
+
+// Cella (MapCell) che contiene il punto in pixel, o GRID_NONE se e' fuori dalla mappa
+int GridCellOfPoint(const MapBits *map, float x, float y);
+
+// Stacca l'oggetto id dalla sua lista e lo mette in quella di cell (vedi GridMove)
+void GridRelink(SpatialGrid *grid, int id, int cell);
+
+// Sposta l'oggetto id nella cella indicata (GRID_NONE = toglie l'oggetto);
+// se la cella non cambia non tocca le liste
+static inline void GridMove(SpatialGrid *grid, int id, int cell)
+{
+    if (grid->cell[id] != cell)
+        GridRelink(grid, id, cell);
+}
+
+// Raccoglie gli id degli oggetti nelle celle entro radius celle da (row, col)
+// (radius 1 = la cella e le otto vicine); ritorna quanti ne ha trovati, al massimo maxOut
+int GridQuery(const SpatialGrid *grid, int row, int col, int radius, int *out, int maxOut);
+
+// Toglie l'oggetto id dalla griglia
+static inline void GridRemove(SpatialGrid *grid, int id)
+{
+    GridMove(grid, id, GRID_NONE);
+}
+
+#endif // GRID_H
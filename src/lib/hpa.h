@@ -0,0 +1,117 @@
+#ifndef HPA_H
+#define HPA_H
+
+/*
+ * === PERCORSI GERARCHICI (HPA*) SUI LABIRINTI GRANDI ===
+ *
+ * Su un labirinto di milioni di celle la BFS completa del flow field (vedi
+ * flowfield.h) costa decine di millisecondi a ogni passo di Pacman. Sopra
+ * HPA_MIN_CELLS il campo si calcola invece su due livelli:
+ *
+ *   - all'avvio la mappa viene divisa in cluster di HPA_CLUSTER_SIZE x
+ *     HPA_CLUSTER_SIZE celle. Ogni tratto di bordo aperto tra due cluster e'
+ *     un ingresso con una cella di transizione per lato (due agli estremi se
+ *     il tratto e' lungo). Le transizioni sono i nodi del grafo astratto; gli
+ *     archi collegano le transizioni dello stesso cluster (distanza dentro il
+ *     cluster, con una BFS locale) e le due meta' di ogni ingresso (costo 1);
+ *   - le distanze astratte partono dall'ancora della zona di Pacman: la cella
+ *     piu' vicina al centro del suo cluster tra quelle raggiungibili da lui
+ *     senza uscirne. Finche' Pacman si muove in quella zona l'ancora non cambia
+ *     e la ricerca sul grafo astratto (un Dijkstra ripreso da dove si era
+ *     fermato) resta buona: si riparte solo quando Pacman entra in un altro cluster;
+ *   - a ogni tick si risolvono solo i cluster dove i fantasmi prenderanno la
+ *     prossima decisione (il nodo di arrivo del loro arco), dal grosso al fine:
+ *     la ricerca fissa le distanze dei nodi attorno al cluster, poi una BFS
+ *     locale seminata da quei nodi scrive la direzione verso l'ancora di tutte
+ *     le celle del cluster in flowDir;
+ *   - nel blocco di cluster attorno a quello di Pacman (HPA_NEAR_RADIUS per
+ *     lato) il campo e' esatto: una BFS sulle celle del blocco, rifatta a ogni
+ *     passo di Pacman, porta dritto a lui. Solo queste celle cambiano quando
+ *     Pacman si sposta nella sua zona. Le altre celle portano all'ancora, che
+ *     la BFS raggiunge: chi le segue entra prima o poi nella BFS e non ne esce.
+ *
+ * Il kernel dei fantasmi non cambia: legge flowDir come con il campo completo.
+ * L'ancora e il blocco dipendono solo dalla cella di Pacman, le distanze dei
+ * nodi sono esatte sul grafo astratto e le BFS hanno un ordine fisso, quindi la
+ * direzione di ogni cella dipende solo dai muri e dalla cella di Pacman, non
+ * dall'ordine in cui i cluster vengono risolti: replay e rewind restano
+ * deterministici. I percorsi passano solo per le transizioni e lontano da
+ * Pacman puntano all'ancora, quindi possono essere un po' piu' lunghi del
+ * minimo (come in ogni HPA*).
+ */
+
+#include <stdbool.h>
+#include "map.h"
+#include "ghosts.h"
+
+#define HPA_CLUSTER_SHIFT 4
+#define HPA_CLUSTER_SIZE (1 << HPA_CLUSTER_SHIFT)  // Lato di un cluster in celle
+#define HPA_MIN_CELLS (512 * 512)                  // Labirinti piu' piccoli: BFS completa, costa poco
+#define HPA_LONG_ENTRANCE 6                        // Ingressi da qui in su: due transizioni invece di una
+#define HPA_NEAR_RADIUS 1                          // Cluster per lato attorno a Pacman con il campo esatto
+#define HPA_NEAR_SIZE ((2 * HPA_NEAR_RADIUS + 1) * HPA_CLUSTER_SIZE)  // Lato del blocco in celle
+
+// Stato di un nodo nella ricerca dall'ancora: tutto vicino, un accesso in memoria per arco
+typedef struct {
+    unsigned int dist;              // Distanza dall'ancora, valida se distEpoch == epoch
+    unsigned int distEpoch;
+    unsigned int closedEpoch;       // Distanza definitiva
+    unsigned int requiredStamp;     // Nodo che la ricerca in corso deve chiudere
+    int heapPos;                    // Posto nell'heap, -1 = fuori
+} HpaNodeState;
+
+typedef struct HpaPlanner {
+    int rows, cols;
+    int clusterRows, clusterCols, numClusters;
+
+    // === GRAFO ASTRATTO (costruito una volta, dipende solo dai muri) ===
+    int numNodes;
+    int *nodePos;                   // Cella di transizione: row << 16 | col
+    int *clusterFirstNode;          // Nodi del cluster k: [clusterFirstNode[k], clusterFirstNode[k + 1])
+    int numEdges;
+    int *edgeFirst;                 // Archi del nodo n: [edgeFirst[n], edgeFirst[n + 1])
+    int *edgeTarget;
+    unsigned short *edgeCost;       // Distanza in celle (1 per gli archi tra cluster)
+
+    // === RICERCA DALL'ANCORA (ricominciata quando cambia l'ancora) ===
+    unsigned int epoch;
+    int targetRow, targetCol;       // Cella di Pacman
+    int anchorRow, anchorCol;       // Ancora della zona di Pacman (-1 = Pacman in un muro)
+    HpaNodeState *nodes;            // Una voce per nodo
+    int *heap, heapSize;            // Heap binario dei nodi aperti (indicizzato da heapPos)
+    unsigned int requiredId;
+
+    // === CAMPO ESATTO ATTORNO A PACMAN (rifatto a ogni sua cella) ===
+    int nearRow0, nearCol0;         // Angolo del blocco di cluster attorno a Pacman
+    int nearRows, nearCols;         // Dimensioni del blocco (piu' piccolo sul bordo della mappa)
+    unsigned char *nearDir;         // HPA_NEAR_SIZE x HPA_NEAR_SIZE direzioni verso Pacman
+    int *nearQueue;
+
+    // === CAMPO FINE PER CLUSTER ===
+    unsigned int *clusterEpoch;     // flowDir del cluster valido per questa epoch
+    unsigned int *clusterRequest;   // Cluster gia' messo in lista in questo tick
+    unsigned int requestId;
+    int *requested;                 // Cluster da risolvere in questo tick
+
+    // Spazio per le BFS locali (un cluster)
+    unsigned int *localDist;
+    unsigned char *localDir;
+    unsigned char *localOpen;
+    int *localQueue;
+} HpaPlanner;
+
+// Costruisce il grafo astratto dei muri di map; false se manca memoria
+bool InitHpaPlanner(HpaPlanner *hpa, const MapBits *map);
+
+// Libera grafo e spazio di lavoro
+void FreeHpaPlanner(HpaPlanner *hpa);
+
+// Pacman e' nella cella (row, col): da rifare i campi fini attorno a lui, o tutti
+// se e' entrato in un altro cluster (nuova ancora)
+void HpaSetTarget(HpaPlanner *hpa, const MapBits *map, int row, int col);
+
+// Scrive in flowDir la direzione verso Pacman di tutte le celle dei cluster che
+// contengono il target dei fantasmi (solo quelli non ancora risolti per questa cella di Pacman)
+void HpaUpdateGhostCells(HpaPlanner *hpa, const MapBits *map, const GhostSwarm *ghosts, unsigned char *flowDir);
+
+#endif // HPA_H
@@ -0,0 +1,53 @@
+#ifndef HUD_H
+#define HUD_H
+#include "../utils/raylib/src/raylib.h"
+#include "common.h"
+#include "profiler.h"
+
+/*
+ * === CACHE DEL TESTO DELL'INTERFACCIA ===
+ *
+ * Un TextLabel tiene il testo gia' formattato, la sua larghezza e una texture
+ * con il testo gia' disegnato. Il testo viene riformattato, rimisurato e
+ * ridisegnato solo quando il valore cambia; negli altri frame disegnare
+ * l'etichetta costa un solo DrawTextureRec.
+ */
+
+#define TEXT_LABEL_MAX 64
+
+typedef struct {
+    const char *format;          // Formato con al piu' un %d (o testo fisso)
+    int fontSize;
+    Color color;
+    int value;                   // Valore attualmente mostrato
+    bool hasValue;               // false finche' non viene impostato il primo valore
+    char text[TEXT_LABEL_MAX];   // Testo formattato
+    int width;                   // Larghezza del testo in pixel (MeasureText)
+    RenderTexture2D texture;     // Testo pre-disegnato
+    bool loaded;
+} TextLabel;
+
+// Prepara un'etichetta; per il testo fisso basta un formato senza %d
+void LoadTextLabel(TextLabel *label, const char *format, int fontSize, Color color);
+
+// Aggiorna il valore; riformatta e ridisegna solo se e' cambiato
+void SetTextLabelValue(TextLabel *label, int value);
+
+// Disegna l'etichetta con l'angolo in alto a sinistra in (x, y)
+void DrawTextLabel(const TextLabel *label, int x, int y);
+
+// Libera la texture dell'etichetta
+void UnloadTextLabel(TextLabel *label);
+
+/*
+ * === OVERLAY DEI TEMPI DEI FRAME ===
+ *
+ * Pannello con media, p95 e p99 di ogni fase sugli ultimi PROFILE_FRAMES
+ * frame e il grafico del tempo dei frame (linee a 16.7 e 33.3 ms). Si vede
+ * solo quando serve (F3), quindi il testo e' formattato a ogni frame.
+ */
+
+// Disegna l'overlay con l'angolo in alto a sinistra in (x, y)
+void DrawProfilerOverlay(FrameProfiler *profiler, int x, int y);
+
+#endif // HUD_H
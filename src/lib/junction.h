@@ -0,0 +1,62 @@
+#ifndef JUNCTION_H
+#define JUNCTION_H
+
+/*
+ * === GRAFO DEGLI INCROCI ===
+ *
+ * Il labirinto compilato in un grafo: i nodi sono le celle libere dove
+ * un'entita' puo' dover cambiare direzione (incroci, curve, vicoli ciechi), gli
+ * archi sono i corridoi dritti tra due nodi. Ogni arco va in una sola
+ * direzione, quindi la posizione di chi lo percorre e' la cella di partenza
+ * piu' la distanza percorsa: niente test dei muri, niente ricerca del centro
+ * della cella a ogni tick. Le decisioni si prendono solo all'arrivo su un nodo.
+ *
+ * Il grafo dipende solo dai muri: si costruisce una volta per labirinto (in
+ * SimCreate, nell'arena del World) e non cambia durante la partita.
+ */
+
+#include <stdbool.h>
+#include "map.h"
+#include "arena.h"
+
+#define JUNCTION_NONE (-1)   // Nessun arco in quella direzione / nessun nodo
+
+// Corridoio dritto da un nodo al successivo; direzioni nell'ordine di FLOW_RIGHT..FLOW_UP (vedi flowfield.h)
+typedef struct {
+    int fromCell;            // Nodo di partenza (MapCell)
+    int fromRow, fromCol;
+    int toNode;              // Nodo di arrivo (indice in nodes)
+    int toCell;              // Cella del nodo di arrivo (MapCell), per non leggere nodes
+    int length;              // Celle da percorrere (almeno 1)
+    unsigned char dir;       // Direzione dell'arco
+    signed char dx, dy;      // Vettore unitario della direzione
+} JunctionEdge;
+
+typedef struct {
+    int cell;                // MapCell del nodo
+    int edges[4];            // Arco che parte in ogni direzione, JUNCTION_NONE se c'e' un muro
+} JunctionNode;
+
+typedef struct {
+    JunctionNode *nodes;     // In ordine di cella
+    int numNodes;
+    JunctionEdge *edges;
+    int numEdges;
+    int cellStep[4];         // Differenza di MapCell per un passo in ogni direzione
+} JunctionGraph;
+
+// Byte di arena che servono a BuildJunctionGraph per i muri di map
+size_t JunctionGraphMemorySize(const MapBits *map);
+
+// Costruisce il grafo dei muri di map con la memoria dell'arena; false se manca spazio
+bool BuildJunctionGraph(JunctionGraph *graph, const MapBits *map, Arena *arena);
+
+// Nodo della cella, JUNCTION_NONE se e' un muro o un tratto di corridoio dritto
+int JunctionNodeOfCell(const JunctionGraph *graph, int cell);
+
+// Mette un'entita' sulla cella libera cell diretta verso dir (o la prima direzione
+// possibile dopo dir): arco da percorrere e celle gia' percorse su di esso.
+// false se la cella non ha uscite (edge = JUNCTION_NONE)
+bool JunctionPlace(const JunctionGraph *graph, const MapBits *map, int cell, int dir, int *edge, int *cellsDone);
+
+#endif // JUNCTION_H
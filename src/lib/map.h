@@ -0,0 +1,213 @@
+#ifndef MAP_H
+#define MAP_H
+
+/*
+ * === MAPPA A BITBOARD ===
+ *
+ * Ogni riga della mappa e' una sequenza di parole a 64 bit: il bit (c % 64)
+ * della parola (c / 64) indica la colonna c. Muri e puntini sono due bitboard
+ * separate, le celle libere si ricavano come (non muro) & (non puntino). Le
+ * colonne oltre l'ultima dell'ultima parola contano come muro. Il numero di
+ * puntini rimasti e' mantenuto ad ogni puntino mangiato, quindi "livello
+ * completato" e "ci sono puntini in questa zona?" costano una popcount per
+ * parola invece di una scansione di caratteri.
+ *
+ * Accanto alle bitboard c'e' un indice denso delle celle libere su cui puo'
+ * comparire un power-up: un array compatto di celle piu' la posizione di ogni
+ * cella nell'array, cosi' aggiunta, rimozione ed estrazione uniforme sono O(1).
+ *
+ * === LABIRINTI DA FILE ===
+ *
+ * Il labirinto (Maze) e' letto da un file di testo a runtime, con le
+ * dimensioni prese dal file stesso:
+ *
+ *   15 10              <- colonne e righe
+ *   ###############    <- una riga di testo per riga del labirinto
+ *   #P............#
+ *   ...
+ *
+ * '#' muro, '.' puntino, ' ' corridoio vuoto, 'P' partenza di Pacman,
+ * '1'..'9' partenze dei primi fantasmi (in quest'ordine). Le celle di
+ * partenza hanno un puntino come il resto del corridoio. Righe corte e righe
+ * mancanti sono completate con muri.
+ *
+ * Il Maze non cambia durante la partita e puo' essere condiviso da piu'
+ * World; ogni World ha il suo MapBits (puntini e celle libere del livello in
+ * corso), allocato una volta e rimesso a nuovo a ogni livello con MapReset.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "arena.h"
+
+#define MAP_MAX_SIZE 4096          // Righe e colonne massime di un labirinto
+#define MAZE_MAX_GHOST_STARTS 9    // Partenze '1'..'9'
+#define MAP_NO_SLOT (-1)           // La cella non e' nell'indice delle celle libere
+
+typedef unsigned long long MapWord;   // 64 colonne di una riga
+
+// === LABIRINTO LETTO DA FILE ===
+typedef struct {
+    int rows, cols;                // Dimensioni in celle
+    int words;                     // Parole per riga: (cols + 63) / 64
+    MapWord *walls;                // rows * words: 1 = muro
+    MapWord *dots;                 // rows * words: puntini all'inizio di ogni livello
+    int pacmanStart;               // Cella di partenza di Pacman
+    int ghostStarts[MAZE_MAX_GHOST_STARTS]; // Celle di partenza dei primi fantasmi
+    int numGhostStarts;
+    unsigned long long hash;       // Impronta del contenuto (registrazioni, snapshot)
+} Maze;
+
+// Legge un labirinto da file (mappato in memoria, letto in una sola passata);
+// ritorna false se il file non esiste o non e' valido
+bool MazeLoadFile(Maze *maze, const char *path);
+
+// Come MazeLoadFile, da un testo gia' in memoria (size byte, non serve lo '\0')
+bool MazeParse(Maze *maze, const char *text, size_t size);
+
+// Scrive il labirinto in un file di testo (formato sopra); false in caso di errore
+bool MazeSaveFile(const Maze *maze, const char *path);
+
+// Alloca un labirinto rows x cols tutto muro, senza puntini ne' partenze
+// (per chi lo costruisce a mano, es. il generatore in mazegen.h)
+bool MazeAlloc(Maze *maze, int rows, int cols);
+
+// Impronta del contenuto (dimensioni, muri, puntini, partenze): va in maze->hash
+unsigned long long MazeHash(const Maze *maze);
+
+// Libera la memoria del labirinto
+void MazeFree(Maze *maze);
+
+// === STATO DELLA MAPPA DURANTE UN LIVELLO ===
+typedef struct {
+    int rows, cols, words;         // Copiati dal labirinto (letti a ogni tick)
+    const MapWord *walls;          // Muri del labirinto (non cambiano durante la partita)
+    MapWord *dots;                 // 1 = puntino ancora da mangiare
+    int dotsLeft;                  // Popcount di dots, aggiornato a ogni puntino mangiato
+
+    // Indice denso delle celle libere (niente muro, puntino o power-up)
+    int *freeCells;                // Le prime numFreeCells voci sono celle libere
+    int *freeSlot;                 // Posizione di ogni cella in freeCells, o MAP_NO_SLOT
+    int numFreeCells;
+    int numOpenCells;              // Celle senza muro: le celle libere non sono mai di piu'
+} MapBits;
+
+// Byte di arena che servono a MapAlloc per il labirinto
+size_t MapMemorySize(const Maze *maze);
+
+// Prende dall'arena lo stato per le dimensioni del labirinto (una volta sola,
+// vedi MapReset); la memoria resta dell'arena
+bool MapAlloc(MapBits *map, const Maze *maze, Arena *arena);
+
+// Solo dimensioni e muri del labirinto, senza puntini: basta per MapIsWall
+// (es. per contare cosa allocare prima di MapAlloc)
+static inline MapBits MapWallsOf(const Maze *maze)
+{
+    MapBits map = {0};
+    map.rows = maze->rows;
+    map.cols = maze->cols;
+    map.words = maze->words;
+    map.walls = maze->walls;
+    return map;
+}
+
+// Rimette i puntini del labirinto e ricostruisce l'indice delle celle libere
+void MapReset(MapBits *map, const Maze *maze);
+
+// Numero di puntini nel rettangolo di celle [row0..row1] x [col0..col1] (estremi inclusi)
+int MapCountDotsInRegion(const MapBits *map, int row0, int col0, int row1, int col1);
+
+static inline bool MapInBounds(const MapBits *map, int row, int col)
+{
+    return row >= 0 && row < map->rows && col >= 0 && col < map->cols;
+}
+
+// Indice di cella (row * cols + col) e viceversa
+static inline int MapCell(const MapBits *map, int row, int col)
+{
+    return row * map->cols + col;
+}
+
+static inline int MapCellRow(const MapBits *map, int cell)
+{
+    return cell / map->cols;
+}
+
+static inline int MapCellCol(const MapBits *map, int cell)
+{
+    return cell % map->cols;
+}
+
+// Parola della bitboard che contiene la colonna col della riga row
+static inline int MapWordIndex(const MapBits *map, int row, int col)
+{
+    return row * map->words + (col >> 6);
+}
+
+// Aggiunge una cella all'indice delle celle libere (se non c'e' gia')
+static inline void MapAddFreeCell(MapBits *map, int cell)
+{
+    if (map->freeSlot[cell] != MAP_NO_SLOT)
+        return;
+    map->freeSlot[cell] = map->numFreeCells;
+    map->freeCells[map->numFreeCells++] = cell;
+}
+
+// Toglie una cella dall'indice: l'ultima voce prende il suo posto
+static inline void MapRemoveFreeCell(MapBits *map, int cell)
+{
+    int slot = map->freeSlot[cell];
+    if (slot == MAP_NO_SLOT)
+        return;
+    int last = map->freeCells[--map->numFreeCells];
+    map->freeCells[slot] = last;
+    map->freeSlot[last] = slot;
+    map->freeSlot[cell] = MAP_NO_SLOT;
+}
+
+// Fuori dalla mappa conta come muro
+static inline bool MapIsWall(const MapBits *map, int row, int col)
+{
+    if (!MapInBounds(map, row, col))
+        return true;
+    return (map->walls[MapWordIndex(map, row, col)] >> (col & 63)) & 1ull;
+}
+
+static inline bool MapHasDot(const MapBits *map, int row, int col)
+{
+    if (!MapInBounds(map, row, col))
+        return false;
+    return (map->dots[MapWordIndex(map, row, col)] >> (col & 63)) & 1ull;
+}
+
+// Bitboard delle celle libere (niente muro, niente puntino) della parola index
+static inline MapWord MapFreeWord(const MapBits *map, int index)
+{
+    return ~(map->walls[index] | map->dots[index]);
+}
+
+static inline bool MapIsFree(const MapBits *map, int row, int col)
+{
+    if (!MapInBounds(map, row, col))
+        return false;
+    return (MapFreeWord(map, MapWordIndex(map, row, col)) >> (col & 63)) & 1ull;
+}
+
+// Mangia il puntino della cella, se c'e'; ritorna true se e' stato mangiato
+static inline bool MapEatDot(MapBits *map, int row, int col)
+{
+    if (!MapHasDot(map, row, col))
+        return false;
+    map->dots[MapWordIndex(map, row, col)] &= ~(1ull << (col & 63));
+    map->dotsLeft--;
+    MapAddFreeCell(map, MapCell(map, row, col));  // Ora ci puo' comparire un power-up
+    return true;
+}
+
+// Livello completato quando non restano puntini
+static inline bool MapIsCleared(const MapBits *map)
+{
+    return map->dotsLeft == 0;
+}
+
+#endif // MAP_H
@@ -0,0 +1,39 @@
+#ifndef MAZEGEN_H
+#define MAZEGEN_H
+
+/*
+ * === GENERATORE DI LABIRINTI ===
+ *
+ * Costruisce un labirinto in stile Pacman di qualsiasi dimensione a partire
+ * da un seme: stesso seme e stesse dimensioni danno sempre lo stesso
+ * labirinto (e quindi lo stesso Maze.hash, le registrazioni restano valide).
+ *
+ * Le celle con riga e colonna dispari formano un reticolo di incroci; tra
+ * due incroci vicini c'e' una cella che puo' essere muro o corridoio.
+ *
+ *   1. un albero ricoprente del reticolo (sidewinder, una riga alla volta):
+ *      tutto il labirinto e' collegato;
+ *   2. una parte dei muri rimasti viene aperta a caso, a 64 celle per volta
+ *      sulle bitboard: nascono i giri chiusi;
+ *   3. i vicoli ciechi vengono aperti verso un vicino, come nei labirinti
+ *      di Pacman dove ogni corridoio porta da qualche parte.
+ *
+ * Ogni corridoio ha un puntino. Pacman parte dall'incrocio piu' vicino al
+ * centro, i fantasmi dagli incroci dei quattro angoli, lontani da lui.
+ * Il bordo esterno e' sempre muro; con dimensioni pari l'ultima riga o
+ * colonna interna resta muro.
+ */
+
+#include <stdbool.h>
+#include "map.h"
+
+#define MAZE_GEN_MIN_SIZE 7   // Almeno 3x3 incroci: Pacman e i quattro angoli sono celle diverse
+
+// Genera un labirinto cols x rows (tra MAZE_GEN_MIN_SIZE e MAP_MAX_SIZE);
+// false se le dimensioni non sono valide o manca la memoria
+bool MazeGenerate(Maze *maze, int cols, int rows, unsigned int seed);
+
+// Legge "COLONNExRIGHE" (es. "4096x4096"); false se il testo non e' in quel formato
+bool MazeParseSize(const char *text, int *cols, int *rows);
+
+#endif // MAZEGEN_H
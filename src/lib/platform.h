@@ -0,0 +1,55 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+/*
+ * === DIFFERENZE TRA PIATTAFORME ===
+ *
+ * Le poche chiamate che non sono uguali su Linux/macOS e su Windows (MinGW).
+ * I thread usano pthread ovunque: su MinGW vengono da winpthreads (-lpthread),
+ * che porta anche clock_gettime, nanosleep e sched_yield.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <pthread.h>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#else
+#include <unistd.h>
+#endif
+
+// size byte allineati ad align (potenza di due, multiplo di sizeof(void *));
+// NULL se manca memoria. Si liberano solo con AlignedFree
+static inline void *AlignedAlloc(size_t align, size_t size)
+{
+#if defined(_WIN32)
+    return _aligned_malloc(size, align);   // MinGW non ha posix_memalign
+#else
+    void *block = NULL;
+    return posix_memalign(&block, align, size) == 0 ? block : NULL;
+#endif
+}
+
+static inline void AlignedFree(void *block)
+{
+#if defined(_WIN32)
+    _aligned_free(block);
+#else
+    free(block);
+#endif
+}
+
+// Core disponibili (almeno 1)
+static inline int CpuCount(void)
+{
+#if defined(_WIN32)
+    int count = pthread_num_processors_np();
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 0 ? count : 1;
+}
+
+#endif // PLATFORM_H
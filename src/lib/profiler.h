@@ -0,0 +1,112 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/*
+ * === TEMPI DELLE FASI DI OGNI FRAME ===
+ *
+ * Il ciclo principale misura con un timer ad alta risoluzione quanto dura ogni
+ * fase del frame (input, fasi della simulazione, disegno, present) e salva i
+ * tempi degli ultimi PROFILE_FRAMES frame in un ring buffer di dimensione fissa:
+ * niente allocazioni mentre si gioca. Dal ring si ricavano media, p95 e p99 di
+ * ogni fase (overlay con F3, vedi hud.h) e si puo' scrivere tutto in CSV (F4).
+ *
+ * Le fasi della simulazione sono misurate dentro SimStep solo se il gioco e'
+ * compilato con SIM_PROFILING (il Makefile lo fa per pacman, non per
+ * pacman_sim): piu' tick nello stesso frame si sommano nella stessa fase.
+ * raylib accumula i draw call e li manda alla GPU in EndDrawing, quindi le fasi
+ * di disegno misurano il lavoro della CPU e "present" comprende GPU e VSync.
+ *
+ * Con una traccia attiva (vedi trace.h) ogni frame e ogni fase diventano anche
+ * intervalli della linea temporale.
+ *
+ * Niente raylib: il modulo e' usato anche dal nucleo di simulazione.
+ */
+
+#include <stdbool.h>
+#include <time.h>
+#include "trace.h"
+
+#define PROFILE_FRAMES 600          // Frame nel ring buffer (10 secondi a 60 fps)
+#define PROFILE_STATS_INTERVAL 15   // Frame tra due ricalcoli delle statistiche
+
+typedef enum {
+    PROFILE_INPUT = 0,      // Tastiera, salvataggi, rewind
+    PROFILE_POWERUPS,       // SimStepPowerUps
+    PROFILE_PACMAN,         // SimStepPacman
+    PROFILE_GHOSTS,         // SimStepGhosts (flow field, kernel, griglia)
+    PROFILE_COLLISIONS,     // SimStepCollisions
+    PROFILE_MAP,            // Cache della mappa: aggiornamento e disegno
+    PROFILE_ENTITIES,       // Power-up, fantasmi e Pacman (DrawPacman e seguenti)
+    PROFILE_HUD,            // Etichette, indicatori e overlay
+    PROFILE_PRESENT,        // EndDrawing
+    PROFILE_PHASE_COUNT
+} ProfilePhase;
+
+typedef struct {
+    float average, p95, p99;   // Millisecondi
+} ProfileStats;
+
+typedef struct FrameProfiler {
+    // Ring buffer: un record per frame completato (head = prossimo da scrivere)
+    float phaseMs[PROFILE_FRAMES][PROFILE_PHASE_COUNT];
+    float frameMs[PROFILE_FRAMES];      // Tempo totale del frame (tra due ProfilerBeginFrame)
+    int head, count;
+    unsigned long long frames;          // Frame completati dall'inizio
+
+    // Frame in corso
+    double frameStart;                  // Millisecondi (ProfilerNow)
+    double phaseStart[PROFILE_PHASE_COUNT];
+    double current[PROFILE_PHASE_COUNT];
+
+    // Statistiche sul contenuto del ring (UpdateProfileStats)
+    ProfileStats stats[PROFILE_PHASE_COUNT];
+    ProfileStats frameStats;
+    unsigned long long statsFrame;      // frames al momento dell'ultimo calcolo
+} FrameProfiler;
+
+// Millisecondi da un istante fisso (clock monotono)
+static inline double ProfilerNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec * 1e-6;
+}
+
+// Azzera il profiler (ring vuoto)
+void InitFrameProfiler(FrameProfiler *profiler);
+
+// Chiude il frame precedente (lo aggiunge al ring) e ne comincia uno nuovo
+void ProfilerBeginFrame(FrameProfiler *profiler);
+
+// Nome breve della fase (overlay, intestazione del CSV e traccia)
+const char *ProfilePhaseName(ProfilePhase phase);
+
+// Inizio e fine di una fase del frame in corso; profiler NULL = nessuna misura
+static inline void ProfilerBegin(FrameProfiler *profiler, ProfilePhase phase)
+{
+    if (!profiler)
+        return;
+    if (TraceEnabled())
+        TraceBegin(ProfilePhaseName(phase));
+    profiler->phaseStart[phase] = ProfilerNow();
+}
+
+static inline void ProfilerEnd(FrameProfiler *profiler, ProfilePhase phase)
+{
+    if (!profiler)
+        return;
+    profiler->current[phase] += ProfilerNow() - profiler->phaseStart[phase];
+    if (TraceEnabled())
+        TraceEnd(ProfilePhaseName(phase));
+}
+
+// Ricalcola media, p95 e p99 se sono passati PROFILE_STATS_INTERVAL frame (o force)
+void UpdateProfileStats(FrameProfiler *profiler, bool force);
+
+// Tempo del frame di age frame fa (0 = l'ultimo completato), 0 se non c'e'
+float GetProfiledFrameMs(const FrameProfiler *profiler, int age);
+
+// Scrive il ring buffer in CSV, dal frame piu' vecchio al piu' recente
+bool DumpFrameProfilerCsv(const FrameProfiler *profiler, const char *path);
+
+#endif // PROFILER_H
@@ -0,0 +1,89 @@
+#ifndef RENDER_H
+#define RENDER_H
+#include "../utils/raylib/src/raylib.h"
+#include "common.h"
+
+/*
+ * === CAMERA E CULLING ===
+ *
+ * La mappa puo' essere molto piu' grande della finestra: una Camera2D segue
+ * Pacman e ogni frame si disegna solo cio' che cade nelle celle visibili
+ * (TileRange). Il costo del rendering dipende dall'area dello schermo, non
+ * dalle dimensioni del labirinto.
+ */
+
+// Camera centrata su target (in pixel del mondo), fermata ai bordi della mappa;
+// se la mappa e' piu' piccola della finestra resta centrata sulla mappa
+Camera2D FollowCamera(const World *w, Vector2 target, int screenWidth, int screenHeight);
+
+// Celle inquadrate dalla camera, allargate di margin celle per lato e limitate alla mappa
+TileRange GetVisibleTiles(const World *w, Camera2D camera, int screenWidth, int screenHeight, int margin);
+
+/*
+ * === CACHE DI RENDERING DELLA MAPPA ===
+ *
+ * I muri non cambiano durante un livello: vengono disegnati una sola volta in
+ * una RenderTexture. I puntini stanno in un secondo livello trasparente che
+ * viene toccato solo nelle celle mangiate dall'ultimo frame. Ogni frame la
+ * mappa costa quindi due DrawTextureRec invece di un draw call per cella.
+ *
+ * Le texture non coprono tutta la mappa ma una regione poco piu' grande della
+ * finestra (MAP_CACHE_MARGIN celle per lato): quando la camera esce dalla
+ * regione, la regione si ricentra e viene ridisegnata. Su un labirinto piccolo
+ * la regione e' la mappa intera e non si sposta mai.
+ */
+
+#define MAP_CACHE_MARGIN 8   // Celle di scorta attorno alla finestra prima di ridisegnare
+
+typedef struct {
+    RenderTexture2D walls;          // Livello statico dei muri della regione
+    RenderTexture2D pellets;        // Livello dei puntini (trasparente dove non ce ne sono)
+    MapWord *drawnDots;             // Puntini presenti nel livello pellets (rows * words, validi nella regione)
+    int rows, cols, words;          // Dimensioni della mappa per cui e' stata creata la cache
+    TileRange region;               // Celle coperte dalle texture
+    int regionRows, regionCols;     // Dimensioni delle texture in celle
+    int levelNumber;                // Livello per cui sono stati disegnati i muri
+    bool loaded;
+} MapRenderCache;
+
+// Crea le due texture per la mappa di w e una finestra screenWidth x screenHeight
+// (da chiamare dopo InitWindow)
+bool InitMapRenderCache(MapRenderCache *cache, const World *w, int screenWidth, int screenHeight);
+
+// Allinea la cache allo stato del mondo e alle celle visibili (prima di BeginDrawing)
+void UpdateMapRenderCache(MapRenderCache *cache, const World *w, TileRange visible);
+
+// Compone i due livelli nelle coordinate del mondo (dentro BeginMode2D)
+void DrawMapRenderCache(const MapRenderCache *cache);
+
+// Libera le texture e la copia dei puntini
+void UnloadMapRenderCache(MapRenderCache *cache);
+
+/*
+ * === INTERPOLAZIONE TRA DUE TICK ===
+ *
+ * La logica avanza a passo fisso (SIM_TICK_RATE), il rendering va alla
+ * frequenza dello schermo: ogni frame disegna Pacman e i fantasmi in una
+ * posizione intermedia tra il tick precedente e quello corrente.
+ */
+
+typedef struct {
+    Vector2 pacman;            // Pacman al tick precedente
+    float *ghostX, *ghostY;    // Fantasmi al tick precedente
+    int capacity;              // Fantasmi per cui c'e' spazio
+} RenderInterp;
+
+// Alloca lo spazio per capacity fantasmi
+bool InitRenderInterp(RenderInterp *interp, int capacity);
+
+// Salva le posizioni correnti (da chiamare subito prima di ogni SimStep)
+void CaptureRenderInterp(RenderInterp *interp, const World *w);
+
+// Posizione tra previous (alpha = 0) e current (alpha = 1); i salti piu' lunghi
+// di una cella (reset dopo una collisione, nuovo livello) non vengono interpolati
+Vector2 InterpolatePosition(Vector2 previous, Vector2 current, float alpha);
+
+// Libera la memoria
+void UnloadRenderInterp(RenderInterp *interp);
+
+#endif // RENDER_H
@@ -0,0 +1,72 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+/*
+ * === REGISTRAZIONE E REPLAY DELL'INPUT ===
+ *
+ * La simulazione e' deterministica: labirinto + seme + numero di fantasmi +
+ * input di ogni tick bastano per rigiocare una partita identica. Il labirinto
+ * non e' nel file: c'e' la sua impronta (Maze.hash), e il replay va fatto con
+ * lo stesso file di labirinto. L'input (le quattro frecce,
+ * 4 bit) e' salvato a run-length: un byte per run, con l'input nei 4 bit bassi
+ * e la lunghezza-1 nei 4 alti; le run piu' lunghe di 16 tick aggiungono la
+ * lunghezza restante come varint (7 bit per byte). Dieci minuti di gioco
+ * occupano pochi kilobyte.
+ *
+ * Formato del file (interi little-endian):
+ *   "PCRP"  versione:u16  tickRate:u16  seed:u32  numGhosts:u32  numTicks:u64  dataSize:u32
+ *   mazeHash:u64
+ *   seguiti da dataSize byte di run.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "sim.h"
+
+#define REPLAY_VERSION 3
+
+typedef struct {
+    unsigned int seed;              // Seme passato a SimInit
+    int numGhosts;                  // Fantasmi della partita (SimCreate)
+    int tickRate;                   // SIM_TICK_RATE con cui e' stata registrata
+    unsigned long long mazeHash;    // Impronta del labirinto (Maze.hash)
+    unsigned long long numTicks;    // Tick registrati
+
+    unsigned char *data;            // Run codificate
+    size_t size, capacity;
+
+    SimInput runInput;              // Run in corso, non ancora codificata
+    unsigned long long runLength;
+} Replay;
+
+// Posizione di lettura dentro una registrazione
+typedef struct {
+    const Replay *replay;
+    size_t pos;                     // Prossimo byte di data
+    SimInput input;                 // Input della run corrente
+    unsigned long long left;        // Tick rimasti nella run corrente
+    unsigned long long tick;        // Tick gia' letti
+} ReplayCursor;
+
+// Inizia una registrazione vuota per una partita con questo seme sul labirinto indicato
+void ReplayInit(Replay *replay, unsigned int seed, int numGhosts, unsigned long long mazeHash);
+
+// Aggiunge l'input di un tick; ritorna false se manca memoria
+bool ReplayRecord(Replay *replay, SimInput input);
+
+// Scrive la registrazione su file (chiude anche la run in corso)
+bool ReplaySave(Replay *replay, const char *path);
+
+// Legge una registrazione da file; ritorna false se il file non e' valido
+bool ReplayLoad(Replay *replay, const char *path);
+
+// Libera la memoria della registrazione
+void ReplayFree(Replay *replay);
+
+// Prepara la lettura dall'inizio
+void ReplayCursorInit(ReplayCursor *cursor, const Replay *replay);
+
+// Input del prossimo tick; ritorna false quando la registrazione e' finita
+bool ReplayNext(ReplayCursor *cursor, SimInput *input);
+
+#endif // REPLAY_H
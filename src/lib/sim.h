@@ -0,0 +1,262 @@
+#ifndef SIM_H
+#define SIM_H
+
+/*
+ * === NUCLEO DI SIMULAZIONE HEADLESS ===
+ *
+ * Tutta la logica di gioco (mappa, Pacman, fantasmi, power-up, punteggio e vite)
+ * vive in una struttura World autonoma e avanza di un tick alla volta con SimStep().
+ * Questo header NON dipende da raylib: puo' essere compilato da solo (make sim)
+ * per far girare il gioco senza finestra e senza il limite dei 60 FPS.
+ *
+ * Il tempo di gioco si misura in tick a frequenza fissa (SIM_TICK_RATE al
+ * secondo), non in frame: velocita', durate e probabilita' di spawn sono
+ * definite al secondo e convertite in tick qui sotto, quindi il gioco si
+ * comporta allo stesso modo qualunque sia il frame rate del rendering.
+ */
+
+#include <stdbool.h>
+
+// Se raylib e' gia' stato incluso usa il suo Vector2, altrimenti ne definisce
+// uno identico (stesso layout, stesso guard usato da raymath.h)
+#if !defined(RL_VECTOR2_TYPE)
+typedef struct Vector2 {
+    float x;
+    float y;
+} Vector2;
+#define RL_VECTOR2_TYPE
+#endif
+
+#include "map.h"
+#include "arena.h"
+
+#define TILE_SIZE 40
+#define NUM_GHOST 4                // Fantasmi di default (il numero vero e' scelto a runtime, vedi SimCreate)
+#define MAX_GHOSTS 65536           // Limite al numero di fantasmi di una partita
+#define SIM_DEFAULT_MAZE "mazes/classic.txt"  // Labirinto usato se non se ne sceglie un altro (--maze)
+
+#include "ghosts.h"
+#include "grid.h"
+
+// === TEMPO DI GIOCO ===
+#ifndef SIM_TICK_RATE
+#define SIM_TICK_RATE 60           // Tick di logica al secondo (make TICK_RATE=120 per cambiarlo)
+#endif
+#define SIM_SECONDS(s) ((int)((s) * SIM_TICK_RATE + 0.5))  // Secondi -> tick
+
+#define LIVES 3                    // Vite iniziali di Pacman
+#define PACMAN_BASE_SPEED (180.0f / SIM_TICK_RATE)  // Velocita' base di Pacman e fantasmi: 180 pixel al secondo
+
+// === CONFIGURAZIONE POWER-UP ===
+// Definizioni delle costanti per i power-up
+// (spawn e durata si possono cambiare da riga di comando per i test di bilanciamento,
+//  es. make sim SIM_DEFINES="-DPOWERUP_DURATION=600")
+#define MAX_POWERUPS 3             // Massimo numero di power-up simultanei sulla mappa
+#ifndef POWERUP_SPAWN_CHANCE
+#define POWERUP_SPAWN_CHANCE SIM_SECONDS(100.0 / 60.0)  // 1 su N tick: in media un tentativo ogni 1.7 secondi
+#endif
+#ifndef POWERUP_DURATION
+#define POWERUP_DURATION SIM_SECONDS(5)  // Durata effetti: 5 secondi (300 tick a 60 Hz)
+#endif
+
+// === ENUMERAZIONE DEI TIPI DI POWER-UP ===
+// Definisce tutti i tipi di power-up disponibili nel gioco
+typedef enum {
+    POWERUP_NONE = 0,     // Nessun power-up (valore di default)
+    POWERUP_SPEED,        // Aumenta velocità di Pacman del 50%
+    POWERUP_INVINCIBLE,   // Rende Pacman invincibile ai fantasmi
+    POWERUP_SCORE_BOOST,  // Raddoppia i punti ottenuti dai puntini
+    POWERUP_SLOW_GHOSTS,  // Rallenta i fantasmi del 50%
+    POWERUP_EXTRA_LIFE,   // Aggiunge una vita extra
+    POWERUP_TYPE_COUNT    // Numero di tipi (deve restare <= 32: un bit per tipo)
+} PowerUpType;
+
+// === STRUTTURA POWER-UP SULLA MAPPA ===
+// Rappresenta un power-up fisicamente presente sulla mappa di gioco
+// (il colore di rendering si ricava dal tipo, vedi pacman.c)
+typedef struct {
+    Vector2 pos;        // Posizione del power-up sulla mappa (in pixel)
+    PowerUpType type;   // Tipo di power-up (velocità, invincibilità, ecc.)
+    bool isActive;      // Se true, il power-up è visibile e raccoglibile
+    int spawnTime;      // Momento in cui il power-up è apparso (in tick)
+} PowerUp;
+
+// === EFFETTI ATTIVI ===
+// Gli effetti in corso sono una bitmask (un bit per tipo) con il tick di scadenza
+// di ogni tipo; le scadenze sono pilotate da una piccola ruota temporale:
+// lo slot (tick % EFFECT_WHEEL_SIZE) contiene i tipi che potrebbero scadere in quel tick
+#define EFFECT_WHEEL_SIZE 512      // Potenza di due; durate piu' lunghe fanno piu' giri
+
+//Level compleate or not
+typedef struct
+{
+    int score;
+    bool IsCompleate;
+}LevelCompleate;
+
+// === INPUT DI UN TICK ===
+// Stato delle quattro frecce, un bit per tasto
+typedef unsigned char SimInput;
+
+#define SIM_INPUT_RIGHT (1 << 0)
+#define SIM_INPUT_LEFT  (1 << 1)
+#define SIM_INPUT_UP    (1 << 2)
+#define SIM_INPUT_DOWN  (1 << 3)
+
+// === MONDO DI GIOCO ===
+// Contiene tutto lo stato di una partita: niente globali, niente raylib.
+// Mappa, fantasmi, griglie, flow field e grafo degli incroci stanno in un'unica
+// arena (vedi arena.h) riservata da SimCreate della dimensione esatta per il
+// labirinto e i fantasmi: un blocco contiguo, liberato da SimDestroy con una
+// sola free. SimInit e i cambi di livello la riusano cosi' com'e', SimReload la
+// svuota in O(1) e la ritaglia per un altro labirinto: una partita nuova non alloca nulla
+typedef struct {
+    const Maze *maze;                            // Labirinto della partita (non copiato, vedi SimCreate)
+    Arena arena;                                 // Memoria di tutto cio' che segue (tranne il planner HPA)
+    MapBits map;                                 // Muri e puntini come bitboard (vedi map.h)
+    struct FrameProfiler *profiler;              // Tempi delle fasi di SimStep (vedi profiler.h), NULL = niente misure
+    struct GhostPool *ghostPool;                 // Thread per muovere i fantasmi (vedi ghostpool.h), NULL = seriale
+    LevelCompleate level;                        // Esito dell'ultimo livello completato
+    int levelNumber;                             // Livello in corso (parte da 1)
+    Vector2 pacmanPos;                           // Posizione di Pacman (in pixel)
+    int pacmanCell;                              // Cella di Pacman (MapCell), per le query sulla griglia
+    GhostSwarm ghosts;                           // Fantasmi (structure of arrays, vedi ghosts.h)
+    PowerUp powerups[MAX_POWERUPS];              // Power-up presenti sulla mappa
+    unsigned int activeEffects;                  // Bit t acceso = effetto di tipo t attivo
+    unsigned int effectExpiry[POWERUP_TYPE_COUNT]; // Tick in cui scade ogni effetto
+    unsigned int expiryWheel[EFFECT_WHEEL_SIZE]; // Tipi con una scadenza in ogni slot
+    int score;                                   // Punteggio
+    int lives;                                   // Vite rimaste
+    bool gameOver;                               // true quando le vite sono finite
+    unsigned int tick;                           // Tick simulati dall'inizio della partita
+    unsigned int rngState;                       // Stato del generatore casuale (deterministico)
+
+    // === CACHE DERIVATE ===
+    // Da qui in poi tutto si ricostruisce dai campi precedenti (SimRebuildCaches):
+    // gli snapshot copiano solo i campi fino a ghostGrid (vedi snapshot.h)
+    SpatialGrid ghostGrid;                       // Fantasmi per cella (broadphase, vedi grid.h)
+    SpatialGrid powerupGrid;                     // Power-up sulla mappa per cella
+
+    // Flow field verso Pacman (vedi flowfield.h), una voce per cella (MapCell)
+    unsigned int *flowDist;                      // Distanza nel labirinto dalla cella di Pacman (NULL con hpa)
+    unsigned char *flowDir;                      // Primo passo verso Pacman (FLOW_*)
+    int *flowQueue;                              // Coda della BFS (NULL con hpa)
+    int flowRow, flowCol;                        // Cella di Pacman per cui il campo e' valido
+    struct HpaPlanner *hpa;                      // Percorsi gerarchici sui labirinti grandi (vedi hpa.h), NULL = BFS completa
+    JunctionGraph junctions;                     // Incroci e corridoi percorsi dai fantasmi (vedi junction.h)
+    int *spawnRowFirst;                          // Celle di partenza dei fantasmi in piu' prima di ogni riga (rows + 1 voci)
+} World;
+
+// === FUNZIONI PRINCIPALI DELLA SIMULAZIONE ===
+// Alloca un mondo sul labirinto indicato con numGhosts fantasmi (1..MAX_GHOSTS); va
+// chiamato prima di SimInit. Il labirinto non viene copiato e deve restare valido
+// finche' il mondo esiste (piu' mondi possono usare lo stesso).
+// Ritorna false se il numero non e' valido o manca memoria
+bool SimCreate(World *w, const Maze *maze, int numGhosts);
+
+// Libera la memoria allocata da SimCreate
+void SimDestroy(World *w);
+
+// Byte di arena che servono a SimCreate per il labirinto e i fantasmi
+size_t SimMemorySize(const Maze *maze, int numGhosts);
+
+// Rifa' un mondo gia' creato per un altro labirinto o numero di fantasmi: l'arena
+// si svuota e si ritaglia senza passare dall'heap se e' abbastanza grande
+// (altrimenti viene riservata di nuovo). Profiler e pool di thread restano;
+// poi serve SimInit. Ritorna false (mondo distrutto) se i valori non sono validi o manca memoria
+bool SimReload(World *w, const Maze *maze, int numGhosts);
+
+// Prepara una partita nuova (mappa, Pacman, fantasmi, power-up) con il seme indicato
+void SimInit(World *w, unsigned int seed);
+
+// Avanza la simulazione di un tick usando l'input indicato
+void SimStep(World *w, SimInput input);
+
+// === FASI DI UN TICK ===
+// SimStep le chiama in quest'ordine (tra Pacman e fantasmi controlla il livello completato);
+// sono pubbliche per misurarle una per una (make bench)
+void SimStepPowerUps(World *w);                  // Scadenza effetti e spawn dei power-up
+void SimStepPacman(World *w, SimInput input);    // Movimento, puntini e raccolta power-up
+void SimStepGhosts(World *w);                    // Flow field, kernel dei fantasmi e griglia
+void SimStepCollisions(World *w);                // Pacman contro i fantasmi vicini
+
+// Passa al livello successivo: rimette i puntini, Pacman e i fantasmi in partenza
+void SimNextLevel(World *w);
+
+// Rimette i fantasmi nelle posizioni di partenza con direzioni casuali
+void SimResetGhosts(World *w);
+
+// Ricostruisce le griglie dallo stato del mondo (es. dopo il ripristino di uno
+// snapshot); il flow field si ricalcola al primo tick solo se Pacman e' in un'altra cella
+void SimRebuildCaches(World *w);
+
+// Posizione del fantasma i (in pixel), calcolata dall'arco che sta percorrendo
+static inline Vector2 SimGhostPos(const World *w, int i)
+{
+    int edge = w->ghosts.edge[i];
+    if (edge == JUNCTION_NONE)
+    {
+        int cell = w->ghosts.cell[i];
+        return (Vector2){MapCellCol(&w->map, cell) * TILE_SIZE + TILE_SIZE / 2.0f,
+                         MapCellRow(&w->map, cell) * TILE_SIZE + TILE_SIZE / 2.0f};
+    }
+    const JunctionEdge *e = &w->junctions.edges[edge];
+    float offset = w->ghosts.offset[i];
+    return (Vector2){e->fromCol * TILE_SIZE + TILE_SIZE / 2.0f + e->dx * offset,
+                     e->fromRow * TILE_SIZE + TILE_SIZE / 2.0f + e->dy * offset};
+}
+
+// Numero casuale in [min, max] (estremi inclusi), come GetRandomValue di raylib
+int SimRandom(World *w, int min, int max);
+
+// Verifica se dalla posizione pos ci si puo' muovere di una cella in direzione dir
+bool IsDirectionValid(const World *w, Vector2 pos, Vector2 dir);
+
+// Controlla se Pacman e un fantasma si stanno toccando
+bool CheckPacmanCollision(Vector2 pacmanPos, Vector2 ghostPos);
+
+// Calcola la distanza euclidea tra due punti (alternativa a Vector2Distance di raylib)
+float CalculateDistance(Vector2 v1, Vector2 v2);
+
+// === FUNZIONI DI GESTIONE POWER-UP ===
+// Inizializza il sistema dei power-up (chiamata all'inizio del gioco)
+void InitializePowerUps(World *w);
+
+// Genera casualmente un nuovo power-up sulla mappa
+void SpawnPowerUp(World *w);
+
+// Controlla se Pacman ha raccolto un power-up e applica l'effetto
+void CheckPowerUpCollection(World *w);
+
+// Applica immediatamente l'effetto di un power-up
+void ApplyPowerUp(World *w, PowerUpType type);
+
+// Attiva (o rinnova) un effetto per duration tick
+void AddActivePowerUp(World *w, PowerUpType type, int duration);
+
+// Fa scadere gli effetti il cui tempo finisce in questo tick
+void UpdateActivePowerUps(World *w);
+
+// Tick rimanenti di un effetto (0 se non e' attivo)
+int GetPowerUpTimeLeft(const World *w, PowerUpType type);
+
+// Verifica se un determinato tipo di power-up è attualmente attivo (un solo test di bit)
+static inline bool IsPowerUpActive(const World *w, PowerUpType type)
+{
+    return (w->activeEffects >> type) & 1u;
+}
+
+// Restituisce il moltiplicatore di velocità per Pacman
+float GetSpeedMultiplier(const World *w);
+
+// Restituisce il moltiplicatore di punteggio per i puntini
+int GetScoreMultiplier(const World *w);
+
+// Velocita' di Pacman e dei fantasmi modificate dai power-up
+float GetModifiedSpeed(const World *w, float baseSpeed);
+float GetGhostSpeed(const World *w, float baseSpeed);
+
+// Verifica se Pacman è attualmente invincibile
+bool IsPacmanInvincible(const World *w);
+
+#endif // SIM_H
@@ -0,0 +1,69 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/*
+ * === SNAPSHOT DEL MONDO ===
+ *
+ * Uno snapshot e' un blocco di byte contiguo con tutto lo stato di un World:
+ * i campi di World fino alle cache derivate, gli array dei fantasmi e lo stato
+ * della mappa (puntini e celle libere; i muri sono del labirinto e non cambiano).
+ * Salvare e' solo una serie di memcpy (pochi KB sul labirinto classico), quindi
+ * si puo' fare uno snapshot a ogni tick (rewind, rollback) senza allocare; il
+ * ripristino ricostruisce anche le griglie (SimRebuildCaches) e tiene il flow
+ * field se Pacman e' nella cella per cui era stato calcolato.
+ * La dimensione cresce con il labirinto e con i puntini mangiati: SnapshotSize
+ * e' il massimo.
+ *
+ * Uno snapshot vale solo per un World con lo stesso labirinto e lo stesso
+ * numero di fantasmi, nello stesso processo (contiene puntatori, non e' un
+ * formato di file).
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "sim.h"
+
+// Byte necessari per uno snapshot di w
+size_t SnapshotSize(const World *w);
+
+// Copia lo stato di w in buffer (SnapshotSize(w) byte)
+void SnapshotSave(const World *w, void *buffer);
+
+// Ripristina w da buffer; ritorna false se lo snapshot e' di un World diverso
+bool SnapshotLoad(World *w, const void *buffer);
+
+// === RING BUFFER PER IL REWIND ===
+// Gli ultimi capacity snapshot, in un'unica allocazione fatta all'inizio. Gli
+// snapshot stanno uno dopo l'altro, ognuno nei byte che usa: quando il blocco
+// e' pieno il nuovo prende il posto dei piu' vecchi
+#define SNAPSHOT_RING_MAX_BYTES ((size_t)256 << 20)  // Sui labirinti grandi il ring puo' tenere meno snapshot
+
+typedef struct {
+    unsigned char *slots;   // bytes byte
+    size_t bytes;
+    size_t *offset;         // Inizio di ogni snapshot nel blocco (capacity voci, in cerchio)
+    size_t *size;           // Byte occupati da ogni snapshot
+    int capacity;           // Snapshot al massimo
+    int minCount;           // Snapshot che il blocco tiene anche se sono tutti grandi SnapshotSize
+    int head;               // Voce del prossimo snapshot
+    int count;              // Snapshot validi: le count voci prima di head
+} SnapshotRing;
+
+// Alloca il blocco per capacity snapshot di w, al piu' SNAPSHOT_RING_MAX_BYTES
+// (almeno uno snapshot pieno). minCount < capacity vuol dire che il limite conta:
+// sul labirinto di w il ring puo' tenere meno snapshot di quelli chiesti
+bool InitSnapshotRing(SnapshotRing *ring, const World *w, int capacity);
+
+// Libera la memoria
+void FreeSnapshotRing(SnapshotRing *ring);
+
+// Dimentica tutti gli snapshot (es. all'inizio di una nuova partita)
+void ClearSnapshotRing(SnapshotRing *ring);
+
+// Aggiunge lo stato corrente di w; se il ring e' pieno sovrascrive il piu' vecchio
+void PushSnapshot(SnapshotRing *ring, const World *w);
+
+// Torna allo snapshot piu' recente e lo toglie dal ring; false se il ring e' vuoto
+bool PopSnapshot(SnapshotRing *ring, World *w);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,69 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/*
+ * === TRACCIA DEGLI EVENTI (CHROME TRACE-EVENT) ===
+ *
+ * Con --trace FILE il gioco scrive una linea temporale di tutta la sessione nel
+ * formato JSON "trace event" di Chrome: si apre cosi' com'e' in Perfetto
+ * (ui.perfetto.dev) o in chrome://tracing. Contiene:
+ *
+ *   - un intervallo per ogni frame e, dentro, uno per ogni fase misurata dal
+ *     profiler (vedi profiler.h: input, fasi di SimStep, disegno, present);
+ *   - eventi istantanei per i fatti di gioco: cambi di GameState, vite perse,
+ *     game over, livelli completati, power-up comparsi e raccolti.
+ *
+ * Ogni thread scrive solo nel proprio buffer, una lista di blocchi di
+ * TRACE_CHUNK_EVENTS eventi: niente lock, niente atomiche condivise sul
+ * percorso caldo (solo la pubblicazione del blocco quando si riempie). Un
+ * thread di scrittura passa ogni TRACE_FLUSH_MS millisecondi, scrive nel file
+ * i blocchi pieni di tutti i thread e li libera: il JSON non si formatta nel
+ * frame e anche una sessione di ore occupa pochi blocchi in memoria.
+ *
+ * A traccia spenta ogni punto di misura costa la lettura di un flag.
+ * I nomi degli eventi devono essere stringhe costanti (non vengono copiate
+ * ne' trasformate in JSON escape).
+ *
+ * Niente raylib: il modulo e' usato anche dal nucleo di simulazione.
+ */
+
+#include <stdbool.h>
+
+#define TRACE_CHUNK_EVENTS 4096   // Eventi per blocco (~160 KB), il thread ne alloca uno nuovo quando e' pieno
+#define TRACE_FLUSH_MS 100        // Pausa del thread di scrittura tra due passaggi
+
+extern int traceEnabled;          // Letto senza lock da ogni thread (vedi TraceEnabled)
+
+// true tra TraceStart e TraceStop
+static inline bool TraceEnabled(void)
+{
+    return __atomic_load_n(&traceEnabled, __ATOMIC_RELAXED) != 0;
+}
+
+// Nanosecondi dal clock monotono (lo stesso di ProfilerNow)
+unsigned long long TraceTimestamp(void);
+
+// Apre il file, avvia il thread di scrittura e comincia a registrare; false
+// se non si puo' scrivere o se una traccia e' gia' attiva
+bool TraceStart(const char *path);
+
+// Smette di registrare, scrive tutti gli eventi rimasti e chiude il file.
+// Gli altri thread non devono emettere eventi durante la chiamata
+bool TraceStop(void);
+
+// Nome del thread chiamante nella linea temporale
+void TraceThreadName(const char *name);
+
+// Inizio e fine di un intervallo sul thread chiamante (vanno annidati)
+void TraceBegin(const char *name);
+void TraceEnd(const char *name);
+
+// Intervallo gia' misurato: inizio e durata in nanosecondi (TraceTimestamp),
+// con un argomento intero (argName NULL = nessuno)
+void TraceComplete(const char *name, unsigned long long start, unsigned long long duration,
+                   const char *argName, long long value);
+
+// Evento istantaneo con un argomento intero (argName NULL = nessuno)
+void TraceInstant(const char *name, const char *argName, long long value);
+
+#endif // TRACE_H
@@ -2,151 +2,353 @@
 #include "utils/raylib/src/raylib.h" // Libreria grafica raylib
 #include "lib/common.h"              // Header con definizioni comuni del progetto
 #include "lib/pacman.h"
+#include "lib/render.h"
+#include "lib/hud.h"
+#include "lib/replay.h"
+#include "lib/snapshot.h"
+#include "lib/mazegen.h"
+#include "lib/profiler.h"
+#include "lib/trace.h"
+#include "lib/ghostpool.h"
+#include "lib/autopilot.h"
+#include "lib/platform.h"
 
-// Variabili globali
-Ghost ghosts[NUM_GHOST];
+#include <time.h>
 
-//Define's
-#define LIVES 3
+#define FALLBACK_FPS 60  // Limite dei frame se la frequenza del monitor non e' nota
 
+// Variabili globali
+World world;  // Stato della partita (mappa, Pacman, fantasmi, power-up, punteggio, vite)
+Maze maze;    // Labirinto letto da file (--maze), condiviso da tutte le partite
+
+// === REGISTRAZIONE E REPLAY (vedi replay.h) ===
+const char *recordPath = NULL;  // --record FILE: salva l'input di ogni partita
+Replay recording;               // Partita in corso di registrazione
+bool recordingActive = false;   // false dopo il salvataggio o se la partita e' stata riavvolta
+Replay replay;                  // --replay FILE: partita da rigiocare
+ReplayCursor replayCursor;
+bool replaying = false;         // true finche' l'input arriva dalla registrazione
+int replaySpeed = 1;            // Velocita' del replay: 1x, 4x o 16x
+
+// === REWIND E SALVATAGGIO RAPIDO (vedi snapshot.h) ===
+#define REWIND_SECONDS 5
+SnapshotRing rewindRing;        // Uno snapshot per tick degli ultimi REWIND_SECONDS secondi
+void *quickSave = NULL;         // F5 salva qui, F9 ricarica
+bool hasQuickSave = false;
+
+// === TEMPI DEI FRAME (vedi profiler.h) ===
+#define PROFILE_CSV_PATH "frametimes.csv"
+FrameProfiler profiler;         // Ultimi PROFILE_FRAMES frame, fase per fase
+bool showProfiler = false;      // F3 mostra l'overlay, F4 scrive PROFILE_CSV_PATH
+
+// === FANTASMI IN PARALLELO (vedi ghostpool.h) ===
+GhostPool ghostPool;            // --threads N (default: un thread per core)
+
+// === AUTOPILOTA (vedi autopilot.h) ===
+Autopilot autopilot;            // Ricerca MCTS sugli stessi thread di --threads
+bool autopilotActive = false;   // --autopilot o F2: Pacman si muove da solo
+int autopilotBudgetUs = AUTOPILOT_DEFAULT_BUDGET_US;  // --autopilot-budget US
+
+// === TRACCIA DELLA SESSIONE (vedi trace.h) ===
+const char *tracePath = NULL;   // --trace FILE: linea temporale di frame, fasi ed eventi di gioco
 
 // PROTOTYPE'S
-bool IsDirectionValid(Vector2 pos, Vector2 dir);
-void ResetGame(Vector2 *ghostStartPositions, Vector2 *pacmanPos, int *score , int state); 
-// GLOBAL VAR
-int pacmanLives = LIVES;
-bool gameOver = false;
+void ResetGame(int state);
+void FinishRecording(void);
+SimInput ReadPlayerInput(void);
+void AbandonRecording(void);
+void FinishTrace(void);
+const char *GameStateTraceName(GameState state);
+
+// Salva la partita registrata (una volta sola per partita)
+void FinishRecording(void)
+{
+    if (!recordingActive)
+        return;
+    recordingActive = false;
+    if (recording.numTicks > 0 && !ReplaySave(&recording, recordPath))
+        fprintf(stderr, "Errore: impossibile scrivere la registrazione %s\n", recordPath);
+    ReplayFree(&recording);
+}
 
+// Dopo un rewind o un caricamento la partita non e' piu' rigiocabile dal solo input:
+// la registrazione in corso viene scartata
+void AbandonRecording(void)
+{
+    if (!recordingActive)
+        return;
+    recordingActive = false;
+    fprintf(stderr, "Registrazione interrotta: la partita e' stata riavvolta o ricaricata\n");
+    ReplayFree(&recording);
+}
 
+// Chiude il file della traccia (se --trace)
+void FinishTrace(void)
+{
+    if (tracePath && TraceStop())
+        fprintf(stderr, "Traccia salvata in %s\n", tracePath);
+    tracePath = NULL;
+}
 
-void ResetGame(Vector2 *ghostStartPositions, Vector2 *pacmanPos, int *score , int state)
+// Nome dell'evento della traccia per l'ingresso in uno stato
+const char *GameStateTraceName(GameState state)
 {
-    // Reset vite e stato
-    pacmanLives = LIVES;
-    gameOver = false;
-
-    // Reset punteggio
-    *score = 0;
-
-    // Reset mappa
-    char originalMap[MAP_ROWS][MAP_COLS] = {
-        "###############",
-        "#.............#",
-        "#.###.###.###.#",
-        "#.............#",
-        "#.###.#.#.###.#",
-        "#.............#",
-        "#.###.###.###.#",
-        "#.............#",
-        "#.###########.#",
-        "###############"};
-
-    for (int row = 0; row < MAP_ROWS; row++)
+    switch (state)
     {
-        for (int col = 0; col < MAP_COLS; col++)
-        {
-            map[row][col] = originalMap[row][col];
-        }
+        case GAME_STATE_HOME: return "state_home";
+        case GAME_STATE_PLAYING: return "state_playing";
+        case GAME_STATE_PAUSED: return "state_paused";
+        case GAME_STATE_GAME_OVER: return "state_game_over";
+        case GAME_STATE_INSTRUCTIONS: return "state_instructions";
     }
+    return "state_unknown";
+}
 
-    // Reset posizione Pacman
-    *pacmanPos = (Vector2){1 * TILE_SIZE + TILE_SIZE / 2.0f, 1 * TILE_SIZE + TILE_SIZE / 2.0f};
-
-    // Reset fantasmi
-    for (int i = 0; i < NUM_GHOST; i++)
+void ResetGame(int state)
+{
+    // La partita appena giocata resta nel file di registrazione
+    FinishRecording();
+    replaying = false;  // Da qui in poi gioca il giocatore
+
+    // Reset mappa, Pacman, fantasmi, punteggio e vite in un colpo solo
+    unsigned int seed = (unsigned int)time(NULL);
+    SimInit(&world, seed);
+    TraceInstant("new_game", "seed", seed);
+    ClearSnapshotRing(&rewindRing);
+    hasQuickSave = false;
+    if (recordPath)
     {
-        ghosts[i].pos = ghostStartPositions[i];
-        ghosts[i].dir = (Vector2){GetRandomValue(-1, 1), GetRandomValue(-1, 1)};
-        while (ghosts[i].dir.x == 0 && ghosts[i].dir.y == 0)
-        {
-            ghosts[i].dir = (Vector2){GetRandomValue(-1, 1), GetRandomValue(-1, 1)};
-        }
+        ReplayInit(&recording, seed, world.ghosts.count, maze.hash);
+        recordingActive = true;
     }
+
     // with this we remove a lot of duplicated code 
     if(state == QUIT)
     {
+        FinishTrace();
         exit(EXIT_SUCCESS); 
     }
 }
 
-// Definizione della mappa del gioco
-// '#' = muro, '.' = puntino da mangiare, ' ' = spazio vuoto
-char map[MAP_ROWS][MAP_COLS] = {
-    "###############", // Riga 0: bordo superiore
-    "#.............#", // Riga 1: corridoio con puntini
-    "#.###.###.###.#", // Riga 2: muri interni
-    "#.............#", // Riga 3: corridoio con puntini
-    "#.###.#.#.###.#", // Riga 4: muri interni complessi
-    "#.............#", // Riga 5: corridoio con puntini
-    "#.###.###.###.#", // Riga 6: muri interni
-    "#.............#", // Riga 7: corridoio con puntini
-    "#.###########.#", // Riga 8: muri interni
-    "###############"  // Riga 9: bordo inferiore
-};
-
-/* funzione che dice sostanzialmente questo
-    Dati due vettori uno posizione attuale e uno la direzione verso cui va il fantasma
-*   Se esso è compreso in lunghezza tra 0 e MAP_ROWS ( 0 e n stessa cosa) e
-*   lo stesso in altezza (sempre matriciale ), restituisci la posizione (frame valido ) in cui non vi è un muro ovvero un #
-*   Altrimento falso --> sta direzione non è corretta (tipo fuori mappa o scontri tra tutti muri )
-*/
-bool IsDirectionValid(Vector2 pos, Vector2 dir)
+static int ClampInt(int value, int min, int max)
 {
-    int col = (int)(pos.x + dir.x * TILE_SIZE) / TILE_SIZE;
-    int row = (int)(pos.y + dir.y * TILE_SIZE) / TILE_SIZE;
-
-    if (row >= 0 && row < MAP_ROWS && col >= 0 && col < MAP_COLS)
-    {
-        return map[row][col] != '#';
-    }
-    return false;
+    return value < min ? min : (value > max ? max : value);
 }
 
-// CheckPacmanCollision: Check if the current position of Pacman is equal to the current position of a ghost
-
-bool CheckPacmanCollision(Vector2 pacmanPos, Vector2 ghostPos)
+// Traduce i tasti premuti nell'input di un tick della simulazione
+SimInput ReadPlayerInput(void)
 {
-    return (fabs(pacmanPos.x - ghostPos.x) < TILE_SIZE * 0.75f &
-            fabs(pacmanPos.y - ghostPos.y) < TILE_SIZE * 0.75f);
+    SimInput input = 0;
+    if (IsKeyDown(KEY_RIGHT))
+        input |= SIM_INPUT_RIGHT; // Muovi verso destra
+    if (IsKeyDown(KEY_LEFT))
+        input |= SIM_INPUT_LEFT;  // Muovi verso sinistra
+    if (IsKeyDown(KEY_UP))
+        input |= SIM_INPUT_UP;    // Muovi verso l'alto
+    if (IsKeyDown(KEY_DOWN))
+        input |= SIM_INPUT_DOWN;  // Muovi verso il basso
+    return input;
 }
 
 // Funzione principale del gioco
-int main(void)
+// Opzioni: --maze FILE per scegliere il labirinto (default SIM_DEFAULT_MAZE)
+// o --generate CxR [--maze-seed S] per generarne uno (vedi mazegen.h),
+// --ghosts N per giocare con N fantasmi (default NUM_GHOST),
+// --record FILE per registrare le partite, --replay FILE [--speed 1|4|16] per rigiocarne una,
+// --trace FILE per scrivere la traccia della sessione (Perfetto / chrome://tracing),
+// --threads N per i thread che muovono i fantasmi (default: numero di core),
+// --autopilot [--autopilot-budget US] per far giocare l'autopilota MCTS (F2 lo accende e spegne)
+int main(int argc, char **argv)
 {
+    int numGhosts = NUM_GHOST;
+    const char *mazePath = SIM_DEFAULT_MAZE;
+    int generateCols = 0, generateRows = 0;  // 0 = labirinto letto da mazePath
+    unsigned int mazeSeed = 1;
+    const char *replayPath = NULL;
+    int numThreads = CpuCount();
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--maze") == 0 && i + 1 < argc)
+            mazePath = argv[++i];
+        else if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc)
+            MazeParseSize(argv[++i], &generateCols, &generateRows);
+        else if (strcmp(argv[i], "--maze-seed") == 0 && i + 1 < argc)
+            mazeSeed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--ghosts") == 0 && i + 1 < argc)
+            numGhosts = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+            replaySpeed = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--autopilot") == 0)
+            autopilotActive = true;
+        else if (strcmp(argv[i], "--autopilot-budget") == 0 && i + 1 < argc)
+            autopilotBudgetUs = atoi(argv[++i]);
+    }
+    if (replaySpeed < 1)
+        replaySpeed = 1;
+
+    if (generateCols > 0)
+    {
+        if (!MazeGenerate(&maze, generateCols, generateRows, mazeSeed))
+        {
+            fprintf(stderr, "Errore: impossibile generare un labirinto %dx%d (minimo %dx%d)\n",
+                    generateCols, generateRows, MAZE_GEN_MIN_SIZE, MAZE_GEN_MIN_SIZE);
+            return 1;
+        }
+    }
+    else if (!MazeLoadFile(&maze, mazePath))
+    {
+        fprintf(stderr, "Errore: labirinto non valido: %s\n", mazePath);
+        return 1;
+    }
+
+    if (replayPath)
+    {
+        if (!ReplayLoad(&replay, replayPath) || replay.tickRate != SIM_TICK_RATE)
+        {
+            fprintf(stderr, "Errore: registrazione non valida (o a un altro tick rate): %s\n", replayPath);
+            return 1;
+        }
+        if (replay.mazeHash != maze.hash)
+        {
+            fprintf(stderr, "Errore: la registrazione e' stata fatta su un altro labirinto: usare lo stesso "
+                    "--maze FILE, o --generate CxR --maze-seed S se era generato\n");
+            return 1;
+        }
+        numGhosts = replay.numGhosts;  // La partita deve essere identica a quella registrata
+    }
+    if (numGhosts < 1 || numGhosts > MAX_GHOSTS)
+    {
+        fprintf(stderr, "Errore: numero di fantasmi non valido (1-%d): %d\n", MAX_GHOSTS, numGhosts);
+        return 1;
+    }
+    if (!SimCreate(&world, &maze, numGhosts))
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per un labirinto %dx%d con %d fantasmi\n",
+                maze.cols, maze.rows, numGhosts);
+        return 1;
+    }
+    if (tracePath)
+    {
+        if (!TraceStart(tracePath))
+        {
+            fprintf(stderr, "Errore: impossibile scrivere la traccia %s\n", tracePath);
+            return 1;
+        }
+        TraceThreadName("main");
+    }
+    // Dopo TraceStart: i worker compaiono con il loro nome nella traccia
+    if (!InitGhostPool(&ghostPool, ClampInt(numThreads, 1, GHOST_POOL_MAX_THREADS)))
+        fprintf(stderr, "Attenzione: thread dei fantasmi non disponibili, si gioca su un solo thread\n");
+    world.ghostPool = &ghostPool;  // Con un solo thread (o pochi fantasmi) il pool muove tutto sul chiamante
+    if (!InitAutopilot(&autopilot, &world, ClampInt(numThreads, 1, AUTOPILOT_MAX_THREADS), ClampInt(autopilotBudgetUs, 1, 1000000)))
+    {
+        fprintf(stderr, "Attenzione: autopilota non disponibile\n");
+        autopilotActive = false;
+    }
+    InitFrameProfiler(&profiler);
+    world.profiler = &profiler;  // SimStep misura le sue fasi (build con SIM_PROFILING)
+    quickSave = malloc(SnapshotSize(&world));
+    if (!quickSave || !InitSnapshotRing(&rewindRing, &world, SIM_SECONDS(REWIND_SECONDS)))
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per gli snapshot\n");
+        return 1;
+    }
+    if (rewindRing.minCount < rewindRing.capacity)
+        fprintf(stderr, "Attenzione: labirinto grande, il rewind potrebbe tornare indietro di soli %.1f s (limite di %d MB)\n",
+                (double)rewindRing.minCount / SIM_TICK_RATE, (int)(SNAPSHOT_RING_MAX_BYTES >> 20));
+
     // Configurazione della finestra di gioco
-    const int screenWidth = 600;  // Larghezza della finestra
-    const int screenHeight = 400; // Altezza della finestra
+    // Grande quanto il labirinto, ma non piu' piccola delle schermate di menu
+    // ne' piu' grande di un monitor comune
+    const int screenWidth = ClampInt(maze.cols * TILE_SIZE, 600, 1280);  // Larghezza della finestra
+    const int screenHeight = ClampInt(maze.rows * TILE_SIZE, 400, 800);  // Altezza della finestra
 
     // Inizializza la finestra di raylib
+    // Si disegna alla frequenza dello schermo (VSync), la logica avanza comunque
+    // a SIM_TICK_RATE tick al secondo. La VSync e' solo un suggerimento (driver,
+    // compositor e macchine virtuali possono ignorarla): il limite alla stessa
+    // frequenza evita che menu, pausa e gioco girino al 100% di CPU
+    SetConfigFlags(FLAG_VSYNC_HINT);
     InitWindow(screenWidth, screenHeight, "Pacman - raylib");
-    SetTargetFPS(60); // Imposta il gioco a 60 FPS
+    int refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+    SetTargetFPS(refreshRate > 0 ? refreshRate : FALLBACK_FPS);
+
+    // === PASSO FISSO DELLA SIMULAZIONE ===
+    const float tickSeconds = 1.0f / SIM_TICK_RATE;
+    const float maxFrameSeconds = 0.25f;  // Dopo un blocco lungo non recupera piu' di 1/4 di secondo
+    float tickAccumulator = 0.0f;         // Tempo reale non ancora simulato
+    RenderInterp interp;                  // Posizioni al tick precedente, per l'interpolazione
 
     // === VARIABILE DI STATO DEL GIOCO ===
     GameState currentState = GAME_STATE_HOME;  // Inizia dalla schermata home
+    GameState tracedState = currentState;       // Ultimo stato scritto nella traccia
 
     // === INIZIALIZZAZIONE VARIABILI DI GIOCO ===
     // (Vengono inizializzate quando si entra in modalità gioco)
-    Vector2 pacmanPos = {1 * TILE_SIZE + TILE_SIZE / 2.0f, 1 * TILE_SIZE + TILE_SIZE / 2.0f};
     float pacmanRadius = 20.0f;
-    float baseSpeed = 3.0f;
-    int score = 0;
-    
-    // Posizioni di partenza dei fantasmi
-    Vector2 ghostStartPositions[NUM_GHOST] = {
-        {7 * TILE_SIZE + TILE_SIZE / 2.0f, 5 * TILE_SIZE + TILE_SIZE / 2.0f},
-        {7 * TILE_SIZE + TILE_SIZE / 2.0f, 4 * TILE_SIZE + TILE_SIZE / 2.0f},
-        {6 * TILE_SIZE + TILE_SIZE / 2.0f, 5 * TILE_SIZE + TILE_SIZE / 2.0f},
-        {8 * TILE_SIZE + TILE_SIZE / 2.0f, 5 * TILE_SIZE + TILE_SIZE / 2.0f}
-    };
     
+    // Colori dei fantasmi (ripetuti in ciclo se ce ne sono piu' di NUM_GHOST)
     Color ghostColors[NUM_GHOST] = {RED, GREEN, BLUE, PURPLE};
     
-    // Inizializza i power-up
-    InitPacman();
+    // Inizializza il mondo di gioco (mappa, power-up, fantasmi)
+    TraceInstant(GameStateTraceName(currentState), "state", currentState);
+    ResetGame(RESTART);
+    if (replayPath)
+    {
+        // Replay: stessa partita della registrazione, si parte subito a giocarla
+        SimInit(&world, replay.seed);
+        ReplayCursorInit(&replayCursor, &replay);
+        replaying = true;
+        currentState = GAME_STATE_PLAYING;
+    }
+    if (!InitRenderInterp(&interp, world.ghosts.count))
+    {
+        CloseWindow();
+        return 1;
+    }
+    CaptureRenderInterp(&interp, &world);
+
+    // Muri e puntini pre-disegnati in texture (vedi render.h)
+    MapRenderCache mapCache = {0};
+    if (!InitMapRenderCache(&mapCache, &world, screenWidth, screenHeight))
+    {
+        CloseWindow();
+        return 1;
+    }
+
+    // Testi dell'interfaccia: si ridisegnano solo quando il valore cambia (vedi hud.h)
+    TextLabel scoreLabel, livesLabel, levelLabel, finalScoreLabel, gameOverLabel;
+    TextLabel restartLabel, homeLabel, exitLabel, replayLabel, autopilotLabel;
+    LoadTextLabel(&scoreLabel, "Score: %d", 20, WHITE);
+    LoadTextLabel(&livesLabel, "Lives: %d", 20, WHITE);
+    LoadTextLabel(&levelLabel, "Level: %d", 20, WHITE);
+    LoadTextLabel(&finalScoreLabel, "Final Score: %d", 20, WHITE);
+    LoadTextLabel(&gameOverLabel, "GAMEOVER", 40, RED);
+    LoadTextLabel(&restartLabel, "Restart", 20, WHITE);
+    LoadTextLabel(&homeLabel, "HOME", 20, WHITE);
+    LoadTextLabel(&exitLabel, "EXIT", 20, WHITE);
+    LoadTextLabel(&replayLabel, "REPLAY %dx (1/2/3)", 20, LIGHTGRAY);
+    LoadTextLabel(&autopilotLabel, "AUTOPILOT (F2)", 20, LIGHTGRAY);
+    SetTextLabelValue(&autopilotLabel, 0);
+    SetTextLabelValue(&gameOverLabel, 0);
+    SetTextLabelValue(&restartLabel, 0);
+    SetTextLabelValue(&homeLabel, 0);
+    SetTextLabelValue(&exitLabel, 0);
+    int finalScoreX = screenWidth / 2 - MeasureText("Final Score: 9999", 20) / 2;
 
     // === CICLO PRINCIPALE DEL GIOCO ===
     while (!WindowShouldClose()) // Continua fino a quando la finestra non viene chiusa
     {
+        ProfilerBeginFrame(&profiler);  // Il frame precedente va nel ring dei tempi
+
         // === GESTIONE STATI DEL GIOCO ===
         switch (currentState)
         {
@@ -178,17 +380,12 @@ int main(void)
                 static bool gameInitialized = false;
                 if (!gameInitialized)
                 {
-                    // Inizializza fantasmi
-                    for (int i = 0; i < NUM_GHOST; i++)
-                    {
-                        ghosts[i].pos = ghostStartPositions[i];
-                        ghosts[i].dir = (Vector2){GetRandomValue(-1, 1), GetRandomValue(-1, 1)};
-                        while (ghosts[i].dir.x == 0 && ghosts[i].dir.y == 0)
-                        {
-                            ghosts[i].dir = (Vector2){GetRandomValue(-1, 1), GetRandomValue(-1, 1)};
-                        }
-                        ghosts[i].color = ghostColors[i];
-                    }
+                    // Partita finita: ne comincia una nuova; altrimenti (ESC dal gioco)
+                    // riprende esattamente da dove era, cosi' la registrazione resta valida
+                    if (world.gameOver)
+                        ResetGame(RESTART);
+                    CaptureRenderInterp(&interp, &world);
+                    tickAccumulator = 0.0f;
                     gameInitialized = true;
                 }
                 
@@ -196,13 +393,15 @@ int main(void)
                 // (Tutto il codice di gioco esistente qui)
                 
                 // GameOver implementation
-                if (gameOver)
+                if (world.gameOver)
                 {
                     BeginDrawing();
                     ClearBackground(BLACK);
-                    DrawText("GAMEOVER", screenWidth / 2 - MeasureText("GAMEOVER", 40) / 2, screenHeight / 2 - 20, 40, RED);
-                    DrawText(TextFormat("Final Score: %d", score), screenWidth / 2 - MeasureText("Final Score: 9999", 20) / 2, screenHeight / 2 + 30, 20, WHITE);
-                    DrawText(TextFormat("Lives: %d", pacmanLives), 10, 35, 20, WHITE);
+                    SetTextLabelValue(&finalScoreLabel, world.score);
+                    SetTextLabelValue(&livesLabel, world.lives);
+                    DrawTextLabel(&gameOverLabel, screenWidth / 2 - gameOverLabel.width / 2, screenHeight / 2 - 20);
+                    DrawTextLabel(&finalScoreLabel, finalScoreX, screenHeight / 2 + 30);
+                    DrawTextLabel(&livesLabel, 10, 35);
                     
                     // Pulsante Restart centrato
                     int btnWidth = 140;
@@ -212,14 +411,13 @@ int main(void)
                     Rectangle resetBtn = {btnX, btnY, btnWidth, btnHeight};
                     DrawRectangleRec(resetBtn, DARKGRAY);
 
-                    int textWidth = MeasureText("Restart", 20);
-                    int textX = btnX + (btnWidth - textWidth) / 2;
+                    int textX = btnX + (btnWidth - restartLabel.width) / 2;
                     int textY = btnY + (btnHeight - 20) / 2;
-                    DrawText("Restart", textX, textY, 20, WHITE);
+                    DrawTextLabel(&restartLabel, textX, textY);
                     
                     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), resetBtn))
                     {
-                        ResetGame(ghostStartPositions, &pacmanPos, &score, RESTART);
+                        ResetGame(RESTART);
                     }
 
                     // Pulsante Home
@@ -227,16 +425,14 @@ int main(void)
                     Rectangle homeBtn = {btnX, homeBtnY, btnWidth, btnHeight};
                     DrawRectangleRec(homeBtn, DARKGRAY);
 
-                    int homeTextWidth = MeasureText("HOME", 20);
-                    int homeTextX = btnX + (btnWidth - homeTextWidth) / 2;
+                    int homeTextX = btnX + (btnWidth - homeLabel.width) / 2;
                     int homeTextY = homeBtnY + (btnHeight - 20) / 2;
-                    DrawText("HOME", homeTextX, homeTextY, 20, WHITE);
+                    DrawTextLabel(&homeLabel, homeTextX, homeTextY);
                     
                     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), homeBtn))
                     {
                         currentState = GAME_STATE_HOME;
-                        gameOver = false;
-                        gameInitialized = false;  // Reset per la prossima partita
+                        gameInitialized = false;  // Alla prossima partita riparte da zero
                     }
 
                     // Pulsante Exit
@@ -244,14 +440,13 @@ int main(void)
                     Rectangle exitBtn = {btnX, exitBtnY, btnWidth, btnHeight};
                     DrawRectangleRec(exitBtn, DARKGRAY);
 
-                    int exitTextWidth = MeasureText("EXIT", 20);
-                    int exitTextX = btnX + (btnWidth - exitTextWidth) / 2;
+                    int exitTextX = btnX + (btnWidth - exitLabel.width) / 2;
                     int exitTextY = exitBtnY + (btnHeight - 20) / 2;
-                    DrawText("EXIT", exitTextX, exitTextY, 20, WHITE);
+                    DrawTextLabel(&exitLabel, exitTextX, exitTextY);
                     
                     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), exitBtn))
                     {
-                        ResetGame(ghostStartPositions, &pacmanPos, &score, QUIT);
+                        ResetGame(QUIT);
                     }
                    
                     EndDrawing();
@@ -266,198 +461,173 @@ int main(void)
                     break;
                 }
         
-                // === AGGIORNAMENTO POWER-UP ===
-                UpdatePacman(); // Aggiorna logica power-up e spawn
-                
-                // === GESTIONE INPUT ===
-                // Ottieni velocità modificata dai power-up
-                float currentSpeed = GetModifiedSpeed(baseSpeed);
-                
-                // Calcola la prossima posizione di Pacman basata sui tasti premuti
-                Vector2 nextPos = pacmanPos; // Inizia dalla posizione corrente
-                if (IsKeyDown(KEY_RIGHT))
-                    nextPos.x += currentSpeed; // Muovi verso destra
-                if (IsKeyDown(KEY_LEFT))
-                    nextPos.x -= currentSpeed; // Muovi verso sinistra
-                if (IsKeyDown(KEY_UP))
-                    nextPos.y -= currentSpeed; // Muovi verso l'alto
-                if (IsKeyDown(KEY_DOWN))
-                    nextPos.y += currentSpeed; // Muovi verso il basso
-
-                // === COLLISION DETECTION CON I MURI ===
-                // Converte la posizione in pixel alle coordinate della mappa
-                int mapCol = (int)(nextPos.x) / TILE_SIZE; // Colonna nella mappa
-                int mapRow = (int)(nextPos.y) / TILE_SIZE; // Riga nella mappa
-
-                // Controlla se la posizione è valida e non è un muro
-                if (mapRow >= 0 && mapRow < MAP_ROWS && // Dentro i limiti verticali
-                    mapCol >= 0 && mapCol < MAP_COLS && // Dentro i limiti orizzontali
-                    map[mapRow][mapCol] != '#')         // Non è un muro
+                // === AGGIORNAMENTO SIMULAZIONE A PASSO FISSO ===
+                // Power-up, movimento di Pacman, fantasmi e collisioni: tanti tick del World
+                // quanti ne stanno nel tempo reale trascorso (zero, uno o piu' per frame)
+                // (in replay il tempo scorre replaySpeed volte piu' veloce)
+                ProfilerBegin(&profiler, PROFILE_INPUT);
+                int speed = replaying ? replaySpeed : 1;
+                if (replaying)
                 {
-                    pacmanPos = nextPos; // Aggiorna la posizione di Pacman
-
-                    // === CONTROLLO RACCOLTA POWER-UP ===
-                    CheckPowerUpCollection(pacmanPos, &score, &pacmanLives);
-
-                    // === MECCANICA DI RACCOLTA PUNTINI ===
-                    // Se Pacman è su un puntino, lo mangia
-                    if (map[mapRow][mapCol] == '.')
-                    {
-                        map[mapRow][mapCol] = ' '; // Rimuovi il puntino dalla mappa
-                        score += 10 * GetScoreMultiplier(); // Incrementa il punteggio (con moltiplicatore)
-                    }
+                    if (IsKeyPressed(KEY_ONE)) replaySpeed = 1;
+                    if (IsKeyPressed(KEY_TWO)) replaySpeed = 4;
+                    if (IsKeyPressed(KEY_THREE)) replaySpeed = 16;
                 }
+                tickAccumulator += GetFrameTime() * speed;
+                if (tickAccumulator > maxFrameSeconds * speed)
+                    tickAccumulator = maxFrameSeconds * speed;
 
-                // === LOGICA DEI FANTASMI ===
-                // Muove ogni fantasma e gestisce le collisioni
-                for (int i = 0; i < NUM_GHOST; i++)
+                // F5 salva la partita, F9 la ricarica (non durante un replay)
+                if (IsKeyPressed(KEY_F5))
                 {
-                    Ghost *g = &ghosts[i]; // Puntatore al fantasma
-
-                    // Calcola le coordinate della cella corrente del fantasma
-                    int ghostCol = (int)(g->pos.x) / TILE_SIZE;
-                    int ghostRow = (int)(g->pos.y) / TILE_SIZE;
-
-                    // Calcola le coordinate della cella corrente di Pacman
-                    int pacCol = (int)(pacmanPos.x) / TILE_SIZE;
-                    int pacRow = (int)(pacmanPos.y) / TILE_SIZE;
-
-                    // Se il fantasma è allineato su una cella (per evitare continui cambi direzione a metà cella)
-                    if ((int)g->pos.x % TILE_SIZE == TILE_SIZE / 2 && (int)g->pos.y % TILE_SIZE == TILE_SIZE / 2)
-                    {
-                        Vector2 directions[4] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-                        Vector2 bestDir = g->dir; // Direzione attuale come default
-                        float bestDistance = 999999.0f;
-
-                        for (int d = 0; d < 4; d++)
-                        {
-                            Vector2 testDir = directions[d];
-                            if (testDir.x == -g->dir.x && testDir.y == -g->dir.y)
-                                continue; // Evita inversioni
-
-                            if (IsDirectionValid(g->pos, testDir))
-                            {
-                                Vector2 nextPos = {
-                                    g->pos.x + testDir.x * TILE_SIZE,
-                                    g->pos.y + testDir.y * TILE_SIZE};
-                                float dx = (pacmanPos.x - nextPos.x);
-                                float dy = (pacmanPos.y - nextPos.y);
-                                float dist = dx * dx + dy * dy;
-
-                                if (dist < bestDistance)
-                                {
-                                    bestDistance = dist;
-                                    bestDir = testDir;
-                                }
-                            }
-                        }
-
-                        g->dir = bestDir;
-                    }
+                    SnapshotSave(&world, quickSave);
+                    hasQuickSave = true;
+                }
+                if (IsKeyPressed(KEY_F9) && hasQuickSave && !replaying)
+                {
+                    AbandonRecording();
+                    SnapshotLoad(&world, quickSave);
+                    ClearSnapshotRing(&rewindRing);  // Il passato recente e' quello di un'altra linea temporale
+                    CaptureRenderInterp(&interp, &world);
+                }
 
-                    // Muove il fantasma nella nuova direzione
-                    float ghostSpeed = GetGhostSpeed(baseSpeed); // Velocità modificata dai power-up
-                    Vector2 nextPos = {
-                        g->pos.x + g->dir.x * ghostSpeed,
-                        g->pos.y + g->dir.y * ghostSpeed};
+                // BACKSPACE tenuto premuto: la partita scorre all'indietro, un tick alla volta
+                bool rewinding = IsKeyDown(KEY_BACKSPACE) && !replaying;
+                if (rewinding && rewindRing.count > 0)
+                    AbandonRecording();
 
-                    int col = (int)(nextPos.x) / TILE_SIZE;
-                    int row = (int)(nextPos.y) / TILE_SIZE;
+                // F2 accende e spegne l'autopilota (se e' partito)
+                if (IsKeyPressed(KEY_F2) && autopilot.numThreads > 0)
+                    autopilotActive = !autopilotActive;
 
-                    if (map[row][col] != '#')
-                    {
-                        g->pos = nextPos;
-                    }
+                // F3 overlay dei tempi, F4 salva gli ultimi frame in CSV
+                if (IsKeyPressed(KEY_F3))
+                    showProfiler = !showProfiler;
+                if (IsKeyPressed(KEY_F4))
+                {
+                    if (DumpFrameProfilerCsv(&profiler, PROFILE_CSV_PATH))
+                        fprintf(stderr, "Tempi degli ultimi %d frame salvati in %s\n", profiler.count, PROFILE_CSV_PATH);
                     else
+                        fprintf(stderr, "Errore: impossibile scrivere %s\n", PROFILE_CSV_PATH);
+                }
+
+                SimInput input = ReadPlayerInput();
+                ProfilerEnd(&profiler, PROFILE_INPUT);
+                while (rewinding && tickAccumulator >= tickSeconds)
+                {
+                    CaptureRenderInterp(&interp, &world);
+                    if (!PopSnapshot(&rewindRing, &world))
                     {
-                        g->dir.x *= -1;
-                        g->dir.y *= -1;
+                        tickAccumulator = 0.0f;  // Inizio del ring: la partita resta ferma
+                        break;
                     }
+                    tickAccumulator -= tickSeconds;
                 }
-
-                // === CONTROLLO COLLISIONI CON FANTASMI ===
-                // Solo se Pacman non è invincibile
-                if (!IsPacmanInvincible())
+                while (!rewinding && tickAccumulator >= tickSeconds && !world.gameOver)
                 {
-                    for (int i = 0; i < NUM_GHOST; i++)
+                    // Replay: l'input del tick viene dalla registrazione (finita = partita ferma)
+                    if (replaying && !ReplayNext(&replayCursor, &input))
                     {
-                        if (CheckPacmanCollision(pacmanPos, ghosts[i].pos))
-                        {
-                            pacmanLives--;
-                            if (pacmanLives == 0)
-                            {
-                                gameOver = true;
-                            }
-                            else
-                            {
-                                // Reset Pacman e fantasmi
-                                pacmanPos = (Vector2){1 * TILE_SIZE + TILE_SIZE / 2.0f, 1 * TILE_SIZE + TILE_SIZE / 2.0f};
-
-                                for (int j = 0; j < NUM_GHOST; j++)
-                                {
-                                    ghosts[j].pos = ghostStartPositions[j];
-                                    ghosts[j].dir = (Vector2){GetRandomValue(-1, 1), GetRandomValue(-1, 1)};
-                                    while (ghosts[j].dir.x == 0 && ghosts[j].dir.y == 0)
-                                    {
-                                        ghosts[j].dir = (Vector2){GetRandomValue(-1, 1), GetRandomValue(-1, 1)};
-                                    }
-                                }
-                            }
-                            break;
-                        }
+                        tickAccumulator = 0.0f;
+                        break;
                     }
+                    // Autopilota: cerca una mossa quando Pacman arriva al centro di una cella
+                    if (autopilotActive && !replaying)
+                        input = AutopilotInput(&autopilot, &world);
+                    if (recordingActive && !replaying)
+                        ReplayRecord(&recording, input);
+
+                    PushSnapshot(&rewindRing, &world);
+                    CaptureRenderInterp(&interp, &world);
+                    SimStep(&world, input);
+                    tickAccumulator -= tickSeconds;
                 }
+                if (world.gameOver)
+                    FinishRecording();
+                float alpha = tickAccumulator / tickSeconds;  // Frazione del tick successivo gia' trascorsa
+
+                // === CAMERA ===
+                // Segue Pacman; si disegna solo cio' che sta nelle celle inquadrate
+                Vector2 pacmanDrawPos = InterpolatePosition(interp.pacman, world.pacmanPos, alpha);
+                Camera2D camera = FollowCamera(&world, pacmanDrawPos, screenWidth, screenHeight);
+                TileRange visibleTiles = GetVisibleTiles(&world, camera, screenWidth, screenHeight, 0);
+                // Fantasmi e power-up sporgono dalla loro cella e sono disegnati a meta' tick:
+                // si prende qualche cella in piu' per non farli sparire sul bordo
+                TileRange visibleEntities = GetVisibleTiles(&world, camera, screenWidth, screenHeight, 2);
 
                 // === RENDERING ===
+                ProfilerBegin(&profiler, PROFILE_MAP);
+                UpdateMapRenderCache(&mapCache, &world, visibleTiles); // Aggiorna solo i puntini mangiati
+
                 BeginDrawing();         // Inizia il frame di rendering
                 ClearBackground(BLACK); // Pulisce lo schermo con sfondo nero
+                BeginMode2D(camera);
 
                 // === DISEGNO DELLA MAPPA ===
-                // Itera attraverso ogni cella della mappa
-                for (int row = 0; row < MAP_ROWS; row++)
-                {
-                    for (int col = 0; col < MAP_COLS; col++)
-                    {
-                        char cell = map[row][col]; // Carattere della cella corrente
-                        int x = col * TILE_SIZE;   // Posizione X in pixel
-                        int y = row * TILE_SIZE;   // Posizione Y in pixel
-
-                        if (cell == '#')                                               // Se è un muro
-                            DrawRectangle(x, y, TILE_SIZE, TILE_SIZE, DARKBLUE);       // Disegna rettangolo blu
-                        else if (cell == '.')                                          // Se è un puntino
-                            DrawCircle(x + TILE_SIZE / 2, y + TILE_SIZE / 2, 5, GOLD); // Disegna cerchio dorato
-                        // Le celle vuote (' ') non vengono disegnate (rimangono nere)
-                    }
-                }
+                // Muri e puntini dalla cache: due texture invece di un draw call per cella
+                DrawMapRenderCache(&mapCache);
+                ProfilerEnd(&profiler, PROFILE_MAP);
 
                 // === DISEGNO DEI POWER-UP ===
-                DrawPacman(); // Disegna tutti i power-up attivi
+                ProfilerBegin(&profiler, PROFILE_ENTITIES);
+                DrawPacman(visibleEntities); // Disegna i power-up attivi visibili
 
                 // === DISEGNO DEI FANTASMI ===
-                // Disegna ogni fantasma come un cerchio colorato
-                for (int i = 0; i < NUM_GHOST; i++)
+                // Disegna ogni fantasma visibile come un cerchio colorato
+                // (la griglia dei fantasmi da' quelli delle celle inquadrate)
+                for (int row = visibleEntities.row0; row <= visibleEntities.row1; row++)
                 {
-                    DrawCircleV(ghosts[i].pos, pacmanRadius, ghosts[i].color);
+                    for (int col = visibleEntities.col0; col <= visibleEntities.col1; col++)
+                    {
+                        for (int i = world.ghostGrid.head[MapCell(&world.map, row, col)]; i != GRID_NONE; i = world.ghostGrid.next[i])
+                        {
+                            Vector2 previous = {interp.ghostX[i], interp.ghostY[i]};
+                            DrawCircleV(InterpolatePosition(previous, SimGhostPos(&world, i), alpha), pacmanRadius, ghostColors[i % NUM_GHOST]);
+                        }
+                    }
                 }
 
                 // === DISEGNO DI PACMAN ===
                 // Disegna Pacman come un cerchio giallo (con effetto se invincibile)
-                Color pacmanColor = IsPacmanInvincible() ? 
+                Color pacmanColor = IsPacmanInvincible(&world) ? 
                     (sinf(GetTime() * 10) > 0 ? YELLOW : WHITE) : YELLOW;
-                DrawCircleV(pacmanPos, pacmanRadius, pacmanColor);
+                DrawCircleV(pacmanDrawPos, pacmanRadius, pacmanColor);
+                EndMode2D();
+                ProfilerEnd(&profiler, PROFILE_ENTITIES);
 
                 // === INTERFACCIA UTENTE ===
                 // Mostra il punteggio nell'angolo superiore sinistro
-                DrawText(TextFormat("Score: %d", score), 10, 10, 20, WHITE);
+                // (le etichette si riformattano solo quando il valore cambia)
+                ProfilerBegin(&profiler, PROFILE_HUD);
+                SetTextLabelValue(&scoreLabel, world.score);
+                SetTextLabelValue(&levelLabel, world.levelNumber);
+                SetTextLabelValue(&livesLabel, world.lives);
+                DrawTextLabel(&scoreLabel, 10, 10);
+                // Livello in alto al centro
+                DrawTextLabel(&levelLabel, screenWidth / 2 - levelLabel.width / 2, 10);
                 // Vite in alto a destra
-                const char* livesText = TextFormat("Lives: %d", pacmanLives);
-                int livesTextWidth = MeasureText(livesText, 20);
-                DrawText(livesText, screenWidth - livesTextWidth - 10, 10, 20, WHITE);
+                DrawTextLabel(&livesLabel, screenWidth - livesLabel.width - 10, 10);
 
                 // === INDICATORI POWER-UP ===
                 DrawPowerUpIndicators(screenWidth);
 
+                // Velocita' del replay in basso a sinistra
+                if (replaying)
+                {
+                    SetTextLabelValue(&replayLabel, replaySpeed);
+                    DrawTextLabel(&replayLabel, 10, screenHeight - 30);
+                }
+                else if (autopilotActive)
+                    DrawTextLabel(&autopilotLabel, 10, screenHeight - 30);
+
+                // Overlay dei tempi sotto gli indicatori dei power-up
+                if (showProfiler)
+                    DrawProfilerOverlay(&profiler, 10, 120);
+                ProfilerEnd(&profiler, PROFILE_HUD);
+
+                ProfilerBegin(&profiler, PROFILE_PRESENT);
                 EndDrawing(); // Termina il frame di rendering
+                ProfilerEnd(&profiler, PROFILE_PRESENT);
                 break;
             }
             
@@ -469,9 +639,37 @@ int main(void)
                 // Non implementato in questa versione
                 break;
         }
+
+        // Cambio di schermata: evento nella traccia
+        if (currentState != tracedState)
+        {
+            TraceInstant(GameStateTraceName(currentState), "state", currentState);
+            tracedState = currentState;
+        }
     }
 
     // === PULIZIA E CHIUSURA ===
+    UnloadMapRenderCache(&mapCache);
+    UnloadTextLabel(&scoreLabel);
+    UnloadTextLabel(&livesLabel);
+    UnloadTextLabel(&levelLabel);
+    UnloadTextLabel(&finalScoreLabel);
+    UnloadTextLabel(&gameOverLabel);
+    UnloadTextLabel(&restartLabel);
+    UnloadTextLabel(&homeLabel);
+    UnloadTextLabel(&exitLabel);
+    UnloadTextLabel(&replayLabel);
+    UnloadTextLabel(&autopilotLabel);
+    FinishRecording();
+    FinishTrace();
+    ReplayFree(&replay);
+    FreeSnapshotRing(&rewindRing);
+    free(quickSave);
+    UnloadRenderInterp(&interp);
+    FreeAutopilot(&autopilot);
+    FreeGhostPool(&ghostPool);
+    SimDestroy(&world);
+    MazeFree(&maze);
     CloseWindow(); // Chiude la finestra e libera le risorse
     return 0;      // Termina il programma con successo
 }
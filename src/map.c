@@ -0,0 +1,341 @@
+// === MAPPA A BITBOARD ===
+#include "lib/map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// === LABIRINTO DA FILE ===
+
+// FNV-1a a 64 bit: impronta del labirinto
+static unsigned long long HashBytes(unsigned long long hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// Legge un intero positivo; ritorna -1 se non c'e'
+static int ParseDimension(const char **cursor, const char *end)
+{
+    const char *p = *cursor;
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    int value = 0, digits = 0;
+    while (p < end && *p >= '0' && *p <= '9' && value <= MAP_MAX_SIZE)
+    {
+        value = value * 10 + (*p - '0');
+        digits++;
+        p++;
+    }
+    *cursor = p;
+    return digits > 0 ? value : -1;
+}
+
+bool MazeAlloc(Maze *maze, int rows, int cols)
+{
+    memset(maze, 0, sizeof(*maze));
+    if (cols < 1 || rows < 1 || cols > MAP_MAX_SIZE || rows > MAP_MAX_SIZE)
+        return false;
+
+    int words = (cols + 63) / 64;
+    size_t numWords = (size_t)rows * (size_t)words;
+    maze->walls = malloc(sizeof(MapWord) * numWords);
+    maze->dots = calloc(numWords, sizeof(MapWord));
+    if (!maze->walls || !maze->dots)
+    {
+        MazeFree(maze);
+        return false;
+    }
+    memset(maze->walls, 0xFF, sizeof(MapWord) * numWords);
+    maze->rows = rows;
+    maze->cols = cols;
+    maze->words = words;
+    maze->pacmanStart = -1;
+    for (int i = 0; i < MAZE_MAX_GHOST_STARTS; i++)
+        maze->ghostStarts[i] = -1;
+    return true;
+}
+
+unsigned long long MazeHash(const Maze *maze)
+{
+    size_t numWords = (size_t)maze->rows * (size_t)maze->words;
+    unsigned long long hash = 0xCBF29CE484222325ull;
+    hash = HashBytes(hash, &maze->rows, sizeof(maze->rows));
+    hash = HashBytes(hash, &maze->cols, sizeof(maze->cols));
+    hash = HashBytes(hash, maze->walls, sizeof(MapWord) * numWords);
+    hash = HashBytes(hash, maze->dots, sizeof(MapWord) * numWords);
+    hash = HashBytes(hash, &maze->pacmanStart, sizeof(maze->pacmanStart));
+    hash = HashBytes(hash, maze->ghostStarts, sizeof(int) * (size_t)maze->numGhostStarts);
+    return hash;
+}
+
+bool MazeParse(Maze *maze, const char *text, size_t size)
+{
+    memset(maze, 0, sizeof(*maze));
+    const char *p = text;
+    const char *end = text + size;
+
+    // Intestazione: colonne e righe
+    int cols = ParseDimension(&p, end);
+    int rows = ParseDimension(&p, end);
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    if (p >= end || *p != '\n')
+        return false;
+    p++;
+
+    // Parte tutto muro, poi apre le celle del testo
+    if (!MazeAlloc(maze, rows, cols))
+        return false;
+    int words = maze->words;
+    size_t numWords = (size_t)rows * (size_t)words;
+
+    // Una sola passata sul testo, un carattere alla volta
+    int row = 0, col = 0;
+    bool ok = true;
+    for (; p < end && ok; p++)
+    {
+        char c = *p;
+        if (c == '\n')
+        {
+            row++;
+            col = 0;
+            continue;
+        }
+        if (c == '\r')
+            continue;
+        if (row >= rows || col >= cols)
+        {
+            ok = false;   // Riga piu' lunga o righe in piu' rispetto all'intestazione
+            break;
+        }
+
+        size_t index = (size_t)row * (size_t)words + (size_t)(col >> 6);
+        MapWord bit = 1ull << (col & 63);
+        int cell = row * cols + col;
+        switch (c)
+        {
+            case '#':
+                break;
+            case ' ':
+                maze->walls[index] &= ~bit;
+                break;
+            case 'P':
+                ok = maze->pacmanStart < 0;
+                maze->pacmanStart = cell;
+                maze->walls[index] &= ~bit;
+                maze->dots[index] |= bit;
+                break;
+            case '.':
+                maze->walls[index] &= ~bit;
+                maze->dots[index] |= bit;
+                break;
+            default:
+                if (c >= '1' && c <= '0' + MAZE_MAX_GHOST_STARTS && maze->ghostStarts[c - '1'] < 0)
+                {
+                    maze->ghostStarts[c - '1'] = cell;
+                    maze->walls[index] &= ~bit;
+                    maze->dots[index] |= bit;
+                }
+                else
+                {
+                    ok = false;   // Carattere sconosciuto o partenza ripetuta
+                }
+                break;
+        }
+        col++;
+    }
+
+    // Partenze dei fantasmi: '1'..'k' senza buchi
+    while (maze->numGhostStarts < MAZE_MAX_GHOST_STARTS && maze->ghostStarts[maze->numGhostStarts] >= 0)
+        maze->numGhostStarts++;
+    for (int i = maze->numGhostStarts; i < MAZE_MAX_GHOST_STARTS; i++)
+        ok = ok && maze->ghostStarts[i] < 0;
+
+    // Senza 'P' Pacman parte dalla prima cella aperta
+    for (int index = 0; ok && maze->pacmanStart < 0 && index < (int)numWords; index++)
+    {
+        if (~maze->walls[index])
+            maze->pacmanStart = (index / words) * cols + (index % words) * 64 + __builtin_ctzll(~maze->walls[index]);
+    }
+    if (!ok || maze->pacmanStart < 0)
+    {
+        MazeFree(maze);
+        return false;
+    }
+
+    maze->hash = MazeHash(maze);
+    return true;
+}
+
+bool MazeLoadFile(Maze *maze, const char *path)
+{
+    memset(maze, 0, sizeof(*maze));
+
+#if defined(_WIN32)
+    // Niente mmap: il file viene letto tutto in memoria
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = size > 0 ? malloc((size_t)size) : NULL;
+    bool ok = text && fread(text, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    ok = ok && MazeParse(maze, text, (size_t)size);
+    free(text);
+    return ok;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    // Il parser legge il file una volta, in ordine: il kernel puo' leggere in anticipo
+    void *text = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (text == MAP_FAILED)
+        return false;
+    madvise(text, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    bool ok = MazeParse(maze, text, (size_t)st.st_size);
+    munmap(text, (size_t)st.st_size);
+    return ok;
+#endif
+}
+
+bool MazeSaveFile(const Maze *maze, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    // Una riga di testo alla volta, nello stesso formato letto da MazeParse
+    char *line = malloc((size_t)maze->cols + 1);
+    bool ok = line && fprintf(file, "%d %d\n", maze->cols, maze->rows) > 0;
+    for (int row = 0; ok && row < maze->rows; row++)
+    {
+        const MapWord *walls = maze->walls + (size_t)row * (size_t)maze->words;
+        const MapWord *dots = maze->dots + (size_t)row * (size_t)maze->words;
+        for (int col = 0; col < maze->cols; col++)
+        {
+            MapWord bit = 1ull << (col & 63);
+            line[col] = (walls[col >> 6] & bit) ? '#' : (dots[col >> 6] & bit) ? '.' : ' ';
+        }
+        int rowStart = row * maze->cols;
+        if (maze->pacmanStart >= rowStart && maze->pacmanStart < rowStart + maze->cols)
+            line[maze->pacmanStart - rowStart] = 'P';
+        for (int i = 0; i < maze->numGhostStarts; i++)
+        {
+            if (maze->ghostStarts[i] >= rowStart && maze->ghostStarts[i] < rowStart + maze->cols)
+                line[maze->ghostStarts[i] - rowStart] = (char)('1' + i);
+        }
+        line[maze->cols] = '\n';
+        ok = fwrite(line, 1, (size_t)maze->cols + 1, file) == (size_t)maze->cols + 1;
+    }
+    free(line);
+    return fclose(file) == 0 && ok;
+}
+
+void MazeFree(Maze *maze)
+{
+    free(maze->walls);
+    free(maze->dots);
+    memset(maze, 0, sizeof(*maze));
+}
+
+// === STATO DELLA MAPPA ===
+
+size_t MapMemorySize(const Maze *maze)
+{
+    size_t numWords = (size_t)maze->rows * (size_t)maze->words;
+    size_t numCells = (size_t)maze->rows * (size_t)maze->cols;
+    return ArenaSize(sizeof(MapWord) * numWords) + 2 * ArenaSize(sizeof(int) * numCells);
+}
+
+bool MapAlloc(MapBits *map, const Maze *maze, Arena *arena)
+{
+    memset(map, 0, sizeof(*map));
+    size_t numWords = (size_t)maze->rows * (size_t)maze->words;
+    size_t numCells = (size_t)maze->rows * (size_t)maze->cols;
+
+    map->dots = ArenaAlloc(arena, sizeof(MapWord) * numWords);
+    map->freeCells = ArenaAlloc(arena, sizeof(int) * numCells);
+    map->freeSlot = ArenaAlloc(arena, sizeof(int) * numCells);
+    if (!map->dots || !map->freeCells || !map->freeSlot)
+    {
+        memset(map, 0, sizeof(*map));
+        return false;
+    }
+
+    map->rows = maze->rows;
+    map->cols = maze->cols;
+    map->words = maze->words;
+    map->walls = maze->walls;
+    for (size_t index = 0; index < numWords; index++)
+        map->numOpenCells += __builtin_popcountll(~maze->walls[index]);   // Oltre l'ultima colonna e' muro
+    MapReset(map, maze);
+    return true;
+}
+
+void MapReset(MapBits *map, const Maze *maze)
+{
+    int numWords = map->rows * map->words;
+    memcpy(map->dots, maze->dots, sizeof(MapWord) * (size_t)numWords);
+
+    map->dotsLeft = 0;
+    for (int index = 0; index < numWords; index++)
+        map->dotsLeft += __builtin_popcountll(map->dots[index]);
+
+    // Le celle vuote fin dall'inizio vanno subito nell'indice (in ordine di riga)
+    for (int cell = 0; cell < map->rows * map->cols; cell++)
+        map->freeSlot[cell] = MAP_NO_SLOT;
+    map->numFreeCells = 0;
+    for (int index = 0; index < numWords; index++)
+    {
+        int base = (index / map->words) * map->cols + (index % map->words) * 64;
+        for (MapWord free = MapFreeWord(map, index); free; free &= free - 1)
+            MapAddFreeCell(map, base + __builtin_ctzll(free));
+    }
+}
+
+int MapCountDotsInRegion(const MapBits *map, int row0, int col0, int row1, int col1)
+{
+    if (row0 < 0) row0 = 0;
+    if (col0 < 0) col0 = 0;
+    if (row1 >= map->rows) row1 = map->rows - 1;
+    if (col1 >= map->cols) col1 = map->cols - 1;
+    if (row0 > row1 || col0 > col1)
+        return 0;
+
+    int count = 0;
+    for (int row = row0; row <= row1; row++)
+    {
+        // Parola per parola, con la maschera delle colonne col0..col1 che cadono in ognuna
+        for (int word = col0 >> 6; word <= (col1 >> 6); word++)
+        {
+            int lo = word == (col0 >> 6) ? (col0 & 63) : 0;
+            int hi = word == (col1 >> 6) ? (col1 & 63) : 63;
+            MapWord mask = (hi - lo == 63 ? ~0ull : ((1ull << (hi - lo + 1)) - 1ull)) << lo;
+            count += __builtin_popcountll(map->dots[row * map->words + word] & mask);
+        }
+    }
+    return count;
+}
@@ -0,0 +1,196 @@
+// === GENERATORE DI LABIRINTI ===
+#include "lib/mazegen.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ODD_COLUMNS  0xAAAAAAAAAAAAAAAAull   // Bit delle colonne dispari di una parola
+#define EVEN_COLUMNS 0x5555555555555555ull   // Bit delle colonne pari di una parola
+
+// splitmix64: veloce e con tutti i 64 bit buoni, per non dipendere dal rand() di sistema
+static unsigned long long NextRandom(unsigned long long *state)
+{
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Intero uniforme in [0, n)
+static int RandomBelow(unsigned long long *state, int n)
+{
+    return (int)(((NextRandom(state) >> 32) * (unsigned long long)n) >> 32);
+}
+
+// Bit della parola word che corrispondono alle colonne from..to (estremi inclusi)
+static MapWord ColumnRange(int word, int from, int to)
+{
+    int lo = from - word * 64;
+    int hi = to - word * 64;
+    if (hi < 0 || lo > 63 || from > to)
+        return 0;
+    if (lo < 0) lo = 0;
+    if (hi > 63) hi = 63;
+    return (hi - lo == 63 ? ~0ull : ((1ull << (hi - lo + 1)) - 1ull)) << lo;
+}
+
+static inline void OpenCell(Maze *maze, int row, int col)
+{
+    maze->walls[(size_t)row * (size_t)maze->words + (size_t)(col >> 6)] &= ~(1ull << (col & 63));
+}
+
+static inline bool IsWall(const Maze *maze, int row, int col)
+{
+    return (maze->walls[(size_t)row * (size_t)maze->words + (size_t)(col >> 6)] >> (col & 63)) & 1ull;
+}
+
+// Apre le celle della riga row nelle colonne from..to con la parita' di columns,
+// solo dove mask vale 1 (mask = ~0 per aprirle tutte)
+static void OpenColumns(Maze *maze, int row, int from, int to, MapWord columns, MapWord mask)
+{
+    MapWord *walls = maze->walls + (size_t)row * (size_t)maze->words;
+    for (int word = from >> 6; word <= (to >> 6); word++)
+        walls[word] &= ~(ColumnRange(word, from, to) & columns & mask);
+}
+
+// Passo 1: albero ricoprente del reticolo con l'algoritmo sidewinder. La prima riga
+// e' un corridoio unico; nelle altre ogni tratto orizzontale si collega alla riga
+// sopra da una sua cella a caso. Una riga alla volta, senza pile ne' liste.
+static void CarveSpanningTree(Maze *maze, int latticeRows, int latticeCols, unsigned long long *rng)
+{
+    int lastCol = 2 * latticeCols - 1;
+    for (int j = 0; j < latticeRows; j++)
+        OpenColumns(maze, 2 * j + 1, 1, lastCol, ODD_COLUMNS, ~0ull);
+    OpenColumns(maze, 1, 2, lastCol - 1, EVEN_COLUMNS, ~0ull);
+
+    for (int j = 1; j < latticeRows; j++)
+    {
+        int row = 2 * j + 1;
+        int runStart = 0;
+        unsigned long long bits = 0;
+        int bitsLeft = 0;
+        for (int i = 0; i < latticeCols; i++)
+        {
+            if (bitsLeft == 0)
+            {
+                bits = NextRandom(rng);
+                bitsLeft = 64;
+            }
+            bool closeRun = i == latticeCols - 1 || (bits & 1ull);
+            bits >>= 1;
+            bitsLeft--;
+
+            if (closeRun)
+            {
+                int k = runStart + RandomBelow(rng, i - runStart + 1);
+                OpenCell(maze, row - 1, 2 * k + 1);   // Passaggio verso la riga sopra
+                runStart = i + 1;
+            }
+            else
+            {
+                OpenCell(maze, row, 2 * i + 2);       // Il tratto continua a destra
+            }
+        }
+    }
+}
+
+// Passo 2: apre circa un muro interno su otto (tre parole casuali in AND per 64 celle)
+static void CarveLoops(Maze *maze, int latticeRows, int latticeCols, unsigned long long *rng)
+{
+    int lastRow = 2 * latticeRows - 1;
+    int lastCol = 2 * latticeCols - 1;
+    for (int row = 1; row <= lastRow; row++)
+    {
+        // Righe di incroci: muri tra due colonne di incroci; righe pari: muri tra due righe
+        bool crossings = row & 1;
+        int from = crossings ? 2 : 1;
+        int to = crossings ? lastCol - 1 : lastCol;
+        MapWord columns = crossings ? EVEN_COLUMNS : ODD_COLUMNS;
+        MapWord *walls = maze->walls + (size_t)row * (size_t)maze->words;
+        for (int word = from >> 6; word <= (to >> 6); word++)
+        {
+            MapWord mask = NextRandom(rng) & NextRandom(rng) & NextRandom(rng);
+            walls[word] &= ~(ColumnRange(word, from, to) & columns & mask);
+        }
+    }
+}
+
+// Passo 3: ogni incrocio con una sola uscita ne riceve un'altra verso un vicino a caso
+static void RemoveDeadEnds(Maze *maze, int latticeRows, int latticeCols, unsigned long long *rng)
+{
+    for (int j = 0; j < latticeRows; j++)
+    {
+        int row = 2 * j + 1;
+        for (int i = 0; i < latticeCols; i++)
+        {
+            int col = 2 * i + 1;
+            int exits = !IsWall(maze, row - 1, col) + !IsWall(maze, row + 1, col) +
+                        !IsWall(maze, row, col - 1) + !IsWall(maze, row, col + 1);
+            if (exits > 1)
+                continue;
+
+            // Muri che portano a un altro incrocio (mai il bordo)
+            int closed[4][2];
+            int numClosed = 0;
+            if (j > 0 && IsWall(maze, row - 1, col))               { closed[numClosed][0] = row - 1; closed[numClosed++][1] = col; }
+            if (j < latticeRows - 1 && IsWall(maze, row + 1, col)) { closed[numClosed][0] = row + 1; closed[numClosed++][1] = col; }
+            if (i > 0 && IsWall(maze, row, col - 1))               { closed[numClosed][0] = row; closed[numClosed++][1] = col - 1; }
+            if (i < latticeCols - 1 && IsWall(maze, row, col + 1)) { closed[numClosed][0] = row; closed[numClosed++][1] = col + 1; }
+            if (numClosed > 0)
+            {
+                int pick = RandomBelow(rng, numClosed);
+                OpenCell(maze, closed[pick][0], closed[pick][1]);
+            }
+        }
+    }
+}
+
+bool MazeGenerate(Maze *maze, int cols, int rows, unsigned int seed)
+{
+    memset(maze, 0, sizeof(*maze));
+    if (cols < MAZE_GEN_MIN_SIZE || rows < MAZE_GEN_MIN_SIZE || cols > MAP_MAX_SIZE || rows > MAP_MAX_SIZE)
+        return false;
+    if (!MazeAlloc(maze, rows, cols))
+        return false;
+
+    // Incroci: celle (2j + 1, 2i + 1), sempre dentro il bordo
+    int latticeRows = (rows - 1) / 2;
+    int latticeCols = (cols - 1) / 2;
+    unsigned long long rng = seed;
+
+    CarveSpanningTree(maze, latticeRows, latticeCols, &rng);
+    CarveLoops(maze, latticeRows, latticeCols, &rng);
+    RemoveDeadEnds(maze, latticeRows, latticeCols, &rng);
+
+    // Un puntino in ogni corridoio (i bit oltre l'ultima colonna sono muro)
+    size_t numWords = (size_t)rows * (size_t)maze->words;
+    for (size_t index = 0; index < numWords; index++)
+        maze->dots[index] = ~maze->walls[index];
+
+    // Pacman al centro, i fantasmi negli angoli
+    maze->pacmanStart = (2 * (latticeRows / 2) + 1) * cols + 2 * (latticeCols / 2) + 1;
+    int lastRow = 2 * latticeRows - 1;
+    int lastCol = 2 * latticeCols - 1;
+    maze->ghostStarts[0] = 1 * cols + 1;
+    maze->ghostStarts[1] = 1 * cols + lastCol;
+    maze->ghostStarts[2] = lastRow * cols + 1;
+    maze->ghostStarts[3] = lastRow * cols + lastCol;
+    maze->numGhostStarts = 4;
+
+    maze->hash = MazeHash(maze);
+    return true;
+}
+
+bool MazeParseSize(const char *text, int *cols, int *rows)
+{
+    char *end;
+    long c = strtol(text, &end, 10);
+    if (end == text || (*end != 'x' && *end != 'X'))
+        return false;
+    const char *second = end + 1;
+    long r = strtol(second, &end, 10);
+    if (end == second || *end != '\0' || c < 1 || r < 1 || c > MAP_MAX_SIZE || r > MAP_MAX_SIZE)
+        return false;
+    *cols = (int)c;
+    *rows = (int)r;
+    return true;
+}
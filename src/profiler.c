@@ -0,0 +1,109 @@
+// === TEMPI DELLE FASI DI OGNI FRAME ===
+#include "lib/profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void InitFrameProfiler(FrameProfiler *profiler)
+{
+    memset(profiler, 0, sizeof(*profiler));
+    profiler->frameStart = ProfilerNow();
+}
+
+void ProfilerBeginFrame(FrameProfiler *profiler)
+{
+    double now = ProfilerNow();
+
+    // Il frame appena finito va nel ring (sovrascrive il piu' vecchio se e' pieno)
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++)
+        profiler->phaseMs[profiler->head][phase] = (float)profiler->current[phase];
+    profiler->frameMs[profiler->head] = (float)(now - profiler->frameStart);
+    if (TraceEnabled())
+        TraceComplete("frame", (unsigned long long)(profiler->frameStart * 1e6),
+                      (unsigned long long)((now - profiler->frameStart) * 1e6), "frame", (long long)profiler->frames);
+    profiler->head = (profiler->head + 1) % PROFILE_FRAMES;
+    if (profiler->count < PROFILE_FRAMES)
+        profiler->count++;
+    profiler->frames++;
+
+    memset(profiler->current, 0, sizeof(profiler->current));
+    profiler->frameStart = now;
+}
+
+const char *ProfilePhaseName(ProfilePhase phase)
+{
+    static const char *names[PROFILE_PHASE_COUNT] = {
+        "input", "powerups", "pacman", "ghosts", "collisions", "map", "entities", "hud", "present"};
+    return (phase >= 0 && phase < PROFILE_PHASE_COUNT) ? names[phase] : "?";
+}
+
+static int CompareFloats(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// Media e percentili (rango piu' vicino) di count valori; values viene ordinato
+static ProfileStats ComputeStats(float *values, int count)
+{
+    ProfileStats stats = {0};
+    if (count == 0)
+        return stats;
+
+    double sum = 0.0;
+    for (int k = 0; k < count; k++)
+        sum += values[k];
+    qsort(values, (size_t)count, sizeof(float), CompareFloats);
+    stats.average = (float)(sum / count);
+    stats.p95 = values[(count * 95 + 99) / 100 - 1];
+    stats.p99 = values[(count * 99 + 99) / 100 - 1];
+    return stats;
+}
+
+void UpdateProfileStats(FrameProfiler *profiler, bool force)
+{
+    if (!force && profiler->frames - profiler->statsFrame < PROFILE_STATS_INTERVAL)
+        return;
+    profiler->statsFrame = profiler->frames;
+
+    float values[PROFILE_FRAMES];
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++)
+    {
+        for (int k = 0; k < profiler->count; k++)
+            values[k] = profiler->phaseMs[k][phase];
+        profiler->stats[phase] = ComputeStats(values, profiler->count);
+    }
+    memcpy(values, profiler->frameMs, sizeof(float) * (size_t)profiler->count);
+    profiler->frameStats = ComputeStats(values, profiler->count);
+}
+
+float GetProfiledFrameMs(const FrameProfiler *profiler, int age)
+{
+    if (age < 0 || age >= profiler->count)
+        return 0.0f;
+    return profiler->frameMs[(profiler->head - 1 - age + PROFILE_FRAMES) % PROFILE_FRAMES];
+}
+
+bool DumpFrameProfilerCsv(const FrameProfiler *profiler, const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "frame,frame_ms");
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++)
+        fprintf(file, ",%s_ms", ProfilePhaseName((ProfilePhase)phase));
+    fprintf(file, "\n");
+
+    // Il piu' vecchio e' count posizioni prima di head
+    unsigned long long firstFrame = profiler->frames - (unsigned long long)profiler->count;
+    for (int k = 0; k < profiler->count; k++)
+    {
+        int slot = (profiler->head - profiler->count + k + PROFILE_FRAMES) % PROFILE_FRAMES;
+        fprintf(file, "%llu,%.4f", firstFrame + (unsigned long long)k, profiler->frameMs[slot]);
+        for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++)
+            fprintf(file, ",%.4f", profiler->phaseMs[slot][phase]);
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
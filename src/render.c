@@ -0,0 +1,256 @@
+// === CACHE DI RENDERING DELLA MAPPA ===
+#include "utils/raylib/src/raylib.h"
+#include "lib/render.h"
+
+// === CAMERA E CULLING ===
+
+// Coordinata della camera lungo un asse: segue target, ma non mostra nulla oltre i bordi
+static float ClampCameraAxis(float target, float mapSize, float screenSize)
+{
+    if (mapSize <= screenSize)
+        return mapSize / 2;   // La mappa sta tutta nella finestra: resta centrata
+    if (target < screenSize / 2)
+        return screenSize / 2;
+    if (target > mapSize - screenSize / 2)
+        return mapSize - screenSize / 2;
+    return target;
+}
+
+Camera2D FollowCamera(const World *w, Vector2 target, int screenWidth, int screenHeight)
+{
+    Camera2D camera = {0};
+    camera.offset = (Vector2){screenWidth / 2.0f, screenHeight / 2.0f};
+    camera.target.x = ClampCameraAxis(target.x, (float)(w->map.cols * TILE_SIZE), (float)screenWidth);
+    camera.target.y = ClampCameraAxis(target.y, (float)(w->map.rows * TILE_SIZE), (float)screenHeight);
+    camera.zoom = 1.0f;
+    return camera;
+}
+
+TileRange GetVisibleTiles(const World *w, Camera2D camera, int screenWidth, int screenHeight, int margin)
+{
+    // Angoli della finestra nelle coordinate del mondo
+    float left = camera.target.x - camera.offset.x / camera.zoom;
+    float top = camera.target.y - camera.offset.y / camera.zoom;
+    float right = left + screenWidth / camera.zoom;
+    float bottom = top + screenHeight / camera.zoom;
+
+    TileRange range = {
+        (int)floorf(top / TILE_SIZE) - margin, (int)floorf(left / TILE_SIZE) - margin,
+        (int)floorf(bottom / TILE_SIZE) + margin, (int)floorf(right / TILE_SIZE) + margin};
+    if (range.row0 < 0) range.row0 = 0;
+    if (range.col0 < 0) range.col0 = 0;
+    if (range.row1 >= w->map.rows) range.row1 = w->map.rows - 1;
+    if (range.col1 >= w->map.cols) range.col1 = w->map.cols - 1;
+    return range;
+}
+
+// Celle della mappa che la regione copre nella parola word della riga (0 = nessuna)
+static MapWord RegionMask(const MapRenderCache *cache, int word)
+{
+    int lo = cache->region.col0 - word * 64;
+    int hi = cache->region.col1 - word * 64;
+    if (hi < 0 || lo > 63)
+        return 0;
+    if (lo < 0) lo = 0;
+    if (hi > 63) hi = 63;
+    return (hi - lo == 63 ? ~0ull : ((1ull << (hi - lo + 1)) - 1ull)) << lo;
+}
+
+bool InitMapRenderCache(MapRenderCache *cache, const World *w, int screenWidth, int screenHeight)
+{
+    cache->rows = w->map.rows;
+    cache->cols = w->map.cols;
+    cache->words = w->map.words;
+    cache->drawnDots = calloc((size_t)cache->rows * (size_t)cache->words, sizeof(MapWord));
+    if (!cache->drawnDots)
+        return false;
+
+    // Finestra (piu' una cella per quelle tagliate a meta') e margine, mai piu' della mappa
+    int viewRows = screenHeight / TILE_SIZE + 2 + 2 * MAP_CACHE_MARGIN;
+    int viewCols = screenWidth / TILE_SIZE + 2 + 2 * MAP_CACHE_MARGIN;
+    cache->regionRows = viewRows < cache->rows ? viewRows : cache->rows;
+    cache->regionCols = viewCols < cache->cols ? viewCols : cache->cols;
+    cache->region = (TileRange){0, 0, -1, -1};   // Vuota: il primo aggiornamento la posiziona
+
+    cache->walls = LoadRenderTexture(cache->regionCols * TILE_SIZE, cache->regionRows * TILE_SIZE);
+    cache->pellets = LoadRenderTexture(cache->regionCols * TILE_SIZE, cache->regionRows * TILE_SIZE);
+    cache->levelNumber = -1;   // Forza il primo disegno
+    cache->loaded = true;
+    return true;
+}
+
+// Ridisegna da zero il livello dei muri della regione
+static void RedrawWalls(MapRenderCache *cache, const World *w)
+{
+    BeginTextureMode(cache->walls);
+    ClearBackground(BLANK);
+    for (int row = cache->region.row0; row <= cache->region.row1; row++)
+    {
+        int y = (row - cache->region.row0) * TILE_SIZE;
+        for (int word = cache->region.col0 >> 6; word <= (cache->region.col1 >> 6); word++)
+        {
+            // La maschera della regione esclude anche i bit di riempimento (che sono muri)
+            for (MapWord bits = w->map.walls[row * cache->words + word] & RegionMask(cache, word); bits; bits &= bits - 1)
+            {
+                int x = (word * 64 + __builtin_ctzll(bits) - cache->region.col0) * TILE_SIZE;
+                DrawRectangle(x, y, TILE_SIZE, TILE_SIZE, DARKBLUE);
+            }
+        }
+    }
+    EndTextureMode();
+}
+
+// Ridisegna da zero il livello dei puntini della regione
+static void RedrawPellets(MapRenderCache *cache, const World *w)
+{
+    BeginTextureMode(cache->pellets);
+    ClearBackground(BLANK);
+    for (int row = cache->region.row0; row <= cache->region.row1; row++)
+    {
+        int y = (row - cache->region.row0) * TILE_SIZE;
+        for (int word = cache->region.col0 >> 6; word <= (cache->region.col1 >> 6); word++)
+        {
+            int index = row * cache->words + word;
+            for (MapWord bits = w->map.dots[index] & RegionMask(cache, word); bits; bits &= bits - 1)
+            {
+                int x = (word * 64 + __builtin_ctzll(bits) - cache->region.col0) * TILE_SIZE;
+                DrawCircle(x + TILE_SIZE / 2, y + TILE_SIZE / 2, 5, GOLD);
+            }
+            cache->drawnDots[index] = w->map.dots[index];
+        }
+    }
+    EndTextureMode();
+}
+
+// Ricentra la regione sulle celle visibili se queste ne sono uscite; ritorna true se si e' spostata
+static bool FollowVisibleTiles(MapRenderCache *cache, TileRange visible)
+{
+    if (visible.row0 >= cache->region.row0 && visible.row1 <= cache->region.row1 &&
+        visible.col0 >= cache->region.col0 && visible.col1 <= cache->region.col1)
+        return false;
+
+    int row0 = (visible.row0 + visible.row1 - cache->regionRows) / 2;
+    int col0 = (visible.col0 + visible.col1 - cache->regionCols) / 2;
+    if (row0 > cache->rows - cache->regionRows) row0 = cache->rows - cache->regionRows;
+    if (col0 > cache->cols - cache->regionCols) col0 = cache->cols - cache->regionCols;
+    if (row0 < 0) row0 = 0;
+    if (col0 < 0) col0 = 0;
+    cache->region = (TileRange){row0, col0, row0 + cache->regionRows - 1, col0 + cache->regionCols - 1};
+    return true;
+}
+
+void UpdateMapRenderCache(MapRenderCache *cache, const World *w, TileRange visible)
+{
+    if (!cache->loaded)
+        return;
+
+    // Nuovo livello o regione spostata: muri e puntini si ridisegnano per intero
+    bool moved = FollowVisibleTiles(cache, visible);
+    if (moved || cache->levelNumber != w->levelNumber)
+    {
+        RedrawWalls(cache, w);
+        RedrawPellets(cache, w);
+        cache->levelNumber = w->levelNumber;
+        return;
+    }
+
+    // Puntini ricomparsi (es. nuova partita): ridisegno completo
+    bool dirty = false;
+    for (int row = cache->region.row0; row <= cache->region.row1; row++)
+    {
+        for (int word = cache->region.col0 >> 6; word <= (cache->region.col1 >> 6); word++)
+        {
+            int index = row * cache->words + word;
+            MapWord mask = RegionMask(cache, word);
+            if (w->map.dots[index] & ~cache->drawnDots[index] & mask)
+            {
+                RedrawPellets(cache, w);
+                return;
+            }
+            if ((w->map.dots[index] ^ cache->drawnDots[index]) & mask)
+                dirty = true;
+        }
+    }
+    if (!dirty)
+        return;   // Caso normale: nessun puntino mangiato in questo frame
+
+    // Cancella solo le celle dei puntini mangiati dall'ultimo frame
+    BeginTextureMode(cache->pellets);
+    for (int row = cache->region.row0; row <= cache->region.row1; row++)
+    {
+        int y = (row - cache->region.row0) * TILE_SIZE;
+        for (int word = cache->region.col0 >> 6; word <= (cache->region.col1 >> 6); word++)
+        {
+            int index = row * cache->words + word;
+            for (MapWord eaten = cache->drawnDots[index] & ~w->map.dots[index] & RegionMask(cache, word); eaten; eaten &= eaten - 1)
+            {
+                int x = (word * 64 + __builtin_ctzll(eaten) - cache->region.col0) * TILE_SIZE;
+                BeginScissorMode(x, y, TILE_SIZE, TILE_SIZE);
+                ClearBackground(BLANK);
+                EndScissorMode();
+            }
+            cache->drawnDots[index] = w->map.dots[index];
+        }
+    }
+    EndTextureMode();
+}
+
+void DrawMapRenderCache(const MapRenderCache *cache)
+{
+    // Le RenderTexture sono capovolte in verticale: altezza negativa nel rettangolo sorgente
+    Rectangle source = {0, 0, (float)(cache->regionCols * TILE_SIZE), -(float)(cache->regionRows * TILE_SIZE)};
+    Vector2 origin = {(float)(cache->region.col0 * TILE_SIZE), (float)(cache->region.row0 * TILE_SIZE)};
+    DrawTextureRec(cache->walls.texture, source, origin, WHITE);
+    DrawTextureRec(cache->pellets.texture, source, origin, WHITE);
+}
+
+void UnloadMapRenderCache(MapRenderCache *cache)
+{
+    if (!cache->loaded)
+        return;
+    UnloadRenderTexture(cache->walls);
+    UnloadRenderTexture(cache->pellets);
+    free(cache->drawnDots);
+    cache->drawnDots = NULL;
+    cache->loaded = false;
+}
+
+// === INTERPOLAZIONE TRA DUE TICK ===
+
+bool InitRenderInterp(RenderInterp *interp, int capacity)
+{
+    interp->pacman = (Vector2){0, 0};
+    interp->ghostX = calloc((size_t)capacity * 2, sizeof(float));
+    interp->ghostY = interp->ghostX ? interp->ghostX + capacity : NULL;
+    interp->capacity = interp->ghostX ? capacity : 0;
+    return interp->ghostX != NULL;
+}
+
+void CaptureRenderInterp(RenderInterp *interp, const World *w)
+{
+    int count = w->ghosts.count < interp->capacity ? w->ghosts.count : interp->capacity;
+    interp->pacman = w->pacmanPos;
+    for (int i = 0; i < count; i++)
+    {
+        Vector2 pos = SimGhostPos(w, i);
+        interp->ghostX[i] = pos.x;
+        interp->ghostY[i] = pos.y;
+    }
+}
+
+Vector2 InterpolatePosition(Vector2 previous, Vector2 current, float alpha)
+{
+    if (fabsf(current.x - previous.x) > TILE_SIZE || fabsf(current.y - previous.y) > TILE_SIZE)
+        return current;   // Teletrasporto: niente scia attraverso la mappa
+    return (Vector2){
+        previous.x + (current.x - previous.x) * alpha,
+        previous.y + (current.y - previous.y) * alpha};
+}
+
+void UnloadRenderInterp(RenderInterp *interp)
+{
+    free(interp->ghostX);
+    interp->ghostX = NULL;
+    interp->ghostY = NULL;
+    interp->capacity = 0;
+}
@@ -0,0 +1,197 @@
+// === REGISTRAZIONE E REPLAY DELL'INPUT ===
+#include "lib/replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_HEADER_SIZE 36
+#define REPLAY_SHORT_RUN 16     // Lunghezze 1..16 stanno nel byte della run
+
+void ReplayInit(Replay *replay, unsigned int seed, int numGhosts, unsigned long long mazeHash)
+{
+    memset(replay, 0, sizeof(*replay));
+    replay->seed = seed;
+    replay->numGhosts = numGhosts;
+    replay->mazeHash = mazeHash;
+    replay->tickRate = SIM_TICK_RATE;
+}
+
+void ReplayFree(Replay *replay)
+{
+    free(replay->data);
+    memset(replay, 0, sizeof(*replay));
+}
+
+static bool AppendByte(Replay *replay, unsigned char byte)
+{
+    if (replay->size == replay->capacity)
+    {
+        size_t capacity = replay->capacity ? replay->capacity * 2 : 1024;
+        unsigned char *data = realloc(replay->data, capacity);
+        if (!data)
+            return false;
+        replay->data = data;
+        replay->capacity = capacity;
+    }
+    replay->data[replay->size++] = byte;
+    return true;
+}
+
+// Codifica la run in corso (se c'e')
+static bool FlushRun(Replay *replay)
+{
+    if (replay->runLength == 0)
+        return true;
+
+    unsigned long long extra = replay->runLength - 1;
+    unsigned int inByte = extra < REPLAY_SHORT_RUN - 1 ? (unsigned int)extra : REPLAY_SHORT_RUN - 1;
+    if (!AppendByte(replay, (unsigned char)((replay->runInput & 0x0F) | (inByte << 4))))
+        return false;
+
+    // Lunghezza restante come varint
+    if (inByte == REPLAY_SHORT_RUN - 1)
+    {
+        unsigned long long rest = extra - (REPLAY_SHORT_RUN - 1);
+        do
+        {
+            unsigned char byte = rest & 0x7F;
+            rest >>= 7;
+            if (!AppendByte(replay, (unsigned char)(byte | (rest ? 0x80 : 0))))
+                return false;
+        } while (rest);
+    }
+
+    replay->runLength = 0;
+    return true;
+}
+
+bool ReplayRecord(Replay *replay, SimInput input)
+{
+    if (replay->runLength > 0 && input != replay->runInput)
+    {
+        if (!FlushRun(replay))
+            return false;
+    }
+    replay->runInput = input;
+    replay->runLength++;
+    replay->numTicks++;
+    return true;
+}
+
+// === FILE ===
+
+static void PutLE(unsigned char *out, unsigned long long value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out[i] = (unsigned char)(value >> (8 * i));
+}
+
+static unsigned long long GetLE(const unsigned char *in, int bytes)
+{
+    unsigned long long value = 0;
+    for (int i = 0; i < bytes; i++)
+        value |= (unsigned long long)in[i] << (8 * i);
+    return value;
+}
+
+bool ReplaySave(Replay *replay, const char *path)
+{
+    if (!FlushRun(replay) || replay->size > 0xFFFFFFFFu)
+        return false;
+
+    unsigned char header[REPLAY_HEADER_SIZE];
+    memcpy(header, "PCRP", 4);
+    PutLE(header + 4, REPLAY_VERSION, 2);
+    PutLE(header + 6, (unsigned int)replay->tickRate, 2);
+    PutLE(header + 8, replay->seed, 4);
+    PutLE(header + 12, (unsigned int)replay->numGhosts, 4);
+    PutLE(header + 16, replay->numTicks, 8);
+    PutLE(header + 24, replay->size, 4);
+    PutLE(header + 28, replay->mazeHash, 8);
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              fwrite(replay->data, 1, replay->size, file) == replay->size;
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+bool ReplayLoad(Replay *replay, const char *path)
+{
+    memset(replay, 0, sizeof(*replay));
+
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    unsigned char header[REPLAY_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, "PCRP", 4) != 0 || GetLE(header + 4, 2) != REPLAY_VERSION)
+    {
+        fclose(file);
+        return false;
+    }
+
+    replay->tickRate = (int)GetLE(header + 6, 2);
+    replay->seed = (unsigned int)GetLE(header + 8, 4);
+    replay->numGhosts = (int)GetLE(header + 12, 4);
+    replay->numTicks = GetLE(header + 16, 8);
+    replay->size = (size_t)GetLE(header + 24, 4);
+    replay->mazeHash = GetLE(header + 28, 8);
+    replay->capacity = replay->size;
+    replay->data = malloc(replay->size ? replay->size : 1);
+
+    bool ok = replay->data && fread(replay->data, 1, replay->size, file) == replay->size;
+    fclose(file);
+    if (!ok)
+        ReplayFree(replay);
+    return ok;
+}
+
+// === LETTURA ===
+
+void ReplayCursorInit(ReplayCursor *cursor, const Replay *replay)
+{
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->replay = replay;
+}
+
+bool ReplayNext(ReplayCursor *cursor, SimInput *input)
+{
+    const Replay *replay = cursor->replay;
+    if (cursor->tick >= replay->numTicks)
+        return false;
+
+    // Run finita: decodifica la prossima
+    while (cursor->left == 0)
+    {
+        if (cursor->pos >= replay->size)
+            return false;   // File troncato
+
+        unsigned char byte = replay->data[cursor->pos++];
+        cursor->input = byte & 0x0F;
+        cursor->left = (byte >> 4) + 1ull;
+        if ((byte >> 4) == REPLAY_SHORT_RUN - 1)
+        {
+            unsigned long long rest = 0;
+            int shift = 0;
+            unsigned char next;
+            do
+            {
+                if (cursor->pos >= replay->size || shift > 63)
+                    return false;
+                next = replay->data[cursor->pos++];
+                rest |= (unsigned long long)(next & 0x7F) << shift;
+                shift += 7;
+            } while (next & 0x80);
+            cursor->left += rest;
+        }
+    }
+
+    *input = cursor->input;
+    cursor->left--;
+    cursor->tick++;
+    return true;
+}
@@ -0,0 +1,716 @@
+// === INCLUDE E DICHIARAZIONI ===
+// Questo file NON include raylib: e' il nucleo della simulazione usato sia dal
+// gioco con finestra (main.c) sia dal simulatore headless (sim_main.c)
+#include "lib/sim.h"
+#include "lib/flowfield.h"
+#include "lib/ghostpool.h"
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+// Tempi delle fasi di SimStep ed eventi della traccia: solo nel gioco (make passa
+// SIM_PROFILING a pacman), nel simulatore headless e nei benchmark la fase e' una
+// chiamata normale e gli eventi spariscono. Gli eventi vengono solo dal World con
+// un profiler (quello mostrato a schermo), non dalle copie dell'autopilota
+#if defined(SIM_PROFILING)
+#include "lib/profiler.h"
+#define SIM_PHASE(w, phase, call) do { ProfilerBegin((w)->profiler, phase); call; ProfilerEnd((w)->profiler, phase); } while (0)
+#define SIM_EVENT(w, name, argName, value) do { if ((w)->profiler && TraceEnabled()) TraceInstant(name, argName, value); } while (0)
+#else
+#define SIM_PHASE(w, phase, call) call
+#define SIM_EVENT(w, name, argName, value) ((void)0)
+#endif
+
+/*
+ * === SISTEMA POWER-UP DI PACMAN ===
+ *
+ * Il sistema funziona su due livelli:
+ *
+ * 1. POWER-UP SULLA MAPPA:
+ *    - Appaiono casualmente su celle vuote della mappa
+ *    - Possono essere raccolti da Pacman camminandoci sopra
+ *    - Massimo MAX_POWERUPS power-up simultanei sulla mappa
+ *
+ * 2. EFFETTI ATTIVI:
+ *    - Una volta raccolti, i power-up applicano effetti temporanei
+ *    - Ogni effetto ha una durata limitata (POWERUP_DURATION tick)
+ *    - Se si raccoglie un power-up gia' attivo la durata viene rinnovata
+ *
+ * MECCANICA DI SPAWN:
+ * - Ogni tick c'è 1 possibilità su POWERUP_SPAWN_CHANCE che appaia un power-up
+ * - I power-up appaiono solo su celle vuote (non su muri o puntini)
+ * - Il tipo di power-up è scelto casualmente
+ *
+ * Il labirinto (muri, puntini, partenze di Pacman e dei fantasmi) arriva da
+ * file, vedi map.h e SimCreate.
+ */
+
+// === GENERATORE CASUALE ===
+// xorshift32: ogni mondo ha il suo stato, quindi partite con lo stesso seme
+// e lo stesso input sono identiche e piu' mondi possono girare in parallelo
+int SimRandom(World *w, int min, int max)
+{
+    unsigned int x = w->rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    w->rngState = x;
+
+    if (min > max)
+    {
+        int tmp = max;
+        max = min;
+        min = tmp;
+    }
+    return min + (int)(x % (unsigned int)(max - min + 1));
+}
+
+// === FUNZIONI DI INIZIALIZZAZIONE ===
+
+// Centro di una cella in pixel
+static Vector2 CellCentre(const MapBits *map, int cell)
+{
+    return (Vector2){
+        MapCellCol(map, cell) * TILE_SIZE + TILE_SIZE / 2.0f,
+        MapCellRow(map, cell) * TILE_SIZE + TILE_SIZE / 2.0f};
+}
+
+// Mette Pacman in pos e aggiorna la sua cella
+static void PlacePacman(World *w, Vector2 pos)
+{
+    w->pacmanPos = pos;
+    w->pacmanCell = GridCellOfPoint(&w->map, pos.x, pos.y);
+}
+
+// Mette Pacman sulla partenza indicata dal labirinto
+static void PlacePacmanAtStart(World *w)
+{
+    PlacePacman(w, CellCentre(&w->map, w->maze->pacmanStart));
+}
+
+// Celle libere della parola word della riga row abbastanza lontane dalla partenza
+// di Pacman (distanza di Manhattan >= 4): dove partono i fantasmi oltre le
+// partenze del labirinto
+static MapWord SpawnCandidates(const MapBits *map, const Maze *maze, int row, int word)
+{
+    int pacmanRow = MapCellRow(map, maze->pacmanStart);
+    int pacmanCol = MapCellCol(map, maze->pacmanStart);
+    MapWord open = ~map->walls[row * map->words + word];
+    int reach = 3 - abs(row - pacmanRow);
+    for (int col = pacmanCol - reach; col <= pacmanCol + reach; col++)
+    {
+        if (col >= 0 && col >> 6 == word)
+            open &= ~(1ull << (col & 63));
+    }
+    return open;
+}
+
+// Conta le candidate prima di ogni riga (una volta per labirinto): PlaceGhostStarts
+// trova la k-esima senza elencarle tutte
+static bool CountSpawnCandidates(World *w)
+{
+    const MapBits *map = &w->map;
+    w->spawnRowFirst = ArenaAlloc(&w->arena, sizeof(int) * ((size_t)map->rows + 1));
+    if (!w->spawnRowFirst)
+        return false;
+    w->spawnRowFirst[0] = 0;
+    for (int row = 0; row < map->rows; row++)
+    {
+        int count = 0;
+        for (int word = 0; word < map->words; word++)
+            count += __builtin_popcountll(SpawnCandidates(map, w->maze, row, word));
+        w->spawnRowFirst[row + 1] = w->spawnRowFirst[row] + count;
+    }
+    return true;
+}
+
+// k-esima candidata in ordine di riga e colonna (0 <= k < spawnRowFirst[rows])
+static int SpawnCandidateCell(const World *w, int k)
+{
+    const MapBits *map = &w->map;
+    const int *first = w->spawnRowFirst;
+
+    // Ultima riga che parte entro k: contiene la candidata (le righe vuote hanno
+    // lo stesso inizio della successiva)
+    int lo = 0, hi = map->rows - 1;
+    while (lo < hi)
+    {
+        int mid = (lo + hi + 1) / 2;
+        if (first[mid] <= k)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    k -= first[lo];
+    for (int word = 0; word < map->words; word++)
+    {
+        MapWord bits = SpawnCandidates(map, w->maze, lo, word);
+        int count = __builtin_popcountll(bits);
+        if (k >= count)
+        {
+            k -= count;
+            continue;
+        }
+        for (; k > 0; k--)
+            bits &= bits - 1;
+        return MapCell(map, lo, word * 64 + __builtin_ctzll(bits));
+    }
+    return w->maze->pacmanStart;   // Non succede con k nell'intervallo
+}
+
+size_t SimMemorySize(const Maze *maze, int numGhosts)
+{
+    MapBits walls = MapWallsOf(maze);
+    return MapMemorySize(maze) +
+           JunctionGraphMemorySize(&walls) +
+           GhostSwarmMemorySize(numGhosts) +
+           SpatialGridMemorySize(numGhosts, maze->rows, maze->cols) +
+           SpatialGridMemorySize(MAX_POWERUPS, maze->rows, maze->cols) +
+           FlowFieldMemorySize(maze->rows, maze->cols) +
+           ArenaSize(sizeof(int) * ((size_t)maze->rows + 1));
+}
+
+// Ritaglia dall'arena (gia' riservata e vuota) la memoria del mondo, nello
+// stesso ordine di SimMemorySize
+static bool CarveWorld(World *w, const Maze *maze, int numGhosts)
+{
+    w->maze = maze;
+    return MapAlloc(&w->map, maze, &w->arena) &&
+           BuildJunctionGraph(&w->junctions, &w->map, &w->arena) &&
+           AllocGhostSwarm(&w->ghosts, numGhosts, &w->arena) &&
+           AllocSpatialGrid(&w->ghostGrid, numGhosts, maze->rows, maze->cols, &w->arena) &&
+           AllocSpatialGrid(&w->powerupGrid, MAX_POWERUPS, maze->rows, maze->cols, &w->arena) &&
+           AllocFlowField(w) &&
+           CountSpawnCandidates(w);
+}
+
+bool SimCreate(World *w, const Maze *maze, int numGhosts)
+{
+    memset(w, 0, sizeof(*w));
+    if (numGhosts < 1 || numGhosts > MAX_GHOSTS)
+        return false;
+    if (!ArenaInit(&w->arena, SimMemorySize(maze, numGhosts)) || !CarveWorld(w, maze, numGhosts))
+    {
+        SimDestroy(w);
+        return false;
+    }
+    return true;
+}
+
+void SimDestroy(World *w)
+{
+    FreeFlowField(w);
+    ArenaFree(&w->arena);
+}
+
+bool SimReload(World *w, const Maze *maze, int numGhosts)
+{
+    struct FrameProfiler *profiler = w->profiler;
+    struct GhostPool *ghostPool = w->ghostPool;
+    FreeFlowField(w);   // Il planner HPA e' l'unica cosa fuori dall'arena
+    Arena arena = w->arena;
+    memset(w, 0, sizeof(*w));
+    w->profiler = profiler;
+    w->ghostPool = ghostPool;
+
+    if (numGhosts < 1 || numGhosts > MAX_GHOSTS)
+    {
+        ArenaFree(&arena);
+        return false;
+    }
+    size_t size = SimMemorySize(maze, numGhosts);
+    if (arena.capacity < size)
+    {
+        ArenaFree(&arena);
+        if (!ArenaInit(&arena, size))
+            return false;
+    }
+    ArenaReset(&arena);
+    w->arena = arena;
+    if (!CarveWorld(w, maze, numGhosts))
+    {
+        SimDestroy(w);
+        return false;
+    }
+    return true;
+}
+
+// Posizioni di partenza: i primi fantasmi sulle partenze del labirinto, gli altri
+// sparsi (in modo deterministico) sulle celle libere lontane dalla partenza di Pacman
+static void PlaceGhostStarts(World *w)
+{
+    GhostSwarm *g = &w->ghosts;
+    const MapBits *map = &w->map;
+    int numStarts = w->maze->numGhostStarts;
+    for (int i = 0; i < g->count && i < numStarts; i++)
+    {
+        g->startCell[i] = w->maze->ghostStarts[i];
+        g->speed[i] = PACMAN_BASE_SPEED;
+    }
+    if (g->count <= numStarts)
+        return;
+
+    int numCells = w->spawnRowFirst[map->rows];
+    for (int i = numStarts; i < g->count; i++)
+    {
+        // Passo moltiplicativo (hash di Knuth): fantasmi consecutivi finiscono lontani tra loro
+        int cell = numCells > 0 ? SpawnCandidateCell(w, (int)((unsigned long long)(i - numStarts) * 2654435761ull % (unsigned int)numCells))
+                                : w->maze->pacmanStart;
+        g->startCell[i] = cell;
+        g->speed[i] = PACMAN_BASE_SPEED;
+    }
+}
+
+void SimInit(World *w, unsigned int seed)
+{
+    // Azzera lo stato di gioco; mappa, fantasmi, griglie e flow field restano
+    // allocati (le griglie vengono svuotate)
+    GhostSwarm ghosts = w->ghosts;
+    memset(&w->level, 0, offsetof(World, ghostGrid) - offsetof(World, level));
+    w->ghosts = ghosts;
+    ClearSpatialGrid(&w->ghostGrid);
+    w->rngState = seed ? seed : 0x9E3779B9u;  // xorshift non deve mai partire da 0
+
+    MapReset(&w->map, w->maze);
+    PlaceGhostStarts(w);
+
+    PlacePacmanAtStart(w);
+    w->lives = LIVES;
+    w->score = 0;
+    w->gameOver = false;
+    w->levelNumber = 1;
+
+    InitializePowerUps(w);
+    SimResetGhosts(w);
+    InvalidateFlowField(w);
+}
+
+void SimNextLevel(World *w)
+{
+    // Registra il livello appena finito
+    w->level.score = w->score;
+    w->level.IsCompleate = true;
+    w->levelNumber++;
+
+    // Nuovo livello: stessa mappa, puntini di nuovo al loro posto
+    MapReset(&w->map, w->maze);
+    PlacePacmanAtStart(w);
+    InitializePowerUps(w);
+    SimResetGhosts(w);
+    InvalidateFlowField(w);
+}
+
+void SimResetGhosts(World *w)
+{
+    GhostSwarm *g = &w->ghosts;
+    for (int i = 0; i < g->count; i++)
+    {
+        // Direzione casuale (o la prima libera dopo): il fantasma parte dal centro
+        // della sua cella, a meta' dell'arco se e' in un corridoio
+        int edge, cellsDone;
+        int dir = SimRandom(w, 0, 3);
+        g->cell[i] = g->startCell[i];
+        g->edge[i] = JUNCTION_NONE;
+        g->offset[i] = 0.0f;
+        g->nextEvent[i] = INFINITY;   // Senza uscite non si muove mai
+        g->target[i] = g->startCell[i];
+        if (JunctionPlace(&w->junctions, &w->map, g->startCell[i], dir, &edge, &cellsDone))
+        {
+            g->edge[i] = edge;
+            g->offset[i] = (float)(cellsDone * TILE_SIZE);
+            g->nextEvent[i] = g->offset[i] + TILE_SIZE / 2.0f;
+            g->target[i] = w->junctions.edges[edge].toCell;
+        }
+        GridMove(&w->ghostGrid, i, g->cell[i]);
+    }
+}
+
+void SimRebuildCaches(World *w)
+{
+    ClearSpatialGrid(&w->ghostGrid);
+    for (int i = 0; i < w->ghosts.count; i++)
+        GridMove(&w->ghostGrid, i, w->ghosts.cell[i]);
+
+    ClearSpatialGrid(&w->powerupGrid);
+    for (int i = 0; i < MAX_POWERUPS; i++)
+    {
+        if (w->powerups[i].isActive)
+            GridMove(&w->powerupGrid, i, GridCellOfPoint(&w->map, w->powerups[i].pos.x, w->powerups[i].pos.y));
+    }
+
+    // Il flow field dipende solo dai muri e dalla cella di Pacman: se lo stato
+    // ripristinato ha Pacman nella cella per cui e' stato calcolato resta buono
+    // (UpdateFlowField lo confronta da solo), altrimenti si rifa' al primo tick
+}
+
+/* funzione che dice sostanzialmente questo
+    Dati due vettori uno posizione attuale e uno la direzione verso cui va il fantasma
+*   Se esso è compreso in lunghezza tra 0 e il numero di righe ( 0 e n stessa cosa) e
+*   lo stesso in altezza (sempre matriciale ), restituisci la posizione (frame valido ) in cui non vi è un muro ovvero un #
+*   Altrimento falso --> sta direzione non è corretta (tipo fuori mappa o scontri tra tutti muri )
+*/
+bool IsDirectionValid(const World *w, Vector2 pos, Vector2 dir)
+{
+    int col = (int)(pos.x + dir.x * TILE_SIZE) / TILE_SIZE;
+    int row = (int)(pos.y + dir.y * TILE_SIZE) / TILE_SIZE;
+
+    // Fuori mappa conta come muro
+    return !MapIsWall(&w->map, row, col);
+}
+
+// CheckPacmanCollision: Check if the current position of Pacman is equal to the current position of a ghost
+bool CheckPacmanCollision(Vector2 pacmanPos, Vector2 ghostPos)
+{
+    return (fabsf(pacmanPos.x - ghostPos.x) < TILE_SIZE * 0.75f &&
+            fabsf(pacmanPos.y - ghostPos.y) < TILE_SIZE * 0.75f);
+}
+
+// Funzione per calcolare la distanza tra due punti
+float CalculateDistance(Vector2 v1, Vector2 v2)
+{
+    float dx = v1.x - v2.x;
+    float dy = v1.y - v2.y;
+    return sqrtf(dx * dx + dy * dy);
+}
+
+// === FUNZIONI DEI POWER-UP ===
+
+// Inizializza tutti i power-up come inattivi all'avvio del gioco
+void InitializePowerUps(World *w)
+{
+    // Resetta tutti i power-up sulla mappa
+    for (int i = 0; i < MAX_POWERUPS; i++)
+    {
+        w->powerups[i].isActive = false;       // Disattiva il power-up
+        w->powerups[i].type = POWERUP_NONE;    // Nessun tipo assegnato
+        w->powerups[i].pos = (Vector2){0, 0};  // Posizione di default
+    }
+    ClearSpatialGrid(&w->powerupGrid);
+    // Nessun effetto attivo e ruota delle scadenze vuota
+    w->activeEffects = 0;
+    memset(w->effectExpiry, 0, sizeof(w->effectExpiry));
+    memset(w->expiryWheel, 0, sizeof(w->expiryWheel));
+}
+
+// Spawna un power-up in una posizione casuale sulla mappa
+void SpawnPowerUp(World *w)
+{
+    // Cerca uno slot libero nell'array dei power-up
+    for (int i = 0; i < MAX_POWERUPS; i++)
+    {
+        if (!w->powerups[i].isActive)  // Se lo slot è libero
+        {
+            // === RICERCA POSIZIONE VALIDA ===
+            // Estrazione uniforme dall'indice delle celle libere (non su muri, puntini o altri power-up)
+            if (w->map.numFreeCells == 0)
+                break;  // Nessuna cella libera: niente spawn in questo tick
+
+            int cell = w->map.freeCells[SimRandom(w, 0, w->map.numFreeCells - 1)];
+            int row = MapCellRow(&w->map, cell);
+            int col = MapCellCol(&w->map, cell);
+            MapRemoveFreeCell(&w->map, cell);  // Occupata finche' il power-up non viene raccolto
+
+            // === CONFIGURAZIONE POWER-UP ===
+            w->powerups[i].isActive = true;  // Attiva il power-up
+            // Centra il power-up nella cella
+            w->powerups[i].pos = (Vector2){
+                col * TILE_SIZE + TILE_SIZE / 2.0f,
+                row * TILE_SIZE + TILE_SIZE / 2.0f
+            };
+            w->powerups[i].spawnTime = (int)w->tick;
+            GridMove(&w->powerupGrid, i, cell);
+
+            // Sceglie un tipo casuale di power-up (1-4, escludendo POWERUP_NONE)
+            w->powerups[i].type = (PowerUpType)SimRandom(w, 1, 4);
+            SIM_EVENT(w, "powerup_spawn", "type", w->powerups[i].type);
+            break;
+        }
+    }
+}
+
+// Controlla se Pacman ha raccolto un power-up
+// (solo quelli nella cella di Pacman e nelle otto vicine: il raggio di raccolta e' minore di una cella)
+void CheckPowerUpCollection(World *w)
+{
+    int pacmanCell = w->pacmanCell;
+    if (pacmanCell == GRID_NONE)
+        return;
+
+    // Riga e colonna dalla posizione (divisione per una costante) invece che dalla cella
+    int nearby[MAX_POWERUPS];
+    int count = GridQuery(&w->powerupGrid, (int)w->pacmanPos.y / TILE_SIZE, (int)w->pacmanPos.x / TILE_SIZE, 1, nearby, MAX_POWERUPS);
+
+    // A parita' vince lo slot piu' basso, come nella scansione completa
+    int collected = -1;
+    for (int k = 0; k < count; k++)
+    {
+        int i = nearby[k];
+        float dx = w->pacmanPos.x - w->powerups[i].pos.x;
+        float dy = w->pacmanPos.y - w->powerups[i].pos.y;
+        if (dx * dx + dy * dy < 25.0f * 25.0f && (collected < 0 || i < collected)) // Raggio di raccolta
+            collected = i;
+    }
+    if (collected < 0)
+        return;
+
+    // Applica l'effetto del power-up
+    SIM_EVENT(w, "powerup_pickup", "type", w->powerups[collected].type);
+    ApplyPowerUp(w, w->powerups[collected].type);
+
+    // Disattiva il power-up e libera di nuovo la sua cella
+    w->powerups[collected].isActive = false;
+    GridRemove(&w->powerupGrid, collected);
+    MapAddFreeCell(&w->map, GridCellOfPoint(&w->map, w->powerups[collected].pos.x, w->powerups[collected].pos.y));
+}
+
+// Applica l'effetto di un power-up
+void ApplyPowerUp(World *w, PowerUpType type)
+{
+    switch (type)
+    {
+        case POWERUP_SPEED:
+            // Aggiunge velocità per 5 secondi
+            AddActivePowerUp(w, POWERUP_SPEED, POWERUP_DURATION);
+            break;
+
+        case POWERUP_INVINCIBLE:
+            // Rende invincibile per 5 secondi
+            AddActivePowerUp(w, POWERUP_INVINCIBLE, POWERUP_DURATION);
+            break;
+
+        case POWERUP_SCORE_BOOST:
+            // Raddoppia i punti per 5 secondi
+            AddActivePowerUp(w, POWERUP_SCORE_BOOST, POWERUP_DURATION);
+            break;
+
+        case POWERUP_EXTRA_LIFE:
+            // Vita extra immediata
+            w->lives++;
+            w->score += 100; // Bonus punti
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Aggiunge un power-up attivo
+void AddActivePowerUp(World *w, PowerUpType type, int duration)
+{
+    if (duration <= 0)
+        return;
+
+    // Se l'effetto era gia' attivo la durata viene rinnovata: la vecchia voce
+    // nella ruota resta, ma verra' ignorata perche' la scadenza non coincide piu'
+    unsigned int expiry = w->tick + (unsigned int)duration;
+    w->activeEffects |= 1u << type;
+    w->effectExpiry[type] = expiry;
+    w->expiryWheel[expiry & (EFFECT_WHEEL_SIZE - 1)] |= 1u << type;
+}
+
+// Aggiorna i power-up attivi: guarda solo lo slot della ruota di questo tick
+void UpdateActivePowerUps(World *w)
+{
+    unsigned int slot = w->tick & (EFFECT_WHEEL_SIZE - 1);
+    unsigned int candidates = w->expiryWheel[slot];
+    if (candidates == 0)
+        return;   // Caso normale: niente scade in questo tick
+
+    w->expiryWheel[slot] = 0;
+    for (; candidates; candidates &= candidates - 1)
+    {
+        int type = __builtin_ctz(candidates);
+        if (!(w->activeEffects & (1u << type)))
+            continue;
+
+        unsigned int expiry = w->effectExpiry[type];
+        if (expiry == w->tick)
+        {
+            w->activeEffects &= ~(1u << type);  // Effetto scaduto
+        }
+        else
+        {
+            // Rinnovato, oppure durata piu' lunga di un giro di ruota: rimette il tipo nello slot giusto
+            w->expiryWheel[expiry & (EFFECT_WHEEL_SIZE - 1)] |= 1u << type;
+        }
+    }
+}
+
+int GetPowerUpTimeLeft(const World *w, PowerUpType type)
+{
+    if (!IsPowerUpActive(w, type))
+        return 0;
+    return (int)(w->effectExpiry[type] - w->tick);
+}
+
+// Ottiene il moltiplicatore di velocità
+float GetSpeedMultiplier(const World *w)
+{
+    return IsPowerUpActive(w, POWERUP_SPEED) ? 1.5f : 1.0f;
+}
+
+// Ottiene il moltiplicatore di punteggio
+int GetScoreMultiplier(const World *w)
+{
+    return IsPowerUpActive(w, POWERUP_SCORE_BOOST) ? 2 : 1;
+}
+
+float GetModifiedSpeed(const World *w, float baseSpeed)
+{
+    return baseSpeed * GetSpeedMultiplier(w);
+}
+
+float GetGhostSpeed(const World *w, float baseSpeed)
+{
+    // I fantasmi vanno più lenti se c'è il power-up SLOW_GHOSTS
+    if (IsPowerUpActive(w, POWERUP_SLOW_GHOSTS))
+        return baseSpeed * 0.5f;
+    return baseSpeed;
+}
+
+// Controlla se Pacman è invincibile
+bool IsPacmanInvincible(const World *w)
+{
+    return IsPowerUpActive(w, POWERUP_INVINCIBLE);
+}
+
+// === AGGIORNAMENTO DI UN TICK ===
+
+// Scadenza degli effetti e spawn casuale di un nuovo power-up
+void SimStepPowerUps(World *w)
+{
+    UpdateActivePowerUps(w);
+    if (SimRandom(w, 1, POWERUP_SPAWN_CHANCE) == 1)
+    {
+        SpawnPowerUp(w);
+    }
+}
+
+// Muove Pacman secondo l'input, gestisce muri, power-up e puntini
+void SimStepPacman(World *w, SimInput input)
+{
+    // Ottieni velocità modificata dai power-up
+    float currentSpeed = GetModifiedSpeed(w, PACMAN_BASE_SPEED);
+
+    // Calcola la prossima posizione di Pacman basata sui tasti premuti
+    Vector2 nextPos = w->pacmanPos;
+    if (input & SIM_INPUT_RIGHT)
+        nextPos.x += currentSpeed;
+    if (input & SIM_INPUT_LEFT)
+        nextPos.x -= currentSpeed;
+    if (input & SIM_INPUT_UP)
+        nextPos.y -= currentSpeed;
+    if (input & SIM_INPUT_DOWN)
+        nextPos.y += currentSpeed;
+
+    // === COLLISION DETECTION CON I MURI ===
+    int mapCol = (int)(nextPos.x) / TILE_SIZE;
+    int mapRow = (int)(nextPos.y) / TILE_SIZE;
+
+    if (!MapIsWall(&w->map, mapRow, mapCol))
+    {
+        w->pacmanPos = nextPos;
+        w->pacmanCell = MapCell(&w->map, mapRow, mapCol);
+
+        // === CONTROLLO RACCOLTA POWER-UP ===
+        CheckPowerUpCollection(w);
+
+        // === MECCANICA DI RACCOLTA PUNTINI ===
+        if (MapEatDot(&w->map, mapRow, mapCol))
+        {
+            w->score += 10 * GetScoreMultiplier(w);
+        }
+    }
+}
+
+// Sceglie la direzione e muove ogni fantasma
+void SimStepGhosts(World *w)
+{
+    UpdateFlowField(w);  // Ricalcola solo se Pacman ha cambiato cella
+
+    // Sui nodi del grafo i fantasmi prendono il primo passo del percorso piu'
+    // breve verso Pacman; la velocita' e' modificata dai power-up
+    GhostStepParams params = {
+        .flowDir = w->flowDir,
+        .graph = &w->junctions,
+        .speedMultiplier = GetGhostSpeed(w, 1.0f)};
+    GhostPoolStep(w->ghostPool, &w->ghosts, &params);  // Sugli sciami grandi in parallelo, stesso risultato
+
+    // Aggiorna la griglia con le celle calcolate dal kernel:
+    // la maggior parte dei fantasmi resta nella stessa cella
+    const GhostSwarm *g = &w->ghosts;
+    for (int i = 0; i < g->count; i++)
+        GridMove(&w->ghostGrid, i, g->cell[i]);
+}
+
+// Collisioni Pacman-fantasmi: toglie una vita e rimette tutti in partenza.
+// Un fantasma che tocca Pacman e' al massimo a 0.75 celle di distanza, quindi
+// basta guardare la cella di Pacman e le otto vicine
+void SimStepCollisions(World *w)
+{
+    // Solo se Pacman non è invincibile
+    if (IsPacmanInvincible(w))
+        return;
+
+    int pacmanCell = w->pacmanCell;
+    if (pacmanCell == GRID_NONE)
+        return;
+    int pacmanRow = (int)w->pacmanPos.y / TILE_SIZE;
+    int pacmanCol = (int)w->pacmanPos.x / TILE_SIZE;
+
+    for (int row = pacmanRow - 1; row <= pacmanRow + 1; row++)
+    {
+        for (int col = pacmanCol - 1; col <= pacmanCol + 1; col++)
+        {
+            if (!MapInBounds(&w->map, row, col))
+                continue;
+            for (int i = w->ghostGrid.head[MapCell(&w->map, row, col)]; i != GRID_NONE; i = w->ghostGrid.next[i])
+            {
+                if (!CheckPacmanCollision(w->pacmanPos, SimGhostPos(w, i)))
+                    continue;
+
+                w->lives--;
+                SIM_EVENT(w, "death", "lives", w->lives);
+                if (w->lives <= 0)
+                {
+                    w->gameOver = true;
+                    SIM_EVENT(w, "game_over", "score", w->score);
+                }
+                else
+                {
+                    // Reset Pacman e fantasmi
+                    PlacePacmanAtStart(w);
+                    SimResetGhosts(w);
+                }
+                return;
+            }
+        }
+    }
+}
+
+void SimStep(World *w, SimInput input)
+{
+    if (w->gameOver)
+        return;
+
+    // === AGGIORNAMENTO POWER-UP ===
+    SIM_PHASE(w, PROFILE_POWERUPS, SimStepPowerUps(w));
+
+    SIM_PHASE(w, PROFILE_PACMAN, SimStepPacman(w, input));
+
+    // Tutti i puntini mangiati: livello completato
+    if (MapIsCleared(&w->map))
+    {
+        SIM_EVENT(w, "level_complete", "level", w->levelNumber);
+        SimNextLevel(w);
+        w->tick++;
+        return;
+    }
+
+    SIM_PHASE(w, PROFILE_GHOSTS, SimStepGhosts(w));
+    SIM_PHASE(w, PROFILE_COLLISIONS, SimStepCollisions(w));
+
+    w->tick++;
+}
@@ -0,0 +1,634 @@
+// === SIMULATORE HEADLESS ===
+// Fa girare la logica di gioco senza finestra e senza limite di FPS.
+// Compilato con: make sim
+#include "lib/sim.h"
+#include "lib/batch.h"
+#include "lib/replay.h"
+#include "lib/mazegen.h"
+#include "lib/snapshot.h"
+#include "lib/ghostpool.h"
+#include "lib/autopilot.h"
+#include "lib/env.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lib/platform.h"
+
+// --ghost-threads: thread che muovono i fantasmi nelle partite singole (record,
+// replay, partita continua); NULL = tutto sul thread principale. Il batch no:
+// li' ogni core gioca gia' le sue partite
+static GhostPool *ghostPool = NULL;
+
+// Con --autopilot la partita e' lenta (una ricerca a ogni cella): niente 10 milioni di tick
+#define AUTOPILOT_SIM_TICKS SIM_SECONDS(120)
+
+// Con --env N ogni partita fa questi passi, se --ticks non dice altro
+#define ENV_SIM_STEPS 10000
+
+// Orologio monotono in secondi
+static double NowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Input di prova: una passeggiata casuale che cambia direzione ogni mezzo secondo
+static SimInput RandomWalkInput(unsigned int *state, unsigned int tick, SimInput current)
+{
+    static const SimInput directions[4] = {SIM_INPUT_RIGHT, SIM_INPUT_LEFT, SIM_INPUT_UP, SIM_INPUT_DOWN};
+
+    if (tick % (SIM_TICK_RATE / 2) != 0)
+        return current;
+
+    *state = *state * 1103515245u + 12345u;
+    return directions[(*state >> 16) & 3];
+}
+
+static void PrintUsage(const char *prog)
+{
+    printf("Uso: %s [--maze FILE | --generate CxR [--maze-seed S]] [--save-maze FILE] [--ticks N] [--seed S] [--ghosts G] [--kernel K] [--ghost-threads T] [--snapshots]\n", prog);
+    printf("     %s --batch N [--threads T] [--input bot|script] [--max-ticks M] [--seed S] [--ghosts G] [--kernel K]\n", prog);
+    printf("     %s --autopilot [--budget-us U] [--threads T] [--ticks N] [--seed S] [--ghosts G]\n", prog);
+    printf("     %s --env N [--threads T] [--ticks N] [--max-ticks M] [--seed S] [--ghosts G]\n", prog);
+    printf("     %s --record FILE [--autopilot] [--ticks N] [--seed S] [--ghosts G]\n", prog);
+    printf("     %s --replay FILE [--repeat R] [--kernel K] [--ghost-threads T]\n", prog);
+    printf("  --maze FILE    labirinto da giocare (default %s)\n", SIM_DEFAULT_MAZE);
+    printf("  --generate CxR genera un labirinto di C colonne e R righe (da %d a %d) invece di leggerlo\n", MAZE_GEN_MIN_SIZE, MAP_MAX_SIZE);
+    printf("  --maze-seed S  seme del labirinto generato (default 1)\n");
+    printf("  --save-maze F  scrive il labirinto in F (es. per riusare un labirinto generato)\n");
+    printf("  --ticks N      tick da simulare in una sola partita continua (default 10000000)\n");
+    printf("  --seed S       seme del generatore casuale (default 1)\n");
+    printf("  --batch N      gioca N partite indipendenti, una per seme\n");
+    printf("  --threads T    worker del batch o di --env, thread di ricerca dell'autopilota (default: numero di core)\n");
+    printf("  --input MODE   chi muove Pacman nel batch: bot (default) o script\n");
+    printf("  --max-ticks M  limite di tick per partita nel batch (default: un'ora di gioco, 0 = nessuno)\n");
+    printf("  --ghosts G     numero di fantasmi (default %d, massimo %d)\n", NUM_GHOST, MAX_GHOSTS);
+    printf("  --kernel K     kernel dei fantasmi: auto (default), scalar, sse4.1 o avx2\n");
+    printf("  --record FILE  registra l'input di una partita (fino al game over o a --ticks)\n");
+    printf("  --replay FILE  rigioca una registrazione alla massima velocita'\n");
+    printf("  --repeat R     rigioca la registrazione R volte (per misurare i tick/s)\n");
+    printf("  --ghost-threads T  thread che muovono i fantasmi di una partita (default 1; da %d fantasmi in su)\n", GHOST_POOL_MIN_GHOSTS);
+    printf("  --snapshots    nella partita continua salva uno snapshot a ogni tick (come il rewind)\n");
+    printf("  --autopilot    Pacman mosso dall'autopilota MCTS (default %d tick nella partita continua)\n", AUTOPILOT_SIM_TICKS);
+    printf("  --env N        ambiente RL con N partite e azioni casuali: passi al secondo (--ticks passi, default %d)\n", ENV_SIM_STEPS);
+    printf("  --budget-us U  tempo di ricerca dell'autopilota per decisione (default %d microsecondi)\n", AUTOPILOT_DEFAULT_BUDGET_US);
+}
+
+// Stampa lo stato finale di una partita
+static void PrintWorldResult(const World *world)
+{
+    printf("tick: %u\n", world->tick);
+    printf("punteggio: %d\n", world->score);
+    printf("vite: %d%s\n", world->lives, world->gameOver ? " (game over)" : "");
+    printf("livello: %d\n", world->levelNumber);
+}
+
+// Registra una partita giocata dalla passeggiata casuale (o dall'autopilota)
+static int RunRecordMode(const Maze *maze, const char *path, unsigned int seed, int numGhosts, long long ticks,
+                         bool autopilot, int numThreads, int budgetUs)
+{
+    World world;
+    Replay replay;
+    if (!SimCreate(&world, maze, numGhosts))
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per %d fantasmi\n", numGhosts);
+        return EXIT_FAILURE;
+    }
+    world.ghostPool = ghostPool;
+    SimInit(&world, seed);
+    ReplayInit(&replay, seed, numGhosts, maze->hash);
+
+    Autopilot pilot;
+    if (autopilot && !InitAutopilot(&pilot, &world, numThreads, budgetUs))
+    {
+        fprintf(stderr, "Errore: impossibile avviare l'autopilota\n");
+        ReplayFree(&replay);
+        SimDestroy(&world);
+        return EXIT_FAILURE;
+    }
+
+    unsigned int inputState = seed;
+    SimInput input = 0;
+    bool ok = true;
+    for (long long t = 0; t < ticks && !world.gameOver && ok; t++)
+    {
+        input = autopilot ? AutopilotInput(&pilot, &world) : RandomWalkInput(&inputState, world.tick, input);
+        ok = ReplayRecord(&replay, input);
+        SimStep(&world, input);
+    }
+
+    ok = ok && ReplaySave(&replay, path);
+    if (ok)
+    {
+        PrintWorldResult(&world);
+        printf("file: %s (%zu byte di input)\n", path, replay.size);
+    }
+    else
+    {
+        fprintf(stderr, "Errore: impossibile scrivere %s\n", path);
+    }
+    if (autopilot)
+        FreeAutopilot(&pilot);
+    ReplayFree(&replay);
+    SimDestroy(&world);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Rigioca una registrazione senza finestra, repeat volte
+static int RunReplayMode(const Maze *maze, const char *path, int repeat)
+{
+    Replay replay;
+    if (!ReplayLoad(&replay, path))
+    {
+        fprintf(stderr, "Errore: registrazione non valida: %s\n", path);
+        return EXIT_FAILURE;
+    }
+    if (replay.tickRate != SIM_TICK_RATE)
+    {
+        fprintf(stderr, "Errore: registrazione a %d tick/s, simulatore compilato a %d\n", replay.tickRate, SIM_TICK_RATE);
+        ReplayFree(&replay);
+        return EXIT_FAILURE;
+    }
+    if (replay.mazeHash != maze->hash)
+    {
+        fprintf(stderr, "Errore: la registrazione e' stata fatta su un altro labirinto: usare lo stesso "
+                "--maze FILE, o --generate CxR --maze-seed S se era generato\n");
+        ReplayFree(&replay);
+        return EXIT_FAILURE;
+    }
+
+    World world;
+    if (replay.numGhosts < 1 || replay.numGhosts > MAX_GHOSTS)
+    {
+        fprintf(stderr, "Errore: numero di fantasmi non valido: %d\n", replay.numGhosts);
+        ReplayFree(&replay);
+        return EXIT_FAILURE;
+    }
+    if (!SimCreate(&world, maze, replay.numGhosts))
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per un labirinto %dx%d con %d fantasmi\n",
+                maze->cols, maze->rows, replay.numGhosts);
+        ReplayFree(&replay);
+        return EXIT_FAILURE;
+    }
+    world.ghostPool = ghostPool;
+
+    long long ticks = 0;
+    double start = NowSeconds();
+    for (int r = 0; r < repeat; r++)
+    {
+        ReplayCursor cursor;
+        SimInput input;
+        ReplayCursorInit(&cursor, &replay);
+        SimInit(&world, replay.seed);
+        while (ReplayNext(&cursor, &input))
+            SimStep(&world, input);
+        ticks += world.tick;
+    }
+    double elapsed = NowSeconds() - start;
+
+    PrintWorldResult(&world);
+    printf("fantasmi: %d (kernel %s, %d thread)\n", replay.numGhosts, GetGhostKernelName(GetGhostKernel()),
+           ghostPool ? ghostPool->numThreads : 1);
+    printf("ripetizioni: %d\n", repeat);
+    printf("tempo: %.3f s\n", elapsed);
+    printf("tick/s: %.0f\n", elapsed > 0.0 ? (double)ticks / elapsed : 0.0);
+
+    SimDestroy(&world);
+    ReplayFree(&replay);
+    return EXIT_SUCCESS;
+}
+
+// Modalita' batch: tante partite indipendenti su tutti i core
+static int RunBatchMode(const BatchConfig *config)
+{
+    BatchResult result;
+    if (RunBatch(config, &result) != 0)
+    {
+        fprintf(stderr, "Errore: configurazione del batch non valida\n");
+        return EXIT_FAILURE;
+    }
+
+    double games = result.games > 0 ? (double)result.games : 1.0;
+    printf("partite: %lld (game over: %lld)\n", result.games, result.gamesOver);
+    printf("thread: %d\n", config->numThreads);
+    printf("fantasmi: %d (kernel %s)\n", config->numGhosts, GetGhostKernelName(GetGhostKernel()));
+    printf("ticks: %lld\n", result.ticks);
+    printf("punteggio medio: %.1f (max %d)\n", (double)result.totalScore / games, result.maxScore);
+    printf("tick medi per partita: %.1f\n", (double)result.ticks / games);
+    printf("furti di lavoro: %lld\n", result.steals);
+    printf("tempo: %.3f s\n", result.seconds);
+    printf("partite/s: %.0f\n", result.seconds > 0.0 ? (double)result.games / result.seconds : 0.0);
+    printf("tick/s: %.0f\n", result.seconds > 0.0 ? (double)result.ticks / result.seconds : 0.0);
+    return EXIT_SUCCESS;
+}
+
+// Una sola partita continua (ricomincia al game over) per ticks tick
+static int RunSingleMode(const Maze *maze, unsigned int seed, int numGhosts, long long ticks, bool snapshots)
+{
+    World world;
+    if (!SimCreate(&world, maze, numGhosts))
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per %d fantasmi\n", numGhosts);
+        return EXIT_FAILURE;
+    }
+    world.ghostPool = ghostPool;
+    SimInit(&world, seed);
+
+    // Rewind: cinque secondi di snapshot, uno per tick (meno sui labirinti grandi)
+    SnapshotRing ring = {0};
+    if (snapshots && !InitSnapshotRing(&ring, &world, SIM_SECONDS(5)))
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per gli snapshot\n");
+        SimDestroy(&world);
+        return EXIT_FAILURE;
+    }
+    if (snapshots && ring.minCount < ring.capacity)
+        fprintf(stderr, "Attenzione: labirinto grande, il ring potrebbe tenere solo %d snapshot su %d (limite di %d MB)\n",
+                ring.minCount, ring.capacity, (int)(SNAPSHOT_RING_MAX_BYTES >> 20));
+
+    unsigned int inputState = seed;
+    SimInput input = 0;
+    long long games = 1;
+    long long totalScore = 0;
+
+    double start = NowSeconds();
+    for (long long t = 0; t < ticks; t++)
+    {
+        input = RandomWalkInput(&inputState, world.tick, input);
+        if (snapshots)
+            PushSnapshot(&ring, &world);
+        SimStep(&world, input);
+
+        // Partita finita: ne comincia subito un'altra con un nuovo seme
+        if (world.gameOver)
+        {
+            totalScore += world.score;
+            SimInit(&world, seed + (unsigned int)games);
+            games++;
+        }
+    }
+    double elapsed = NowSeconds() - start;
+    totalScore += world.score;
+    int ringCount = ring.count;
+
+    // Costo di salvataggio e ripristino, misurato a parte
+    double pushNs = 0.0, popNs = 0.0;
+    if (snapshots)
+    {
+        size_t bytes = SnapshotSize(&world);
+        const int rounds = bytes < 10000 ? 100000 : (bytes < 1000000000 / 100 ? (int)(1000000000 / bytes) : 100);
+        double t0 = NowSeconds();
+        for (int r = 0; r < rounds; r++)
+            PushSnapshot(&ring, &world);
+        double t1 = NowSeconds();
+        int pops = 0;
+        while (PopSnapshot(&ring, &world))   // Svuota il ring
+            pops++;
+        double t2 = NowSeconds();
+        pushNs = (t1 - t0) * 1e9 / rounds;
+        popNs = pops > 0 ? (t2 - t1) * 1e9 / pops : 0.0;
+    }
+    size_t snapshotBytes = SnapshotSize(&world);
+    FreeSnapshotRing(&ring);
+
+    SimDestroy(&world);
+
+    printf("ticks: %lld\n", ticks);
+    printf("fantasmi: %d (kernel %s, %d thread)\n", numGhosts, GetGhostKernelName(GetGhostKernel()),
+           ghostPool ? ghostPool->numThreads : 1);
+    printf("partite: %lld\n", games);
+    printf("punteggio medio: %.1f\n", (double)totalScore / (double)games);
+    printf("tempo: %.3f s\n", elapsed);
+    printf("tick/s: %.0f\n", elapsed > 0.0 ? (double)ticks / elapsed : 0.0);
+    if (snapshots)
+    {
+        printf("snapshot: %zu byte al massimo, salvataggio %.0f ns, ripristino %.0f ns\n", snapshotBytes, pushNs, popNs);
+        printf("ring: %d snapshot su %d alla fine\n", ringCount, SIM_SECONDS(5));
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Partite continue giocate dall'autopilota MCTS: punteggio e rollout al secondo
+static int RunAutopilotMode(const Maze *maze, unsigned int seed, int numGhosts, long long ticks, int numThreads, int budgetUs)
+{
+    World world;
+    if (!SimCreate(&world, maze, numGhosts))
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per %d fantasmi\n", numGhosts);
+        return EXIT_FAILURE;
+    }
+    world.ghostPool = ghostPool;
+    SimInit(&world, seed);
+
+    Autopilot pilot;
+    if (!InitAutopilot(&pilot, &world, numThreads, budgetUs))
+    {
+        fprintf(stderr, "Errore: impossibile avviare l'autopilota con %d thread\n", numThreads);
+        SimDestroy(&world);
+        return EXIT_FAILURE;
+    }
+
+    long long games = 1;
+    long long totalScore = 0;
+    int maxScore = 0;
+    double start = NowSeconds();
+    for (long long t = 0; t < ticks; t++)
+    {
+        SimStep(&world, AutopilotInput(&pilot, &world));
+        if (world.gameOver)
+        {
+            totalScore += world.score;
+            if (world.score > maxScore)
+                maxScore = world.score;
+            SimInit(&world, seed + (unsigned int)games);
+            games++;
+        }
+    }
+    double elapsed = NowSeconds() - start;
+    totalScore += world.score;
+    if (world.score > maxScore)
+        maxScore = world.score;
+
+    double decisions = pilot.decisions > 0 ? (double)pilot.decisions : 1.0;
+    printf("ticks: %lld\n", ticks);
+    printf("fantasmi: %d (kernel %s)\n", numGhosts, GetGhostKernelName(GetGhostKernel()));
+    printf("thread di ricerca: %d, budget %d us\n", pilot.numThreads, budgetUs);
+    printf("partite: %lld\n", games);
+    printf("punteggio medio: %.1f (max %d)\n", (double)totalScore / (double)games, maxScore);
+    printf("decisioni: %lld (ricerca media %.3f ms)\n", pilot.decisions, pilot.searchSeconds * 1e3 / decisions);
+    printf("rollout: %lld (%.1f per decisione)\n", pilot.rollouts, (double)pilot.rollouts / decisions);
+    printf("rollout/s: %.0f\n", AutopilotRolloutsPerSecond(&pilot));
+    printf("oltre il budget: media %.3f ms, max %.3f ms (%lld iterazioni interrotte)\n",
+           pilot.overrunSeconds * 1e3 / decisions, pilot.maxOverrunSeconds * 1e3, pilot.truncated);
+    printf("tempo: %.3f s\n", elapsed);
+    printf("tick/s: %.0f\n", elapsed > 0.0 ? (double)ticks / elapsed : 0.0);
+
+    FreeAutopilot(&pilot);
+    SimDestroy(&world);
+    return EXIT_SUCCESS;
+}
+
+// Ambiente RL (env.h) con azioni casuali: passi al secondo come li vede un trainer
+static int RunEnvMode(const EnvConfig *config, long long steps)
+{
+    PacmanEnv env;
+    if (!EnvCreate(&env, config))
+    {
+        fprintf(stderr, "Errore: impossibile creare %d partite con %d thread\n", config->numEnvs, config->numThreads);
+        return EXIT_FAILURE;
+    }
+
+    size_t obsSize = EnvObservationSize(&env) * (size_t)config->numEnvs;
+    unsigned char *obs = malloc(obsSize);
+    int *actions = malloc(sizeof(int) * (size_t)config->numEnvs);
+    float *rewards = malloc(sizeof(float) * (size_t)config->numEnvs);
+    unsigned char *dones = malloc((size_t)config->numEnvs);
+    if (!obs || !actions || !rewards || !dones)
+    {
+        fprintf(stderr, "Errore: memoria insufficiente per le osservazioni\n");
+        free(obs);
+        free(actions);
+        free(rewards);
+        free(dones);
+        EnvDestroy(&env);
+        return EXIT_FAILURE;
+    }
+
+    EnvReset(&env, obs);
+    unsigned int state = config->baseSeed * 2654435761u + 1u;
+    double totalReward = 0.0;
+    double start = NowSeconds();
+    for (long long s = 0; s < steps; s++)
+    {
+        for (int i = 0; i < config->numEnvs; i++)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            actions[i] = (int)(state % ENV_NUM_ACTIONS);
+        }
+        EnvStep(&env, actions, obs, rewards, dones);
+        for (int i = 0; i < config->numEnvs; i++)
+            totalReward += rewards[i];
+    }
+    double elapsed = NowSeconds() - start;
+
+    // Impronta dell'ultima osservazione: uguale con qualunque numero di thread
+    unsigned long long hash = 1469598103934665603ull;
+    for (size_t k = 0; k < obsSize; k++)
+        hash = (hash ^ obs[k]) * 1099511628211ull;
+
+    printf("ambienti: %d (%d thread, %d tick per passo)\n", config->numEnvs, env.numThreads, env.config.ticksPerStep);
+    printf("fantasmi: %d (kernel %s)\n", env.config.numGhosts, GetGhostKernelName(GetGhostKernel()));
+    printf("osservazione: %d piani %dx%d (%zu byte per partita)\n", ENV_NUM_PLANES, env.cols, env.rows, EnvObservationSize(&env));
+    printf("passi: %lld\n", env.steps);
+    printf("episodi finiti: %lld\n", env.episodes);
+    printf("ricompensa totale: %.0f\n", totalReward);
+    printf("impronta osservazioni: %016llx\n", hash);
+    printf("tempo: %.3f s\n", elapsed);
+    printf("passi/s: %.0f\n", elapsed > 0.0 ? (double)env.steps / elapsed : 0.0);
+
+    free(obs);
+    free(actions);
+    free(rewards);
+    free(dones);
+    EnvDestroy(&env);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    long long ticks = 10000000;
+    bool ticksGiven = false;
+    unsigned int seed = 1;
+    int numGhosts = NUM_GHOST;
+    const char *recordPath = NULL;
+    const char *replayPath = NULL;
+    const char *mazePath = SIM_DEFAULT_MAZE;
+    const char *saveMazePath = NULL;
+    int generateCols = 0, generateRows = 0;  // 0 = labirinto letto da mazePath
+    unsigned int mazeSeed = 1;
+    int repeat = 1;
+    bool snapshots = false;
+    int ghostThreads = 1;
+    bool autopilot = false;
+    int budgetUs = AUTOPILOT_DEFAULT_BUDGET_US;
+    int numEnvs = 0;
+    BatchConfig batch = {0};
+    batch.numThreads = CpuCount();
+    batch.maxTicksPerGame = 60 * 60 * SIM_TICK_RATE;  // Un'ora di gioco
+    batch.inputMode = BATCH_INPUT_BOT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+        {
+            ticks = atoll(argv[++i]);
+            ticksGiven = true;
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+            batch.numGames = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            batch.numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc)
+            batch.maxTicksPerGame = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--maze") == 0 && i + 1 < argc)
+            mazePath = argv[++i];
+        else if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc)
+        {
+            if (!MazeParseSize(argv[++i], &generateCols, &generateRows))
+            {
+                PrintUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--maze-seed") == 0 && i + 1 < argc)
+            mazeSeed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--save-maze") == 0 && i + 1 < argc)
+            saveMazePath = argv[++i];
+        else if (strcmp(argv[i], "--snapshots") == 0)
+            snapshots = true;
+        else if (strcmp(argv[i], "--autopilot") == 0)
+            autopilot = true;
+        else if (strcmp(argv[i], "--budget-us") == 0 && i + 1 < argc)
+            budgetUs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--env") == 0 && i + 1 < argc)
+            numEnvs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--ghost-threads") == 0 && i + 1 < argc)
+            ghostThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--ghosts") == 0 && i + 1 < argc)
+            numGhosts = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc)
+        {
+            static const char *names[] = {"auto", "scalar", "sse4.1", "avx2"};
+            static const GhostKernel kernels[] = {GHOST_KERNEL_AUTO, GHOST_KERNEL_SCALAR, GHOST_KERNEL_SSE41, GHOST_KERNEL_AVX2};
+            const char *name = argv[++i];
+            int k = 0;
+            while (k < 4 && strcmp(name, names[k]) != 0)
+                k++;
+            if (k == 4)
+            {
+                PrintUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            if (!SetGhostKernel(kernels[k]))
+            {
+                fprintf(stderr, "Errore: kernel %s non supportato da questa CPU\n", name);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc)
+        {
+            const char *mode = argv[++i];
+            if (strcmp(mode, "bot") == 0)
+                batch.inputMode = BATCH_INPUT_BOT;
+            else if (strcmp(mode, "script") == 0)
+                batch.inputMode = BATCH_INPUT_SCRIPT;
+            else
+            {
+                PrintUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (numGhosts < 1 || numGhosts > MAX_GHOSTS || ghostThreads < 1 || ghostThreads > GHOST_POOL_MAX_THREADS || budgetUs < 1)
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Maze maze;
+    if (generateCols > 0)
+    {
+        double start = NowSeconds();
+        if (!MazeGenerate(&maze, generateCols, generateRows, mazeSeed))
+        {
+            fprintf(stderr, "Errore: impossibile generare un labirinto %dx%d (minimo %dx%d)\n",
+                    generateCols, generateRows, MAZE_GEN_MIN_SIZE, MAZE_GEN_MIN_SIZE);
+            return EXIT_FAILURE;
+        }
+        printf("labirinto: generato %dx%d (seme %u) in %.3f s\n", maze.cols, maze.rows, mazeSeed, NowSeconds() - start);
+    }
+    else
+    {
+        if (!MazeLoadFile(&maze, mazePath))
+        {
+            fprintf(stderr, "Errore: labirinto non valido: %s\n", mazePath);
+            return EXIT_FAILURE;
+        }
+        printf("labirinto: %s (%dx%d)\n", mazePath, maze.cols, maze.rows);
+    }
+    if (saveMazePath && !MazeSaveFile(&maze, saveMazePath))
+    {
+        fprintf(stderr, "Errore: impossibile scrivere il labirinto %s\n", saveMazePath);
+        MazeFree(&maze);
+        return EXIT_FAILURE;
+    }
+
+    static GhostPool pool;
+    if (ghostThreads > 1)
+    {
+        if (!InitGhostPool(&pool, ghostThreads))
+        {
+            fprintf(stderr, "Errore: impossibile avviare %d thread per i fantasmi\n", ghostThreads);
+            MazeFree(&maze);
+            return EXIT_FAILURE;
+        }
+        ghostPool = &pool;
+    }
+
+    int autopilotThreads = batch.numThreads < 1 ? 1 : (batch.numThreads > AUTOPILOT_MAX_THREADS ? AUTOPILOT_MAX_THREADS : batch.numThreads);
+    int status;
+    if (replayPath)
+        status = RunReplayMode(&maze, replayPath, repeat > 0 ? repeat : 1);
+    else if (recordPath)
+        status = RunRecordMode(&maze, recordPath, seed, numGhosts, ticks, autopilot, autopilotThreads, budgetUs);
+    else if (batch.numGames > 0)
+    {
+        batch.maze = &maze;
+        batch.numGhosts = numGhosts;
+        if (batch.numThreads < 1)
+            batch.numThreads = 1;
+        batch.baseSeed = seed;
+        status = RunBatchMode(&batch);
+    }
+    else if (numEnvs > 0)
+    {
+        EnvConfig env = {0};
+        env.maze = &maze;
+        env.numEnvs = numEnvs;
+        env.numGhosts = numGhosts;
+        env.numThreads = batch.numThreads < 1 ? 1 : (batch.numThreads > ENV_MAX_THREADS ? ENV_MAX_THREADS : batch.numThreads);
+        env.maxTicks = batch.maxTicksPerGame;
+        env.baseSeed = seed;
+        status = RunEnvMode(&env, ticksGiven ? ticks : ENV_SIM_STEPS);
+    }
+    else if (autopilot)
+        status = RunAutopilotMode(&maze, seed, numGhosts, ticksGiven ? ticks : AUTOPILOT_SIM_TICKS,
+                                  autopilotThreads, budgetUs);
+    else
+        status = RunSingleMode(&maze, seed, numGhosts, ticks, snapshots);
+
+    if (ghostPool)
+        FreeGhostPool(ghostPool);
+    MazeFree(&maze);
+    return status;
+}
@@ -0,0 +1,224 @@
+// === SNAPSHOT DEL MONDO ===
+#include "lib/snapshot.h"
+#include "lib/platform.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Layout: | SnapshotHeader | World da level a ghostGrid | offset nextEvent speed edge cell target startCell |
+ *         | dotsLeft numFreeCells | puntini (rows * words parole) | freeCells[0..numFreeCells) |
+ * Le cache dopo ghostGrid (griglie, flow field) non vengono copiate; dell'indice delle
+ * celle libere si salva solo la parte usata (nell'ordine dell'indice, da cui dipende
+ * dove compaiono i power-up), freeSlot si ricostruisce da quella. La parte usata
+ * cresce con i puntini mangiati: SnapshotSize la conta piena (tutte le celle senza
+ * muro), il ring invece tiene ogni snapshot nei byte che usa davvero.
+ */
+
+typedef struct {
+    size_t size;        // Byte massimi dello snapshot (SnapshotSize)
+    int numGhosts;      // Fantasmi del World salvato
+    const Maze *maze;   // Labirinto del World salvato
+} SnapshotHeader;
+
+#define SNAPSHOT_WORLD_BEGIN offsetof(World, level)
+#define SNAPSHOT_WORLD_BYTES (offsetof(World, ghostGrid) - SNAPSHOT_WORLD_BEGIN)
+#define GHOST_SNAPSHOT_ARRAYS 7
+
+// Byte di uno snapshot con numFreeCells celle libere
+static size_t SnapshotBytes(const World *w, int numFreeCells)
+{
+    size_t numWords = (size_t)w->map.rows * (size_t)w->map.words;
+    return sizeof(SnapshotHeader) + SNAPSHOT_WORLD_BYTES +
+           sizeof(float) * GHOST_SNAPSHOT_ARRAYS * (size_t)w->ghosts.count +
+           2 * sizeof(int) + sizeof(MapWord) * numWords + sizeof(int) * (size_t)numFreeCells;
+}
+
+size_t SnapshotSize(const World *w)
+{
+    return SnapshotBytes(w, w->map.numOpenCells);
+}
+
+void SnapshotSave(const World *w, void *buffer)
+{
+    unsigned char *out = buffer;
+    size_t ghostBytes = sizeof(float) * (size_t)w->ghosts.count;
+
+    // Azzerata prima: anche i byte di padding dell'intestazione sono sempre gli stessi
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = SnapshotSize(w);
+    header.numGhosts = w->ghosts.count;
+    header.maze = w->maze;
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    memcpy(out, (const unsigned char *)w + SNAPSHOT_WORLD_BEGIN, SNAPSHOT_WORLD_BYTES);
+
+    // Degli array dei fantasmi restano solo i contatori: i puntatori sono del World
+    // (SnapshotLoad tiene i suoi), cosi' lo stesso stato da' sempre gli stessi byte
+    GhostSwarm ghosts = {w->ghosts.count, w->ghosts.capacity};
+    memcpy(out + offsetof(World, ghosts) - SNAPSHOT_WORLD_BEGIN, &ghosts, sizeof(ghosts));
+    out += SNAPSHOT_WORLD_BYTES;
+
+    const void *ghostArrays[GHOST_SNAPSHOT_ARRAYS] = {
+        w->ghosts.offset, w->ghosts.nextEvent, w->ghosts.speed,
+        w->ghosts.edge, w->ghosts.cell, w->ghosts.target, w->ghosts.startCell};
+    for (int a = 0; a < GHOST_SNAPSHOT_ARRAYS; a++)
+    {
+        memcpy(out, ghostArrays[a], ghostBytes);
+        out += ghostBytes;
+    }
+
+    const MapBits *map = &w->map;
+    int counts[2] = {map->dotsLeft, map->numFreeCells};
+    size_t dotBytes = sizeof(MapWord) * (size_t)map->rows * (size_t)map->words;
+    memcpy(out, counts, sizeof(counts));
+    out += sizeof(counts);
+    memcpy(out, map->dots, dotBytes);
+    out += dotBytes;
+    memcpy(out, map->freeCells, sizeof(int) * (size_t)map->numFreeCells);
+}
+
+bool SnapshotLoad(World *w, const void *buffer)
+{
+    const unsigned char *in = buffer;
+    SnapshotHeader header;
+    memcpy(&header, in, sizeof(header));
+    if (header.size != SnapshotSize(w) || header.numGhosts != w->ghosts.count || header.maze != w->maze)
+        return false;
+    in += sizeof(header);
+
+    // I campi vengono dallo snapshot, gli array dei fantasmi restano quelli di w
+    GhostSwarm ghosts = w->ghosts;
+    memcpy((unsigned char *)w + SNAPSHOT_WORLD_BEGIN, in, SNAPSHOT_WORLD_BYTES);
+    in += SNAPSHOT_WORLD_BYTES;
+    w->ghosts = ghosts;
+
+    size_t ghostBytes = sizeof(float) * (size_t)ghosts.count;
+    void *ghostArrays[GHOST_SNAPSHOT_ARRAYS] = {
+        ghosts.offset, ghosts.nextEvent, ghosts.speed,
+        ghosts.edge, ghosts.cell, ghosts.target, ghosts.startCell};
+    for (int a = 0; a < GHOST_SNAPSHOT_ARRAYS; a++)
+    {
+        memcpy(ghostArrays[a], in, ghostBytes);
+        in += ghostBytes;
+    }
+
+    // Mappa: prima toglie dall'indice le celle libere attuali, poi mette quelle salvate
+    MapBits *map = &w->map;
+    for (int k = 0; k < map->numFreeCells; k++)
+        map->freeSlot[map->freeCells[k]] = MAP_NO_SLOT;
+    int counts[2];
+    size_t dotBytes = sizeof(MapWord) * (size_t)map->rows * (size_t)map->words;
+    memcpy(counts, in, sizeof(counts));
+    in += sizeof(counts);
+    memcpy(map->dots, in, dotBytes);
+    in += dotBytes;
+    map->dotsLeft = counts[0];
+    map->numFreeCells = counts[1];
+    memcpy(map->freeCells, in, sizeof(int) * (size_t)map->numFreeCells);
+    for (int k = 0; k < map->numFreeCells; k++)
+        map->freeSlot[map->freeCells[k]] = k;
+
+    SimRebuildCaches(w);
+    return true;
+}
+
+// === RING BUFFER ===
+
+// Spazio di uno snapshot nel ring: ogni snapshot parte su una cache line
+static size_t RingBytes(size_t size)
+{
+    return (size + 63) & ~(size_t)63;
+}
+
+bool InitSnapshotRing(SnapshotRing *ring, const World *w, int capacity)
+{
+    memset(ring, 0, sizeof(*ring));
+    if (capacity < 1)
+        return false;
+
+    // Il blocco basta per capacity snapshot pieni, fino a SNAPSHOT_RING_MAX_BYTES
+    // (almeno uno): di solito gli snapshot sono molto piu' piccoli e ne entrano tutti
+    size_t maxSize = RingBytes(SnapshotSize(w));
+    size_t bytes = SNAPSHOT_RING_MAX_BYTES / maxSize >= (size_t)capacity ? maxSize * (size_t)capacity : SNAPSHOT_RING_MAX_BYTES;
+    if (bytes < maxSize)
+        bytes = maxSize;
+    ring->slots = AlignedAlloc(64, bytes);
+    ring->offset = malloc(sizeof(size_t) * (size_t)capacity);
+    ring->size = malloc(sizeof(size_t) * (size_t)capacity);
+    if (!ring->slots || !ring->offset || !ring->size)
+    {
+        FreeSnapshotRing(ring);
+        return false;
+    }
+
+    ring->bytes = bytes;
+    ring->capacity = capacity;
+    ring->minCount = (int)(bytes / maxSize) < capacity ? (int)(bytes / maxSize) : capacity;
+    return true;
+}
+
+void FreeSnapshotRing(SnapshotRing *ring)
+{
+    AlignedFree(ring->slots);
+    free(ring->offset);
+    free(ring->size);
+    memset(ring, 0, sizeof(*ring));
+}
+
+void ClearSnapshotRing(SnapshotRing *ring)
+{
+    ring->head = 0;
+    ring->count = 0;
+}
+
+void PushSnapshot(SnapshotRing *ring, const World *w)
+{
+    size_t need = RingBytes(SnapshotBytes(w, w->map.numFreeCells));
+    int cap = ring->capacity;
+
+    // Subito dopo il piu' recente; se non c'e' posto fino alla fine si riparte da 0
+    size_t pos = 0;
+    size_t wrapFrom = ring->bytes;   // Da qui alla fine restano solo snapshot del giro prima
+    if (ring->count > 0)
+    {
+        int last = (ring->head + cap - 1) % cap;
+        pos = ring->offset[last] + ring->size[last];
+        if (pos + need > ring->bytes)
+        {
+            wrapFrom = pos;
+            pos = 0;
+        }
+    }
+
+    // Via i piu' vecchi finche' c'e' una voce libera e il posto non si sovrappone a nessuno:
+    // davanti alla posizione di scrittura ci sono proprio loro, in ordine
+    while (ring->count > 0)
+    {
+        int oldest = (ring->head + cap - ring->count) % cap;
+        size_t begin = ring->offset[oldest];
+        bool overlaps = begin < pos + need && begin + ring->size[oldest] > pos;
+        if (ring->count < cap && !overlaps && begin < wrapFrom)
+            break;
+        ring->count--;
+    }
+
+    SnapshotSave(w, ring->slots + pos);
+    ring->offset[ring->head] = pos;
+    ring->size[ring->head] = need;
+    ring->head = (ring->head + 1) % cap;
+    ring->count++;
+}
+
+bool PopSnapshot(SnapshotRing *ring, World *w)
+{
+    if (ring->count == 0)
+        return false;
+    int last = (ring->head + ring->capacity - 1) % ring->capacity;
+    if (!SnapshotLoad(w, ring->slots + ring->offset[last]))
+        return false;
+    ring->head = last;
+    ring->count--;
+    return true;
+}
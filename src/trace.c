@@ -0,0 +1,260 @@
+// === TRACCIA DEGLI EVENTI (CHROME TRACE-EVENT) ===
+#include "lib/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+typedef struct {
+    const char *name;           // Stringa costante
+    const char *argName;        // NULL = nessun argomento
+    unsigned long long ts;      // Nanosecondi (TraceTimestamp)
+    unsigned long long duration; // Solo per 'X'
+    long long value;
+    char phase;                 // 'B', 'E', 'X', 'i', 'M' come nel formato di Chrome
+} TraceEvent;
+
+// Blocco di eventi: lo riempie solo il suo thread; quando e' pieno il thread
+// pubblica il successivo in next e da quel momento il blocco non cambia piu'
+typedef struct TraceChunk {
+    TraceEvent events[TRACE_CHUNK_EVENTS];
+    int count;                  // Eventi scritti (pubblicato con release)
+    struct TraceChunk *next;    // Non NULL = blocco completo (pubblicato con release)
+} TraceChunk;
+
+typedef struct TraceBuffer {
+    TraceChunk *head;           // Primo blocco non ancora scritto (solo il thread di scrittura)
+    TraceChunk *tail;           // Blocco in riempimento (solo il thread proprietario)
+    int threadId;
+    struct TraceBuffer *next;   // Lista di tutti i buffer della sessione
+} TraceBuffer;
+
+int traceEnabled = 0;
+static int traceSession = 0;             // Cambia a ogni TraceStart: i buffer vecchi non valgono piu'
+static int traceNextThreadId = 0;
+static TraceBuffer *traceBuffers = NULL; // Inserimento in testa con compare-and-swap
+static FILE *traceFile = NULL;
+static unsigned long long traceStartNs = 0;
+static bool traceFirstEvent = true;
+static pthread_t traceWriter;
+static int traceWriterStop = 0;
+
+static __thread TraceBuffer *threadBuffer = NULL;
+static __thread int threadSession = 0;
+
+unsigned long long TraceTimestamp(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+// Buffer del thread chiamante, creato e registrato al suo primo evento della sessione
+static TraceBuffer *GetThreadBuffer(void)
+{
+    int session = __atomic_load_n(&traceSession, __ATOMIC_ACQUIRE);
+    if (threadBuffer && threadSession == session)
+        return threadBuffer;
+
+    TraceBuffer *buffer = malloc(sizeof(TraceBuffer));
+    TraceChunk *chunk = malloc(sizeof(TraceChunk));
+    if (!buffer || !chunk)
+    {
+        free(buffer);
+        free(chunk);
+        return NULL;
+    }
+    chunk->count = 0;
+    chunk->next = NULL;
+    buffer->head = chunk;
+    buffer->tail = chunk;
+    buffer->threadId = __atomic_add_fetch(&traceNextThreadId, 1, __ATOMIC_RELAXED);
+
+    buffer->next = __atomic_load_n(&traceBuffers, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&traceBuffers, &buffer->next, buffer, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+
+    threadBuffer = buffer;
+    threadSession = session;
+    return buffer;
+}
+
+// Aggiunge un evento al buffer del thread (nessun lock: il blocco e' solo suo)
+static void AppendEvent(char phase, const char *name, const char *argName,
+                        unsigned long long ts, unsigned long long duration, long long value)
+{
+    TraceBuffer *buffer = GetThreadBuffer();
+    if (!buffer)
+        return;
+
+    TraceChunk *chunk = buffer->tail;
+    if (chunk->count == TRACE_CHUNK_EVENTS)
+    {
+        TraceChunk *fresh = malloc(sizeof(TraceChunk));
+        if (!fresh)
+            return;   // Memoria finita: l'evento si perde, il gioco continua
+        fresh->count = 0;
+        fresh->next = NULL;
+        __atomic_store_n(&chunk->next, fresh, __ATOMIC_RELEASE);
+        buffer->tail = chunk = fresh;
+    }
+
+    TraceEvent *event = &chunk->events[chunk->count];
+    event->phase = phase;
+    event->name = name;
+    event->argName = argName;
+    event->ts = ts;
+    event->duration = duration;
+    event->value = value;
+    __atomic_store_n(&chunk->count, chunk->count + 1, __ATOMIC_RELEASE);
+}
+
+// Microsecondi dall'inizio della traccia (l'unita' del formato di Chrome)
+static double TraceMicroseconds(unsigned long long ns)
+{
+    return ns > traceStartNs ? (double)(ns - traceStartNs) / 1000.0 : 0.0;
+}
+
+static void WriteEvent(const TraceEvent *event, int threadId)
+{
+    fprintf(traceFile, "%s\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%d", traceFirstEvent ? "" : ",", event->phase, threadId);
+    traceFirstEvent = false;
+
+    if (event->phase == 'M')
+    {
+        fprintf(traceFile, ",\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}", event->name);
+        return;
+    }
+
+    fprintf(traceFile, ",\"name\":\"%s\",\"ts\":%.3f", event->name, TraceMicroseconds(event->ts));
+    if (event->phase == 'X')
+        fprintf(traceFile, ",\"dur\":%.3f", (double)event->duration / 1000.0);
+    if (event->phase == 'i')
+        fprintf(traceFile, ",\"s\":\"t\"");
+    if (event->argName)
+        fprintf(traceFile, ",\"args\":{\"%s\":%lld}", event->argName, event->value);
+    fprintf(traceFile, "}");
+}
+
+// Scrive e libera i blocchi completi di un buffer; con all scrive anche quello
+// in riempimento (solo da TraceStop, a thread fermi)
+static void DrainBuffer(TraceBuffer *buffer, bool all)
+{
+    for (;;)
+    {
+        TraceChunk *chunk = buffer->head;
+        TraceChunk *next = __atomic_load_n(&chunk->next, __ATOMIC_ACQUIRE);
+        if (!next && !all)
+            return;
+
+        int count = __atomic_load_n(&chunk->count, __ATOMIC_ACQUIRE);
+        for (int k = 0; k < count; k++)
+            WriteEvent(&chunk->events[k], buffer->threadId);
+        if (!next)
+            return;   // Blocco in riempimento: lo libera TraceStop
+        buffer->head = next;
+        free(chunk);
+    }
+}
+
+// Scrive i blocchi pieni di tutti i thread
+static void FlushCompleteChunks(void)
+{
+    for (TraceBuffer *buffer = __atomic_load_n(&traceBuffers, __ATOMIC_ACQUIRE); buffer; buffer = buffer->next)
+        DrainBuffer(buffer, false);
+}
+
+// Thread di scrittura: fuori dal ciclo del gioco, cosi' il frame non paga il JSON
+static void *TraceWriterThread(void *arg)
+{
+    (void)arg;
+    struct timespec pause = {0, TRACE_FLUSH_MS * 1000000L};
+    while (!__atomic_load_n(&traceWriterStop, __ATOMIC_ACQUIRE))
+    {
+        FlushCompleteChunks();
+        nanosleep(&pause, NULL);
+    }
+    return NULL;
+}
+
+bool TraceStart(const char *path)
+{
+    if (traceFile)
+        return false;
+    traceFile = fopen(path, "w");
+    if (!traceFile)
+        return false;
+    setvbuf(traceFile, NULL, _IOFBF, 1 << 20);
+
+    fprintf(traceFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    traceFirstEvent = true;
+    traceStartNs = TraceTimestamp();
+    traceBuffers = NULL;
+    traceWriterStop = 0;
+    if (pthread_create(&traceWriter, NULL, TraceWriterThread, NULL) != 0)
+    {
+        fclose(traceFile);
+        traceFile = NULL;
+        return false;
+    }
+    __atomic_add_fetch(&traceSession, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&traceEnabled, 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool TraceStop(void)
+{
+    if (!traceFile)
+        return false;
+    __atomic_store_n(&traceEnabled, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&traceWriterStop, 1, __ATOMIC_RELEASE);
+    pthread_join(traceWriter, NULL);
+
+    TraceBuffer *buffer = __atomic_load_n(&traceBuffers, __ATOMIC_ACQUIRE);
+    while (buffer)
+    {
+        DrainBuffer(buffer, true);
+        TraceBuffer *next = buffer->next;
+        free(buffer->head);
+        free(buffer);
+        buffer = next;
+    }
+    traceBuffers = NULL;
+    threadBuffer = NULL;   // Gli altri thread vedranno la sessione cambiata
+
+    fprintf(traceFile, "\n]}\n");
+    bool ok = fclose(traceFile) == 0;
+    traceFile = NULL;
+    return ok;
+}
+
+void TraceThreadName(const char *name)
+{
+    if (TraceEnabled())
+        AppendEvent('M', name, NULL, 0, 0, 0);
+}
+
+void TraceBegin(const char *name)
+{
+    if (TraceEnabled())
+        AppendEvent('B', name, NULL, TraceTimestamp(), 0, 0);
+}
+
+void TraceEnd(const char *name)
+{
+    if (TraceEnabled())
+        AppendEvent('E', name, NULL, TraceTimestamp(), 0, 0);
+}
+
+void TraceComplete(const char *name, unsigned long long start, unsigned long long duration,
+                   const char *argName, long long value)
+{
+    if (TraceEnabled())
+        AppendEvent('X', name, argName, start, duration, value);
+}
+
+void TraceInstant(const char *name, const char *argName, long long value)
+{
+    if (TraceEnabled())
+        AppendEvent('i', name, argName, TraceTimestamp(), 0, value);
+}